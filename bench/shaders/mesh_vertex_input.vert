@@ -0,0 +1,34 @@
+#version 450
+
+// The vertex input counterpart of res/shaders/vertex_pulling.vert for a QuantizedMesh with normals and colors:
+// same decoding and shading, the attributes come from MeshVertexLayout::apply() bindings.
+
+layout (location = 0) in vec4 positionIn;
+layout (location = 1) in vec2 normalIn;
+layout (location = 2) in vec4 colorIn;
+
+layout (push_constant) uniform constants {
+    vec4 position_scale;
+    vec4 position_bias;
+} PushConstants;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.3, -0.5, 1.0));
+
+layout (location = 0) out vec4 fragColor;
+
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = positionIn.xyz * PushConstants.position_scale.xyz + PushConstants.position_bias.xyz;
+
+    fragColor = colorIn;
+    fragColor.rgb *= 0.4 + 0.6 * max(dot(decode_octahedral(normalIn), LIGHT_DIRECTION), 0.0);
+
+    gl_Position = vec4(position, 1.0);
+}
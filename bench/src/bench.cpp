@@ -0,0 +1,115 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace neuron::bench {
+    static double percentile(const std::vector<double> &sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+
+        // nearest rank
+        const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    MetricStats summarize(std::string name, std::vector<double> samples) {
+        std::ranges::sort(samples);
+
+        MetricStats stats;
+        stats.name    = std::move(name);
+        stats.samples = samples.size();
+        stats.mean    = samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        stats.p50     = percentile(samples, 0.50);
+        stats.p99     = percentile(samples, 0.99);
+        return stats;
+    }
+
+    std::vector<double> time_iterations(const ScenarioSettings &settings, const std::function<void()> &iteration) {
+        for (uint32_t i = 0; i < settings.warmup; i++) {
+            iteration();
+        }
+
+        std::vector<double> samples;
+        samples.reserve(settings.iterations);
+        for (uint32_t i = 0; i < settings.iterations; i++) {
+            const auto begin = std::chrono::steady_clock::now();
+            iteration();
+            samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+        }
+
+        return samples;
+    }
+
+    std::string to_json(const std::vector<MetricStats> &results) {
+        std::ostringstream out;
+        out.precision(9);
+
+        out << "{\n  \"metrics\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const MetricStats &m = results[i];
+            out << "    {\"name\": \"" << m.name << "\", \"mean\": " << m.mean << ", \"p50\": " << m.p50 << ", \"p99\": " << m.p99 << ", \"samples\": " << m.samples
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+
+        return out.str();
+    }
+
+    // Only reads what to_json() writes: one flat object per metric, names without escapes.
+    std::vector<MetricStats> parse_json(const std::string &text) {
+        std::vector<MetricStats> results;
+
+        auto number_after = [&](size_t from, size_t end, const char *key) {
+            const size_t at = text.find(key, from);
+            if (at == std::string::npos || at > end) {
+                throw std::runtime_error(std::string("Benchmark JSON is missing ") + key);
+            }
+            return std::stod(text.substr(at + std::char_traits<char>::length(key)));
+        };
+
+        size_t pos = 0;
+        while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+            const size_t name_begin = pos + 9;
+            const size_t name_end   = text.find('"', name_begin);
+            const size_t end        = text.find('}', name_end);
+            if (name_end == std::string::npos || end == std::string::npos) {
+                throw std::runtime_error("Malformed benchmark JSON");
+            }
+
+            MetricStats m;
+            m.name    = text.substr(name_begin, name_end - name_begin);
+            m.mean    = number_after(name_end, end, "\"mean\": ");
+            m.p50     = number_after(name_end, end, "\"p50\": ");
+            m.p99     = number_after(name_end, end, "\"p99\": ");
+            m.samples = static_cast<size_t>(number_after(name_end, end, "\"samples\": "));
+            results.push_back(std::move(m));
+
+            pos = end;
+        }
+
+        return results;
+    }
+
+    std::vector<Regression> compare(const std::vector<MetricStats> &baseline, const std::vector<MetricStats> &current, double threshold) {
+        std::vector<Regression> regressions;
+
+        for (const MetricStats &b : baseline) {
+            const auto c = std::ranges::find(current, b.name, &MetricStats::name);
+            if (c == current.end()) {
+                continue;
+            }
+
+            if (c->p50 > b.p50 * (1.0 + threshold)) {
+                regressions.push_back({b.name, b.p50, c->p50});
+            }
+        }
+
+        return regressions;
+    }
+} // namespace neuron::bench
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace neuron::bench {
+
+    // Every metric is a duration in milliseconds, lower is better.
+    struct MetricStats {
+        std::string name;
+        double      mean    = 0.0;
+        double      p50     = 0.0;
+        double      p99     = 0.0;
+        size_t      samples = 0;
+    };
+
+    struct ScenarioSettings {
+        uint32_t warmup     = 10;
+        uint32_t iterations = 100;
+    };
+
+    [[nodiscard]] MetricStats summarize(std::string name, std::vector<double> samples);
+
+    // Runs `iteration` settings.warmup times unmeasured, then settings.iterations times, and returns those timings.
+    [[nodiscard]] std::vector<double> time_iterations(const ScenarioSettings &settings, const std::function<void()> &iteration);
+
+    [[nodiscard]] std::string              to_json(const std::vector<MetricStats> &results);
+    [[nodiscard]] std::vector<MetricStats> parse_json(const std::string &text);
+
+    struct Regression {
+        std::string name;
+        double      baseline;
+        double      current;
+    };
+
+    // Compares p50s, which are steadier than means on shared CI machines. Metrics missing on either side are skipped.
+    [[nodiscard]] std::vector<Regression> compare(const std::vector<MetricStats> &baseline, const std::vector<MetricStats> &current, double threshold);
+
+} // namespace neuron::bench
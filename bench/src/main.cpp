@@ -0,0 +1,99 @@
+#include "bench.hpp"
+#include "scenarios.hpp"
+
+#include "neuron/neuron.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static void usage() {
+    std::cerr << "usage: neuron_bench [--out <results.json>] [--compare <baseline.json>] [--threshold <fraction>] [--scenario <name>]..." << std::endl;
+    std::cerr << "                    [--iterations <n>] [--warmup <n>] [--window]" << std::endl;
+    std::cerr << "  --compare exits with 2 when a metric's p50 is more than --threshold (default 0.10) above the baseline" << std::endl;
+    std::cerr << "  --window adds swapchain frame pacing, which needs a display" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string                 out_path;
+    std::string                 baseline_path;
+    double                      threshold = 0.10;
+    std::vector<std::string>    selected;
+    neuron::bench::BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg      = argv[i];
+        const bool        has_next = i + 1 < argc;
+
+        if (arg == "--out" && has_next) {
+            out_path = argv[++i];
+        } else if (arg == "--compare" && has_next) {
+            baseline_path = argv[++i];
+        } else if (arg == "--threshold" && has_next) {
+            threshold = std::stod(argv[++i]);
+        } else if (arg == "--scenario" && has_next) {
+            selected.emplace_back(argv[++i]);
+        } else if (arg == "--iterations" && has_next) {
+            options.settings.iterations = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--warmup" && has_next) {
+            options.settings.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--window") {
+            options.window = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<neuron::bench::MetricStats> results;
+
+    try {
+        auto ctx = neuron::Context::create(neuron::ContextSettings{.application_name = "neuron-bench", .print_diagnostics = false});
+        std::cerr << "Device: " << ctx->physical_device_properties().deviceName << std::endl;
+
+        for (const auto &scenario : neuron::bench::scenarios()) {
+            if (!selected.empty() && std::ranges::find(selected, scenario.name) == selected.end()) {
+                continue;
+            }
+
+            std::cerr << "Running " << scenario.name << "..." << std::endl;
+            for (auto &metric : scenario.run(ctx, options)) {
+                results.push_back(std::move(metric));
+            }
+        }
+
+        ctx->wait_idle();
+    } catch (const std::exception &e) {
+        std::cerr << "neuron_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string json = neuron::bench::to_json(results);
+    if (out_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(out_path) << json;
+    }
+
+    if (baseline_path.empty()) {
+        return 0;
+    }
+
+    std::ifstream baseline_file(baseline_path);
+    if (!baseline_file) {
+        std::cerr << "neuron_bench: cannot read baseline " << baseline_path << std::endl;
+        return 1;
+    }
+
+    std::stringstream baseline_text;
+    baseline_text << baseline_file.rdbuf();
+
+    const auto regressions = neuron::bench::compare(neuron::bench::parse_json(baseline_text.str()), results, threshold);
+    for (const auto &r : regressions) {
+        std::cerr << "REGRESSION " << r.name << ": p50 " << r.baseline << " ms -> " << r.current << " ms (+" << (r.current / r.baseline - 1.0) * 100.0 << "%)" << std::endl;
+    }
+
+    return regressions.empty() ? 0 : 2;
+}
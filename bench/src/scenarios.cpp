@@ -0,0 +1,514 @@
+#include "scenarios.hpp"
+
+#include "neuron/debug/allocation_tracker.hpp"
+#include "neuron/os/window.hpp"
+#include "neuron/render/display_system.hpp"
+#include "neuron/render/graphics_pipeline.hpp"
+#include "neuron/render/mesh.hpp"
+#include "neuron/render/pipeline_library.hpp"
+#include "neuron/render/simple_render_pass.hpp"
+#include "neuron/render/submission_scheduler.hpp"
+#include "neuron/render/vertex_pulling.hpp"
+
+#include "shaders/main.frag.hpp"
+#include "shaders/mesh_vertex_input.vert.hpp"
+#include "shaders/vertex_pulling.vert.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace neuron::bench {
+    namespace {
+        constexpr vk::Format   TARGET_FORMAT = vk::Format::eR8G8B8A8Unorm;
+        constexpr vk::Extent2D TARGET_EXTENT{256, 256};
+
+        // Positions come from the vertex index, so no vertex buffers are involved.
+        constexpr const char *VERTEX_SHADER = R"(#version 450
+layout (push_constant) uniform constants {
+    vec2 offset;
+} PushConstants;
+
+void main() {
+    const vec2 positions[3] = vec2[](vec2(0.0, -0.05), vec2(0.05, 0.05), vec2(-0.05, 0.05));
+    gl_Position = vec4(positions[gl_VertexIndex] + PushConstants.offset, 0.0, 1.0);
+}
+)";
+
+        constexpr const char *FRAGMENT_SHADER = R"(#version 450
+layout (location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(1.0);
+}
+)";
+
+        struct OffscreenTarget {
+            VmaAllocated<vk::Image> image;
+            vk::ImageView           view;
+        };
+
+        OffscreenTarget create_target(const std::shared_ptr<Context> &ctx) {
+            OffscreenTarget target;
+            target.image = ctx->allocate_image(vk::ImageCreateInfo{{},
+                                                                   vk::ImageType::e2D,
+                                                                   TARGET_FORMAT,
+                                                                   vk::Extent3D{TARGET_EXTENT, 1},
+                                                                   1,
+                                                                   1,
+                                                                   vk::SampleCountFlagBits::e1,
+                                                                   vk::ImageTiling::eOptimal,
+                                                                   vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc},
+                                               VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+            target.view  = ctx->device().createImageView(
+                vk::ImageViewCreateInfo{{}, target.image.resource, vk::ImageViewType::e2D, TARGET_FORMAT, {}, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}});
+            return target;
+        }
+
+        void destroy_target(const std::shared_ptr<Context> &ctx, const OffscreenTarget &target) {
+            ctx->device().destroyImageView(target.view);
+            ctx->free_image(target.image);
+        }
+
+        render::ShaderModuleInfo glsl(const char *source, vk::ShaderStageFlagBits stage) {
+            return render::ShaderModuleInfo{.source = render::ShaderCode{.code = std::string(source)}, .type = render::ShaderModuleSourceType::GLSL, .stage = stage};
+        }
+
+        render::GraphicsPipelineBuilder triangle_pipeline_builder(vk::Format format, vk::Extent2D extent) {
+            render::GraphicsPipelineBuilder builder;
+            builder.add_shader(vk::ShaderStageFlagBits::eVertex, glsl(VERTEX_SHADER, vk::ShaderStageFlagBits::eVertex))
+                .add_shader(vk::ShaderStageFlagBits::eFragment, glsl(FRAGMENT_SHADER, vk::ShaderStageFlagBits::eFragment))
+                .add_viewport({0.0f, 0.0f}, extent, 0.0f, 1.0f)
+                .add_scissor({0, 0}, extent)
+                .add_color_attachment_with_standard_blend(format);
+            builder.cull_mode           = vk::CullModeFlagBits::eNone;
+            builder.derive_vertex_input = false;
+            return builder;
+        }
+
+        // A grid of small triangles, one draw call each.
+        void record_draws(const vk::CommandBuffer &cmd, const render::GraphicsPipeline &pipeline, uint32_t draws) {
+            cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+
+            for (uint32_t i = 0; i < draws; i++) {
+                const float offset[2] = {static_cast<float>(i % 16) / 8.0f - 0.94f, static_cast<float>(i / 16 % 16) / 8.0f - 0.94f};
+                cmd.pushConstants(pipeline.layout()->pipeline_layout(), vk::ShaderStageFlagBits::eVertex, 0, sizeof(offset), offset);
+                cmd.draw(3, 1, 0, 0);
+            }
+        }
+
+        void record_offscreen_frame(const vk::CommandBuffer &cmd, const OffscreenTarget &target, const render::GraphicsPipeline &pipeline, uint32_t draws) {
+            cmd.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            render::simple_render_pass(cmd, {target.image.resource, target.view, {{0, 0}, TARGET_EXTENT}, {0.0f, 0.0f, 0.0f, 1.0f}, false},
+                                       [&](const vk::CommandBuffer &cmd) { record_draws(cmd, pipeline, draws); });
+            cmd.end();
+        }
+
+        std::vector<MetricStats> draw_calls(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            constexpr uint32_t DRAWS = 2000;
+
+            auto target   = create_target(ctx);
+            auto pipeline = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT).build(ctx);
+            auto pool     = std::make_shared<CommandPool>(ctx, ctx->main_queue_family(), true);
+            auto cmd      = pool->allocate_command_buffer();
+
+            std::vector<double> record_ms;
+            auto                frame_ms = time_iterations(options.settings, [&] {
+                const auto begin = std::chrono::steady_clock::now();
+                cmd.reset();
+                record_offscreen_frame(cmd, target, *pipeline, DRAWS);
+                record_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+
+                ctx->main_scheduler()->wait(ctx->main_scheduler()->submit({.command_buffers = std::span(&cmd, 1)}));
+            });
+
+            // the warm-up frames are not part of the record timings either
+            record_ms.erase(record_ms.begin(), record_ms.begin() + options.settings.warmup);
+
+            pipeline.reset();
+            pool->free_command_buffers({cmd});
+            destroy_target(ctx, target);
+
+            return {summarize("draw_calls.record_2000_ms", record_ms), summarize("draw_calls.frame_2000_ms", frame_ms)};
+        }
+
+        std::vector<MetricStats> buffer_upload(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            constexpr size_t SIZE = 16ULL * 1024 * 1024;
+
+            const std::vector<std::byte> data(SIZE, std::byte{0x5a});
+
+            auto samples = time_iterations(options.settings, [&] {
+                auto buffer = ctx->allocate_gpu_buffer(SIZE, data.data(), vk::BufferUsageFlagBits::eStorageBuffer);
+                ctx->free_buffer(buffer);
+            });
+
+            return {summarize("buffer_upload.16mib_ms", samples)};
+        }
+
+        std::vector<MetricStats> pipeline_creation(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            // shaders are compiled and reflected once, only vkCreateGraphicsPipelines is measured
+            auto builder = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT);
+            builder.reflect(ctx);
+
+            // Drivers keep caches of their own (Mesa: set MESA_SHADER_CACHE_DISABLE=true), which "cold" cannot rule out.
+            auto cold = time_iterations(options.settings, [&] {
+                builder.pipeline_cache = ctx->device().createPipelineCache({});
+                builder.build(ctx).reset();
+                ctx->device().destroyPipelineCache(builder.pipeline_cache);
+            });
+
+            builder.pipeline_cache = ctx->device().createPipelineCache({});
+            builder.build(ctx).reset();
+
+            auto warm = time_iterations(options.settings, [&] { builder.build(ctx).reset(); });
+
+            ctx->device().destroyPipelineCache(builder.pipeline_cache);
+
+            return {summarize("pipeline_creation.cold_ms", cold), summarize("pipeline_creation.warm_ms", warm)};
+        }
+
+        // 24 combinations of cull mode, front face, depth test and blending.
+        std::vector<render::GraphicsPipelineBuilder> permutation_builders(const render::GraphicsPipelineBuilder &base, bool dynamic) {
+            std::vector<render::GraphicsPipelineBuilder> builders;
+
+            for (const auto cull : {vk::CullModeFlagBits::eNone, vk::CullModeFlagBits::eBack, vk::CullModeFlagBits::eFront}) {
+                for (const auto face : {vk::FrontFace::eClockwise, vk::FrontFace::eCounterClockwise}) {
+                    for (const bool depth : {false, true}) {
+                        for (const bool blend : {false, true}) {
+                            auto builder                                   = base;
+                            builder.dynamic_pipeline_state                 = dynamic;
+                            builder.cull_mode                              = cull;
+                            builder.front_face                             = face;
+                            builder.enable_depth_test                      = depth;
+                            builder.color_blend_attachments[0].blendEnable = blend;
+                            builders.push_back(std::move(builder));
+                        }
+                    }
+                }
+            }
+
+            return builders;
+        }
+
+        // The permutations through a GraphicsPipelineCache: 24 pipelines baked, as few as one with dynamic_pipeline_state.
+        std::vector<MetricStats> pipeline_permutations(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            auto base = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT);
+            base.reflect(ctx);
+
+            auto build_all = [&](bool dynamic) {
+                render::GraphicsPipelineCache                          cache;
+                std::vector<std::shared_ptr<render::GraphicsPipeline>> pipelines;
+
+                for (auto &builder : permutation_builders(base, dynamic)) {
+                    pipelines.push_back(cache.get_or_create(ctx, builder));
+                }
+
+                return cache.size();
+            };
+
+            size_t baked_count   = 0;
+            size_t dynamic_count = 0;
+            auto   baked         = time_iterations(options.settings, [&] { baked_count = build_all(false); });
+            auto   dynamic       = time_iterations(options.settings, [&] { dynamic_count = build_all(true); });
+
+            std::cerr << "pipeline_permutations: " << baked_count << " pipelines baked, " << dynamic_count << " with dynamic state" << std::endl;
+
+            return {summarize("pipeline_permutations.baked_ms", baked), summarize("pipeline_permutations.dynamic_ms", dynamic)};
+        }
+
+        // The baked permutations again, fast-linked from pipeline libraries. Background optimization is off, so this is the
+        // time until every pipeline is usable.
+        std::vector<MetricStats> pipeline_libraries(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            auto base = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT);
+            base.reflect(ctx);
+
+            size_t library_count = 0;
+            bool   linked        = false;
+
+            auto samples = time_iterations(options.settings, [&] {
+                auto cache = render::PipelineLibraryCache::create(ctx, {.optimize_in_background = false});
+
+                std::vector<std::shared_ptr<render::GraphicsPipeline>> pipelines;
+                for (auto &builder : permutation_builders(base, false)) {
+                    pipelines.push_back(cache->get_or_create(builder));
+                }
+
+                library_count = cache->library_count();
+                linked        = cache->uses_libraries();
+            });
+
+            if (linked) {
+                std::cerr << "pipeline_libraries: 24 pipelines linked from " << library_count << " libraries" << std::endl;
+            } else {
+                std::cerr << "pipeline_libraries: graphics pipeline libraries unavailable, pipelines built monolithically" << std::endl;
+            }
+
+            return {summarize("pipeline_libraries.linked_ms", samples)};
+        }
+
+        // A GRID x GRID quad surface with bumpy normals and a color gradient, quantized with normals and colors.
+        render::QuantizedMesh grid_mesh() {
+            constexpr uint32_t GRID = 128;
+
+            constexpr std::array<std::pair<uint32_t, uint32_t>, 6> QUAD_CORNERS = {{{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}};
+
+            auto vertex = [](uint32_t x, uint32_t y) {
+                const float u = static_cast<float>(x) / GRID;
+                const float v = static_cast<float>(y) / GRID;
+
+                render::MeshVertex result;
+                result.position = {u * 1.8f - 0.9f, v * 1.8f - 0.9f, 0.5f};
+                result.normal   = glm::normalize(glm::vec3{std::sin(u * 20.0f) * 0.5f, std::cos(v * 20.0f) * 0.5f, 1.0f});
+                result.color    = {u, v, 1.0f - u, 1.0f};
+                return result;
+            };
+
+            std::vector<render::MeshVertex> soup;
+            soup.reserve(static_cast<size_t>(GRID) * GRID * 6);
+            for (uint32_t y = 0; y < GRID; y++) {
+                for (uint32_t x = 0; x < GRID; x++) {
+                    for (const auto &[dx, dy] : QUAD_CORNERS) {
+                        soup.push_back(vertex(x + dx, y + dy));
+                    }
+                }
+            }
+
+            return render::prepare_mesh(soup);
+        }
+
+        render::GraphicsPipelineBuilder mesh_pipeline_builder(std::span<const uint32_t> vertex_shader) {
+            render::GraphicsPipelineBuilder builder;
+            builder.add_spirv_shader(vk::ShaderStageFlagBits::eVertex, vertex_shader)
+                .add_spirv_shader(vk::ShaderStageFlagBits::eFragment, shaders::main_frag)
+                .add_viewport({0.0f, 0.0f}, TARGET_EXTENT, 0.0f, 1.0f)
+                .add_scissor({0, 0}, TARGET_EXTENT)
+                .add_color_attachment_with_standard_blend(TARGET_FORMAT);
+            builder.cull_mode           = vk::CullModeFlagBits::eNone;
+            builder.derive_vertex_input = false;
+            return builder;
+        }
+
+        // One mesh drawn DRAWS times per frame, once through vertex input bindings and once fetched by vertex_pulling.vert
+        // through its buffer address; both shaders decode and shade the same streams.
+        std::vector<MetricStats> vertex_fetch(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            constexpr uint32_t DRAWS = 64;
+
+            auto mesh   = render::Mesh::create(ctx, grid_mesh());
+            auto target = create_target(ctx);
+            auto pool   = std::make_shared<CommandPool>(ctx, ctx->main_queue_family(), true);
+            auto cmd    = pool->allocate_command_buffer();
+
+            auto time_frames = [&](const render::GraphicsPipeline &pipeline, const auto &bind_mesh) {
+                return time_iterations(options.settings, [&] {
+                    cmd.reset();
+                    cmd.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+                    render::simple_render_pass(cmd, {target.image.resource, target.view, {{0, 0}, TARGET_EXTENT}, {0.0f, 0.0f, 0.0f, 1.0f}, false},
+                                               [&](const vk::CommandBuffer &cmd) {
+                                                   cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+                                                   bind_mesh(cmd, pipeline.layout()->pipeline_layout());
+                                                   for (uint32_t i = 0; i < DRAWS; i++) {
+                                                       mesh->draw(cmd);
+                                                   }
+                                               });
+                    cmd.end();
+
+                    ctx->main_scheduler()->wait(ctx->main_scheduler()->submit({.command_buffers = std::span(&cmd, 1)}));
+                });
+            };
+
+            std::vector<MetricStats> results;
+
+            {
+                auto builder = mesh_pipeline_builder(shaders::mesh_vertex_input_vert);
+                mesh->layout().apply(builder);
+                auto pipeline = builder.build(ctx);
+
+                const std::array<glm::vec4, 2> push = {glm::vec4(mesh->position_scale(), 0.0f), glm::vec4(mesh->position_offset(), 0.0f)};
+
+                results.push_back(summarize("vertex_fetch.vertex_input_ms", time_frames(*pipeline, [&](const vk::CommandBuffer &cmd, vk::PipelineLayout layout) {
+                    cmd.pushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(push), push.data());
+                    mesh->bind(cmd);
+                })));
+            }
+
+            if (mesh->vertex_address() != 0) {
+                auto builder  = mesh_pipeline_builder(shaders::vertex_pulling_vert);
+                auto pipeline = builder.set_vertex_pulling().build(ctx);
+
+                const render::VertexPullingPushConstants push = render::vertex_pulling_constants(*mesh);
+
+                results.push_back(summarize("vertex_fetch.vertex_pulling_ms", time_frames(*pipeline, [&](const vk::CommandBuffer &cmd, vk::PipelineLayout layout) {
+                    cmd.pushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(push), &push);
+                    mesh->bind_indices(cmd);
+                })));
+            } else {
+                std::cerr << "vertex_fetch: buffer device address unavailable, vertex pulling skipped" << std::endl;
+            }
+
+            ctx->wait_idle();
+            mesh.reset();
+            pool->free_command_buffers({cmd});
+            destroy_target(ctx, target);
+
+            return results;
+        }
+
+        std::vector<MetricStats> shader_compilation(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            auto vertex   = time_iterations(options.settings, [&] { render::ShaderModule::load(ctx, glsl(VERTEX_SHADER, vk::ShaderStageFlagBits::eVertex)); });
+            auto fragment = time_iterations(options.settings, [&] { render::ShaderModule::load(ctx, glsl(FRAGMENT_SHADER, vk::ShaderStageFlagBits::eFragment)); });
+
+            return {summarize("shader_compilation.vertex_ms", vertex), summarize("shader_compilation.fragment_ms", fragment)};
+        }
+
+        std::vector<MetricStats> frame_pacing(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            constexpr uint32_t DRAWS  = 200;
+            constexpr size_t   FRAMES = render::DisplaySystem::MAX_FRAMES_IN_FLIGHT;
+
+            std::vector<MetricStats> results;
+
+            // offscreen: frames overlap like they would with a swapchain, the CPU waits for the frame FRAMES back
+            {
+                auto target   = create_target(ctx);
+                auto pipeline = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT).build(ctx);
+                auto pool     = std::make_shared<CommandPool>(ctx, ctx->main_queue_family(), true);
+                auto cmds     = pool->allocate_command_buffers(FRAMES);
+
+                std::array<uint64_t, FRAMES> submitted{};
+                size_t                       frame = 0;
+
+                auto samples = time_iterations(options.settings, [&] {
+                    ctx->main_scheduler()->wait(submitted[frame]);
+
+                    cmds[frame].reset();
+                    record_offscreen_frame(cmds[frame], target, *pipeline, DRAWS);
+                    submitted[frame] = ctx->main_scheduler()->submit({.command_buffers = std::span(&cmds[frame], 1)});
+
+                    frame = (frame + 1) % FRAMES;
+                });
+
+                ctx->wait_idle();
+                pipeline.reset();
+                pool->free_command_buffers(cmds);
+                destroy_target(ctx, target);
+
+                results.push_back(summarize("frame_pacing.offscreen_ms", samples));
+            }
+
+            if (options.window) {
+                auto window         = os::Window::create(ctx, {"neuron-bench", static_cast<int>(TARGET_EXTENT.width), static_cast<int>(TARGET_EXTENT.height), false});
+                auto display_system = render::DisplaySystem::create(ctx, {.vsync = false}, window);
+                auto extent         = display_system->swapchain_config().extent;
+                auto pipeline       = triangle_pipeline_builder(display_system->display_target_config().format, extent).build(ctx);
+                auto pool           = std::make_shared<CommandPool>(ctx, ctx->main_queue_family(), true);
+                auto cmds           = pool->allocate_command_buffers(FRAMES);
+
+                auto samples = time_iterations(options.settings, [&] {
+                    os::Window::poll_events();
+
+                    const auto &frame_info = display_system->acquire_next_frame();
+                    const auto &cmd        = cmds[frame_info.current_frame];
+
+                    cmd.reset();
+                    cmd.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+                    render::simple_render_pass(cmd, {frame_info.image, frame_info.image_view, {{0, 0}, extent}, {0.0f, 0.0f, 0.0f, 1.0f}, true},
+                                               [&](const vk::CommandBuffer &cmd) { record_draws(cmd, *pipeline, DRAWS); });
+                    cmd.end();
+
+                    const render::TimelineWait image_available{frame_info.image_available, 0, vk::PipelineStageFlagBits::eColorAttachmentOutput};
+                    ctx->main_scheduler()->enqueue({.command_buffers = std::span(&cmd, 1),
+                                                    .waits           = std::span(&image_available, 1),
+                                                    .signal_binary   = std::span(&frame_info.render_finished, 1),
+                                                    .fence           = frame_info.in_flight});
+
+                    display_system->present_frame();
+                });
+
+                ctx->wait_idle();
+                pipeline.reset();
+                pool->free_command_buffers(cmds);
+
+                results.push_back(summarize("frame_pacing.swapchain_ms", samples));
+            }
+
+            return results;
+        }
+
+        // The offscreen frame loop of frame_pacing, failing when a frame allocates after the warm-up. Heap allocations are
+        // only seen with NEURON_TRACK_ALLOCATIONS; VMA allocations always are.
+        std::vector<MetricStats> steady_state(const std::shared_ptr<Context> &ctx, const BenchOptions &options) {
+            constexpr uint32_t DRAWS  = 200;
+            constexpr size_t   FRAMES = render::DisplaySystem::MAX_FRAMES_IN_FLIGHT;
+
+            auto target   = create_target(ctx);
+            auto pipeline = triangle_pipeline_builder(TARGET_FORMAT, TARGET_EXTENT).build(ctx);
+            auto pool     = std::make_shared<CommandPool>(ctx, ctx->main_queue_family(), true);
+            auto cmds     = pool->allocate_command_buffers(FRAMES);
+
+            std::array<uint64_t, FRAMES> submitted{};
+            size_t                       frame = 0;
+
+            auto run_frame = [&] {
+                ctx->main_scheduler()->wait(submitted[frame]);
+
+                cmds[frame].reset();
+                record_offscreen_frame(cmds[frame], target, *pipeline, DRAWS);
+                submitted[frame] = ctx->main_scheduler()->submit({.command_buffers = std::span(&cmds[frame], 1)});
+
+                frame = (frame + 1) % FRAMES;
+            };
+
+            for (uint32_t i = 0; i < options.settings.warmup; i++) {
+                run_frame();
+            }
+
+            // reserved up front, so the samples themselves do not allocate inside the measured frames
+            std::vector<double> samples;
+            samples.reserve(options.settings.iterations);
+
+            const debug::AllocationScope allocations;
+            for (uint32_t i = 0; i < options.settings.iterations; i++) {
+                const auto begin = std::chrono::steady_clock::now();
+                run_frame();
+                samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+            }
+            const auto counts = allocations.delta();
+
+            ctx->wait_idle();
+            pipeline.reset();
+            pool->free_command_buffers(cmds);
+            destroy_target(ctx, target);
+
+            if (counts.allocations() > 0) {
+                throw std::runtime_error("steady_state: " + std::to_string(counts.heap_allocations) + " heap, " + std::to_string(counts.vma_allocations) + " VMA and " +
+                                         std::to_string(counts.device_memory_allocations) + " device memory allocations in " +
+                                         std::to_string(options.settings.iterations) + " frames after warm-up");
+            }
+            if (!debug::heap_tracking_enabled()) {
+                std::cerr << "steady_state: heap allocations not checked, configure with -DNEURON_TRACK_ALLOCATIONS=ON" << std::endl;
+            }
+
+            return {summarize("steady_state.frame_ms", std::move(samples))};
+        }
+    } // namespace
+
+    const std::vector<Scenario> &scenarios() {
+        static const std::vector<Scenario> all = {
+            {"draw_calls", draw_calls},
+            {"buffer_upload", buffer_upload},
+            {"pipeline_creation", pipeline_creation},
+            {"pipeline_permutations", pipeline_permutations},
+            {"pipeline_libraries", pipeline_libraries},
+            {"vertex_fetch", vertex_fetch},
+            {"shader_compilation", shader_compilation},
+            {"frame_pacing", frame_pacing},
+            {"steady_state", steady_state},
+        };
+        return all;
+    }
+} // namespace neuron::bench
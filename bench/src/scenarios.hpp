@@ -0,0 +1,27 @@
+#pragma once
+
+#include "bench.hpp"
+
+#include "neuron/neuron.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace neuron::bench {
+
+    struct BenchOptions {
+        ScenarioSettings settings;
+        // Swapchain frame pacing needs a window and a display; everything else renders offscreen.
+        bool window = false;
+    };
+
+    using ScenarioFn = std::vector<MetricStats> (*)(const std::shared_ptr<Context> &ctx, const BenchOptions &options);
+
+    struct Scenario {
+        const char *name;
+        ScenarioFn  run;
+    };
+
+    [[nodiscard]] const std::vector<Scenario> &scenarios();
+
+} // namespace neuron::bench
@@ -0,0 +1,101 @@
+# Build-time GLSL compilation with glslc.
+#
+#   neuron_embed_shaders(<target>
+#       NAMESPACE <namespace>                 # C++ namespace of the arrays, e.g. example::shaders
+#       [HEADER_DIR <dir>]                    # include prefix of the generated headers, default "shaders"
+#       [OPTIMIZATION performance|size|none]  # default performance
+#       [TARGET_ENV <env>]                    # default vulkan1.2, the version the Context targets
+#       [DEFINES <NAME[=VALUE]>...]
+#       [INCLUDE_DIRECTORIES <dir>...]
+#       SOURCES <shader>...)
+#
+# Each shader becomes a header <HEADER_DIR>/<file name>.hpp in the target's include path, declaring
+#
+#   inline constexpr uint32_t <file name, non-alphanumerics as '_'>[] = {...};
+#
+# e.g. res/shaders/main.vert is #include "shaders/main.vert.hpp" with main_vert, usable directly as
+# neuron::render::ShaderCode{.code = std::span<const uint32_t>(main_vert)}. glslc infers the stage from the extension.
+# Shaders are recompiled when they or anything they #include change.
+
+find_program(NEURON_GLSLC glslc HINTS "$ENV{VULKAN_SDK}/bin" "$ENV{VULKAN_SDK}/Bin")
+
+function(neuron_embed_shaders target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "NAMESPACE;HEADER_DIR;OPTIMIZATION;TARGET_ENV" "DEFINES;INCLUDE_DIRECTORIES;SOURCES")
+
+    if (NOT NEURON_GLSLC)
+        message(FATAL_ERROR "neuron_embed_shaders: glslc not found, install the Vulkan SDK or set NEURON_GLSLC")
+    endif()
+    if (NOT ARG_NAMESPACE)
+        message(FATAL_ERROR "neuron_embed_shaders: NAMESPACE is required")
+    endif()
+
+    if (NOT ARG_HEADER_DIR)
+        set(ARG_HEADER_DIR shaders)
+    endif()
+    if (NOT ARG_OPTIMIZATION)
+        set(ARG_OPTIMIZATION performance)
+    endif()
+    if (NOT ARG_TARGET_ENV)
+        set(ARG_TARGET_ENV vulkan1.2)
+    endif()
+
+    if (ARG_OPTIMIZATION STREQUAL "performance")
+        set(optimization_flag -O)
+    elseif (ARG_OPTIMIZATION STREQUAL "size")
+        set(optimization_flag -Os)
+    elseif (ARG_OPTIMIZATION STREQUAL "none")
+        set(optimization_flag -O0)
+    else()
+        message(FATAL_ERROR "neuron_embed_shaders: OPTIMIZATION must be performance, size or none, not ${ARG_OPTIMIZATION}")
+    endif()
+
+    set(flags --target-env=${ARG_TARGET_ENV} ${optimization_flag})
+    foreach (define IN LISTS ARG_DEFINES)
+        list(APPEND flags -D${define})
+    endforeach()
+    foreach (dir IN LISTS ARG_INCLUDE_DIRECTORIES)
+        list(APPEND flags -I${dir})
+    endforeach()
+
+    set(include_root ${CMAKE_CURRENT_BINARY_DIR}/${target}_shaders)
+    set(output_dir ${include_root}/${ARG_HEADER_DIR})
+    file(MAKE_DIRECTORY ${output_dir})
+
+    set(outputs)
+    foreach (source IN LISTS ARG_SOURCES)
+        get_filename_component(source_path ${source} ABSOLUTE)
+        get_filename_component(name ${source} NAME)
+        string(MAKE_C_IDENTIFIER ${name} identifier)
+
+        set(numbers ${output_dir}/${name}.inc)
+        set(header ${output_dir}/${name}.hpp)
+
+        # -mfmt=num writes the words as a comma separated list, which the header includes as the array initializer
+        add_custom_command(
+            OUTPUT ${numbers}
+            COMMAND ${NEURON_GLSLC} ${flags} -mfmt=num -MD -MF ${numbers}.d -MT ${numbers} -o ${numbers} ${source_path}
+            MAIN_DEPENDENCY ${source_path}
+            DEPFILE ${numbers}.d
+            COMMENT "Compiling shader ${name}"
+            VERBATIM
+        )
+
+        file(CONFIGURE OUTPUT ${header} CONTENT [[
+// Generated by neuron_embed_shaders from @source_path@, do not edit.
+#pragma once
+
+#include <cstdint>
+
+namespace @ARG_NAMESPACE@ {
+    inline constexpr uint32_t @identifier@[] = {
+#include "@name@.inc"
+    };
+} // namespace @ARG_NAMESPACE@
+]] @ONLY)
+
+        list(APPEND outputs ${numbers} ${header})
+    endforeach()
+
+    target_sources(${target} PRIVATE ${outputs})
+    target_include_directories(${target} PRIVATE ${include_root})
+endfunction()
@@ -1,19 +1,49 @@
+#include "neuron/debug/allocation_tracker.hpp"
+#include "neuron/jobs/job_system.hpp"
 #include "neuron/neuron.hpp"
 #include "neuron/os/window.hpp"
 #include "neuron/render/display_system.hpp"
+#include "neuron/render/dynamic_resolution.hpp"
 #include "neuron/render/graphics_pipeline.hpp"
-#include "neuron/render/simple_render_pass.hpp"
+#include "neuron/render/mesh.hpp"
+#include "neuron/render/render_pass.hpp"
+#include "neuron/render/render_thread.hpp"
+#include "neuron/render/submission_scheduler.hpp"
+
+#include "shaders/main.frag.hpp"
+#include "shaders/main.vert.hpp"
 
 
 #include <iostream>
 #include <memory>
+#include <string_view>
 
-int main() {
+int main(int argc, char **argv) {
     std::cout << "Running Neuron version: " << neuron::get_version() << std::endl;
 
+    // --dynamic-resolution renders offscreen at a scale that keeps the GPU frame time in budget, then upscales.
+    // --render-thread runs the frame loop on its own thread while this one only handles window events.
+    bool dynamic_resolution = false;
+    bool use_render_thread  = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        dynamic_resolution |= arg == "--dynamic-resolution";
+        use_render_thread |= arg == "--render-thread";
+    }
+
+    // shaders are compiled at build time; the pipeline layout is reflected from them, vertex input comes from the quantized mesh
+    auto graphics_pipeline_b = neuron::render::GraphicsPipelineBuilder()
+                                   .add_spirv_shader(vk::ShaderStageFlagBits::eVertex, example::shaders::main_vert)
+                                   .add_spirv_shader(vk::ShaderStageFlagBits::eFragment, example::shaders::main_frag);
+    graphics_pipeline_b.derive_vertex_input = false;
+
+    // shaders reflect in the background while the window and swapchain are created
     auto ctx = neuron::Context::create(neuron::ContextSettings{
         .application_name = "neuron-example", .application_version = neuron::Version{0, 1, 0}, .enable_api_validation = true,
         // .enable_api_dump       = true,
+        .print_diagnostics = false,
+        .fast_start        = true,
+        .warm_up           = [&](const std::shared_ptr<neuron::Context> &c) { graphics_pipeline_b.reflect(c); },
     });
 
     auto         window          = neuron::os::Window::create(ctx, {"Hello!", 800, 600, true});
@@ -25,84 +55,135 @@ int main() {
     auto command_pool    = std::make_shared<neuron::CommandPool>(ctx, ctx->main_queue_family(), true);
     auto command_buffers = command_pool->allocate_command_buffers(neuron::render::DisplaySystem::MAX_FRAMES_IN_FLIGHT);
 
-    // auto pipline_layout_builder
-
-    auto pipeline_layout = neuron::render::PipelineLayoutBuilder().add_push_constant_range(vk::ShaderStageFlagBits::eVertex, 0, 4).build(ctx);
-
-    auto graphics_pipeline_b = neuron::render::GraphicsPipelineBuilder(pipeline_layout)
-                                 .add_glsl_shader("res/shaders/main.vert")
-                                 .add_glsl_shader("res/shaders/main.frag")
-                                 .add_viewport({0.0f, 0.0f}, original_extent, 0.0f, 1.0f)
-                                 .add_scissor({0, 0}, original_extent)
-                                 .add_dynamic_state(vk::DynamicState::eViewport)
-                                 .add_dynamic_state(vk::DynamicState::eScissor)
-                                 .add_color_attachment_with_standard_blend(display_system->display_target_config().format)
-                                 .set_depth_attachment_format(vk::Format::eD24UnormS8Uint)
-                                 .set_stencil_attachment_format(vk::Format::eD24UnormS8Uint)
-                                 .add_vertex_binding(0, 8 * sizeof(float))
-                                 .add_vertex_attribute(0, 0, vk::Format::eR32G32B32A32Sfloat, 0)
-                                 .add_vertex_attribute(0, 1, vk::Format::eR32G32B32A32Sfloat, 4 * sizeof(float));
+    std::vector<neuron::render::MeshVertex> vertices = {
+        {.position = {0.0f, -0.5f, 0.0f}, .color = {1.0f, 0.0f, 0.0f, 1.0f}},
+        {.position = {0.5f, 0.5f, 0.0f}, .color = {0.0f, 1.0f, 0.0f, 1.0f}},
+        {.position = {-0.5f, 0.5f, 0.0f}, .color = {0.0f, 0.0f, 1.0f, 1.0f}},
+    };
+
+    // 12 bytes per vertex (snorm16 position, unorm8 color) instead of two vec4s
+    auto quantized = neuron::render::prepare_mesh(vertices, {.include_normals = false});
+    auto mesh      = neuron::render::Mesh::create(ctx, quantized);
+
+    // D32 is supported as a depth attachment everywhere, D24S8 is not (AMD)
+    constexpr vk::Format DEPTH_FORMAT = vk::Format::eD32Sfloat;
+
+    ctx->wait_for_warm_up();
+    graphics_pipeline_b.add_viewport({0.0f, 0.0f}, original_extent, 0.0f, 1.0f)
+        .add_scissor({0, 0}, original_extent)
+        .add_dynamic_state(vk::DynamicState::eViewport)
+        .add_dynamic_state(vk::DynamicState::eScissor)
+        .add_color_attachment_with_standard_blend(display_system->display_target_config().format)
+        .set_depth_attachment_format(DEPTH_FORMAT);
     graphics_pipeline_b.cull_mode = vk::CullModeFlagBits::eNone;
+    quantized.layout.apply(graphics_pipeline_b);
     auto graphics_pipeline = graphics_pipeline_b.build(ctx);
+    auto pipeline_layout   = graphics_pipeline->layout();
+    auto push_stages       = pipeline_layout->push_constant_ranges().front().stageFlags;
+
+    struct PushConstants {
+        float     time;
+        float     _pad0[3];
+        glm::vec3 position_scale;
+        float     _pad1;
+        glm::vec3 position_offset;
+    };
 
-    double last_frame = -std::numeric_limits<double>::infinity();
-    double this_frame = glfwGetTime();
+    PushConstants push{};
+    push.position_scale  = mesh->position_scale();
+    push.position_offset = mesh->position_offset();
 
-    double best_fps = 0.0f;
+    // The swapchain image is cleared and stored for presenting. Depth only lives inside the pass: transient, so it is
+    // never written back and tiled GPUs need not even back it with memory.
+    std::shared_ptr<neuron::render::AttachmentImage> depth;
 
-    std::vector<glm::vec4> vertices = {
-        {0.0f, -0.5f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.5f, 0.5f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {-0.5f, 0.5f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f},
-    };
+    neuron::render::RenderAttachment color_attachment{};
+    color_attachment.load_op      = vk::AttachmentLoadOp::eClear;
+    color_attachment.store_op     = vk::AttachmentStoreOp::eStore;
+    color_attachment.clear_value  = vk::ClearColorValue{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.final_layout = vk::ImageLayout::ePresentSrcKHR;
 
-    auto buffer = ctx->allocate_gpu_buffer(vertices, vk::BufferUsageFlagBits::eVertexBuffer);
+    neuron::render::RenderPassDescription pass;
+    pass.add_color_attachment(color_attachment);
 
+    std::shared_ptr<neuron::render::DynamicResolutionRenderer> dynamic_renderer;
+    if (dynamic_resolution) {
+        dynamic_renderer = neuron::render::DynamicResolutionRenderer::create(ctx, {.color_format = display_system->display_target_config().format, .depth_format = DEPTH_FORMAT});
+    }
 
-    while (window->is_open()) {
-        neuron::os::Window::poll_events();
+    double last_frame = -std::numeric_limits<double>::infinity();
+    double this_frame = glfwGetTime();
 
-        auto frame_info = display_system->acquire_next_frame();
+    double best_fps = 0.0f;
 
-        auto render_area = vk::Rect2D{{0, 0}, display_system->swapchain_config().extent};
+    // the first frames in flight still grow scheduler and driver-side pools
+    constexpr uint64_t             WARM_UP_FRAMES    = 8;
+    uint64_t                       frame_count       = 0;
+    uint64_t                       allocating_frames = 0;
+    neuron::debug::AllocationScope frame_allocations;
+
+    auto draw_frame = [&] {
+        const auto &frame_info = display_system->acquire_next_frame();
+
+        const vk::Extent2D output_extent = display_system->swapchain_config().extent;
+        vk::Rect2D         render_area   = {{0, 0}, output_extent};
 
         vk::CommandBuffer cmd = command_buffers[frame_info.current_frame];
         cmd.reset();
         cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
 
-        neuron::render::SimpleRenderPassInfo pass_info{frame_info.image, frame_info.image_view, render_area, {0.0f, 0.0f, 0.0f, 1.0f}, true};
-
-        neuron::render::simple_render_pass(cmd, pass_info, [&](const vk::CommandBuffer &cmd) {
+        const neuron::render::RenderPassDescription *scene_pass = &pass;
+        if (dynamic_renderer) {
+            const auto &dynamic_frame = dynamic_renderer->begin_frame(cmd, frame_info.current_frame, output_extent);
+            render_area               = dynamic_frame.render_area;
+            scene_pass                = &dynamic_frame.pass;
+        } else if (!depth || depth->info().extent != render_area.extent) {
+            if (depth) {
+                ctx->wait_idle(); // the frames in flight may still use the old one
+            }
+            depth.reset();
+            depth = neuron::render::AttachmentImage::create(ctx, {.format = DEPTH_FORMAT, .extent = render_area.extent, .transient = true});
+            pass.set_depth_attachment(depth->attachment(vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare, vk::ClearDepthStencilValue{1.0f, 0}));
+        }
+
+        pass.render_area                     = render_area;
+        pass.color_attachments[0].image      = frame_info.image;
+        pass.color_attachments[0].image_view = frame_info.image_view;
+
+        neuron::render::render_pass(*ctx, cmd, *scene_pass, [&](const vk::CommandBuffer &cmd) {
             cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, graphics_pipeline->pipeline());
             cmd.setViewport(0, vk::Viewport{0.0f, 0.0f, static_cast<float>(render_area.extent.width), static_cast<float>(render_area.extent.height), 0.0f, 1.0f});
 
             vk::Rect2D s = {{0, 0}, {render_area.extent.width / 2, render_area.extent.height}};
             cmd.setScissor(0, s);
 
-            const auto time = static_cast<float>(glfwGetTime());
+            push.time = static_cast<float>(glfwGetTime());
 
-            cmd.pushConstants(pipeline_layout->pipeline_layout(), vk::ShaderStageFlagBits::eVertex, 0, 4, &time);
+            cmd.pushConstants(pipeline_layout->pipeline_layout(), push_stages, 0, sizeof(PushConstants), &push);
 
-            cmd.bindVertexBuffers(0, buffer.resource, {0});
+            mesh->bind(cmd);
 
-            cmd.draw(3, 1, 0, 0);
+            mesh->draw(cmd, 1, 0);
 
 
             s.offset.x = static_cast<int>(render_area.extent.width) / 2;
             cmd.setScissor(0, s);
 
-            cmd.draw(3, 1, 0, 1);
+            mesh->draw(cmd, 1, 1);
         });
 
-        cmd.end();
+        if (dynamic_renderer) {
+            dynamic_renderer->end_frame(cmd, frame_info.current_frame, frame_info.image);
+        }
 
-        vk::SubmitInfo si{};
-        si.setCommandBuffers(cmd);
-        si.setWaitSemaphores(frame_info.image_available);
-        si.setSignalSemaphores(frame_info.render_finished);
+        cmd.end();
 
-        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTopOfPipe;
-        si.setWaitDstStageMask(waitStage);
+        const neuron::render::TimelineWait image_available{frame_info.image_available, 0, vk::PipelineStageFlagBits::eTopOfPipe};
 
-        ctx->main_queue().submit(si, frame_info.in_flight);
+        ctx->main_scheduler()->enqueue({.command_buffers = std::span(&cmd, 1),
+                                        .waits           = std::span(&image_available, 1),
+                                        .signal_binary   = std::span(&frame_info.render_finished, 1),
+                                        .fence           = frame_info.in_flight});
 
         // TODO: rendering. current setup will fail to run
 
@@ -112,12 +193,71 @@ int main() {
         this_frame = glfwGetTime();
         double fps = 1.0 / (this_frame - last_frame);
         best_fps   = std::max(fps, best_fps);
+
+        if (++frame_count > WARM_UP_FRAMES && frame_allocations.delta().allocations() > 0) {
+            allocating_frames++;
+        }
+        frame_allocations.reset();
+    };
+
+    if (use_render_thread) {
+        // GLFW stays on this thread; the render thread gets the extent through the cache and input through the queue
+        display_system->set_extent_provider(window->cached_extent());
+
+        auto events = neuron::os::WindowEventQueue::create();
+        window->forward_events(events);
+
+        uint64_t key_presses = 0;
+
+        auto render_thread = neuron::render::RenderThread::create({
+            .frame =
+                [&] {
+                    neuron::os::WindowEvent event{};
+                    while (events->try_pop(event)) {
+                        if (event.type == neuron::os::WindowEventType::Key && event.action == GLFW_PRESS) {
+                            key_presses++;
+                        }
+                    }
+                    draw_frame();
+                },
+            .finish = [&] { ctx->wait_idle(); },
+        });
+
+        // short timeout: main-thread jobs are pumped here too
+        while (window->is_open() && render_thread->is_running()) {
+            neuron::os::Window::wait_events(0.01);
+            neuron::jobs::JobSystem::global()->pump_main_thread();
+        }
+
+        window->forward_events(nullptr);
+        render_thread->stop();
+
+        std::cout << "Render thread drew " << render_thread->frame_count() << " frames, " << key_presses << " key presses, " << events->dropped_count()
+                  << " events dropped" << std::endl;
+    } else {
+        while (window->is_open()) {
+            neuron::os::Window::poll_events();
+            neuron::jobs::JobSystem::global()->pump_main_thread();
+
+            draw_frame();
+        }
     }
 
 
-    ctx->device().waitIdle();
+    ctx->wait_idle();
+
+    if (dynamic_renderer) {
+        std::cout << "Resolution scale: " << dynamic_renderer->controller().scale() << ", last GPU frame " << dynamic_renderer->last_gpu_frame_ms() << " ms" << std::endl;
+    }
 
-    ctx->free_buffer(buffer);
+    mesh.reset();
+    depth.reset();
+    dynamic_renderer.reset();
 
+    const auto startup = ctx->startup_timings();
+    std::cout << "Context created in " << startup.context_total << " ms, first frame after " << startup.first_frame << " ms" << std::endl;
     std::cout << "Best FPS: " << best_fps << std::endl;
+    if (neuron::debug::heap_tracking_enabled()) {
+        std::cout << "Frames that allocated after warm-up: " << allocating_frames << " of " << frame_count << std::endl;
+    }
 }
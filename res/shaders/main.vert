@@ -7,6 +7,8 @@ layout(location = 1) in vec4 colorIn;
 
 layout (push_constant) uniform constants {
     float time;
+    vec3  position_scale;
+    vec3  position_offset;
 } PushConstants;
 
 void main() {
@@ -14,7 +16,9 @@ void main() {
 
     fragColor = colorIn;
 
-    gl_Position = vec4(positionIn.xyz * (off + 0.5), 1.0);
+    vec3 position = positionIn.xyz * PushConstants.position_scale + PushConstants.position_offset;
+
+    gl_Position = vec4(position * (off + 0.5), 1.0);
 
     if (gl_InstanceIndex == 0) {
         gl_Position.x -= off;
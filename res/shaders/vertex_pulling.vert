@@ -0,0 +1,57 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Fetches QuantizedMesh vertices through a buffer address instead of vertex input bindings.
+// The push constant block matches neuron::render::VertexPullingPushConstants.
+
+layout (buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexWords {
+    uint words[];
+};
+
+layout (push_constant) uniform constants {
+    VertexWords vertices;
+    uint        stride;
+    uint        position_offset;
+    uint        normal_offset;
+    uint        color_offset;
+    vec4        position_scale;
+    vec4        position_bias;
+} PushConstants;
+
+const uint ABSENT_ATTRIBUTE = 0xFFFFFFFFu;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.3, -0.5, 1.0));
+
+layout (location = 0) out vec4 fragColor;
+
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    uint base = uint(gl_VertexIndex) * (PushConstants.stride / 4);
+
+    // R16G16B16A16Snorm
+    uint p        = base + PushConstants.position_offset / 4;
+    vec2 xy       = unpackSnorm2x16(PushConstants.vertices.words[p]);
+    vec2 zw       = unpackSnorm2x16(PushConstants.vertices.words[p + 1]);
+    vec3 position = vec3(xy, zw.x) * PushConstants.position_scale.xyz + PushConstants.position_bias.xyz;
+
+    // R8G8B8A8Unorm
+    fragColor = vec4(1.0);
+    if (PushConstants.color_offset != ABSENT_ATTRIBUTE) {
+        fragColor = unpackUnorm4x8(PushConstants.vertices.words[base + PushConstants.color_offset / 4]);
+    }
+
+    // R16G16Snorm, octahedral
+    if (PushConstants.normal_offset != ABSENT_ATTRIBUTE) {
+        vec3 normal = decode_octahedral(unpackSnorm2x16(PushConstants.vertices.words[base + PushConstants.normal_offset / 4]));
+        fragColor.rgb *= 0.4 + 0.6 * max(dot(normal, LIGHT_DIRECTION), 0.0);
+    }
+
+    gl_Position = vec4(position, 1.0);
+}
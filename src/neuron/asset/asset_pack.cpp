@@ -0,0 +1,200 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <tuple>
+
+namespace neuron::asset {
+    static constexpr uint64_t align_up(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    AssetPack::AssetPack(const std::filesystem::path &path) : m_file(path) {
+        const auto bytes = m_file.data();
+
+        if (bytes.size() < sizeof(AssetPackHeader)) {
+            throw std::runtime_error("Asset pack too small: " + path.string());
+        }
+
+        const auto &header = *reinterpret_cast<const AssetPackHeader *>(bytes.data());
+        if (header.magic != ASSET_PACK_MAGIC) {
+            throw std::runtime_error("Not an asset pack: " + path.string());
+        }
+        if (header.version != ASSET_PACK_VERSION) {
+            throw std::runtime_error("Unsupported asset pack version: " + path.string());
+        }
+        if (header.file_size != bytes.size()) {
+            throw std::runtime_error("Truncated asset pack: " + path.string());
+        }
+
+        const uint64_t entries_end = sizeof(AssetPackHeader) + static_cast<uint64_t>(header.entry_count) * sizeof(AssetPackEntry);
+        // offsets and sizes come from the file, so they are compared by subtraction where a sum could overflow
+        if (entries_end > header.names_offset || header.names_offset > bytes.size() || header.names_size > bytes.size() - header.names_offset) {
+            throw std::runtime_error("Corrupt asset pack table of contents: " + path.string());
+        }
+
+        m_entries = {reinterpret_cast<const AssetPackEntry *>(bytes.data() + sizeof(AssetPackHeader)), header.entry_count};
+        m_names   = {reinterpret_cast<const char *>(bytes.data() + header.names_offset), header.names_size};
+
+        for (const auto &entry : m_entries) {
+            if (entry.offset > bytes.size() || entry.size > bytes.size() - entry.offset || entry.offset % ASSET_PACK_ALIGNMENT != 0 ||
+                static_cast<uint64_t>(entry.name_offset) + entry.name_length > header.names_size) {
+                throw std::runtime_error("Corrupt asset pack entry: " + path.string());
+            }
+        }
+    }
+
+    std::shared_ptr<AssetPack> AssetPack::open(const std::filesystem::path &path) {
+        return std::shared_ptr<AssetPack>(new AssetPack(path));
+    }
+
+    const AssetPackEntry *AssetPack::find(std::string_view name) const {
+        const uint64_t hash = asset_name_hash(name);
+
+        auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash, [](const AssetPackEntry &entry, uint64_t h) { return entry.name_hash < h; });
+        for (; it != m_entries.end() && it->name_hash == hash; ++it) {
+            if (this->name(*it) == name) {
+                return &*it;
+            }
+        }
+
+        return nullptr;
+    }
+
+    const AssetPackEntry &AssetPack::get(std::string_view name) const {
+        const AssetPackEntry *entry = find(name);
+        if (entry == nullptr) {
+            throw std::runtime_error("Asset not found in pack: " + std::string(name));
+        }
+        return *entry;
+    }
+
+    std::span<const std::byte> AssetPack::data(const AssetPackEntry &entry) const {
+        return m_file.data().subspan(entry.offset, entry.size);
+    }
+
+    std::string_view AssetPack::name(const AssetPackEntry &entry) const {
+        return m_names.substr(entry.name_offset, entry.name_length);
+    }
+
+    void AssetPack::prefetch(std::span<const AssetPackEntry *const> entries) const {
+        for (const auto *entry : entries) {
+            m_file.prefetch(entry->offset, entry->size);
+        }
+    }
+
+    VmaAllocated<vk::Buffer> AssetPack::upload_buffer(const std::shared_ptr<Context> &context, const AssetPackEntry &entry, vk::BufferUsageFlags usage) const {
+        return context->allocate_gpu_buffer(entry.size, data(entry).data(), usage);
+    }
+
+    AssetPackWriter &AssetPackWriter::add_file(std::string name, const std::filesystem::path &path, AssetType type, uint32_t flags) {
+        m_sources.push_back(Source{std::move(name), path, type, flags});
+        return *this;
+    }
+
+    AssetPackWriter &AssetPackWriter::add_data(std::string name, std::vector<std::byte> data, AssetType type, uint32_t flags) {
+        m_sources.push_back(Source{std::move(name), std::move(data), type, flags});
+        return *this;
+    }
+
+    void AssetPackWriter::write(const std::filesystem::path &path) const {
+        std::vector<size_t> order(m_sources.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::vector<uint64_t> hashes(m_sources.size());
+        std::vector<uint64_t> sizes(m_sources.size());
+        for (size_t i = 0; i < m_sources.size(); i++) {
+            hashes[i] = asset_name_hash(m_sources[i].name);
+            if (const auto *file = std::get_if<std::filesystem::path>(&m_sources[i].content)) {
+                sizes[i] = std::filesystem::file_size(*file);
+            } else {
+                sizes[i] = std::get<std::vector<std::byte>>(m_sources[i].content).size();
+            }
+        }
+
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return std::tie(hashes[a], m_sources[a].name) < std::tie(hashes[b], m_sources[b].name); });
+
+        for (size_t i = 1; i < order.size(); i++) {
+            if (m_sources[order[i]].name == m_sources[order[i - 1]].name) {
+                throw std::runtime_error("Duplicate asset name: " + m_sources[order[i]].name);
+            }
+        }
+
+        AssetPackHeader header{};
+        header.magic        = ASSET_PACK_MAGIC;
+        header.version      = ASSET_PACK_VERSION;
+        header.entry_count  = static_cast<uint32_t>(m_sources.size());
+        header.names_offset = sizeof(AssetPackHeader) + m_sources.size() * sizeof(AssetPackEntry);
+
+        std::string                 names;
+        std::vector<AssetPackEntry> entries;
+        entries.reserve(m_sources.size());
+        for (size_t i : order) {
+            const Source &source = m_sources[i];
+            entries.push_back(AssetPackEntry{hashes[i], static_cast<uint32_t>(names.size()), static_cast<uint32_t>(source.name.size()), 0, sizes[i], source.type, source.flags});
+            names += source.name;
+        }
+
+        header.names_size  = names.size();
+        header.data_offset = align_up(header.names_offset + header.names_size, ASSET_PACK_ALIGNMENT);
+
+        uint64_t offset = header.data_offset;
+        for (auto &entry : entries) {
+            entry.offset = offset;
+            offset       = align_up(offset + entry.size, ASSET_PACK_ALIGNMENT);
+        }
+        header.file_size = entries.empty() ? header.data_offset : entries.back().offset + entries.back().size;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open asset pack for writing: " + path.string());
+        }
+
+        auto pad_to = [&](uint64_t target) {
+            static constexpr std::array<char, 256> zeros{};
+            auto                                   position = static_cast<uint64_t>(out.tellp());
+            while (position < target) {
+                const auto n = static_cast<std::streamsize>(std::min<uint64_t>(zeros.size(), target - position));
+                out.write(zeros.data(), n);
+                position += n;
+            }
+        };
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AssetPackEntry)));
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+        std::vector<char> chunk(1 << 20);
+        for (size_t e = 0; e < entries.size(); e++) {
+            const Source &source = m_sources[order[e]];
+            pad_to(entries[e].offset);
+
+            if (const auto *file = std::get_if<std::filesystem::path>(&source.content)) {
+                std::ifstream in(*file, std::ios::binary);
+                if (!in.is_open()) {
+                    throw std::runtime_error("Failed to open asset: " + file->string());
+                }
+
+                uint64_t remaining = entries[e].size;
+                while (remaining > 0) {
+                    const auto n = static_cast<std::streamsize>(std::min<uint64_t>(chunk.size(), remaining));
+                    if (!in.read(chunk.data(), n)) {
+                        throw std::runtime_error("Failed to read asset: " + file->string());
+                    }
+                    out.write(chunk.data(), n);
+                    remaining -= n;
+                }
+            } else {
+                const auto &bytes = std::get<std::vector<std::byte>>(source.content);
+                out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            }
+        }
+
+        pad_to(header.file_size);
+
+        if (!out) {
+            throw std::runtime_error("Failed to write asset pack: " + path.string());
+        }
+    }
+} // namespace neuron::asset
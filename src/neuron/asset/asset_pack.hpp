@@ -0,0 +1,118 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "neuron/os/mapped_file.hpp"
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace neuron::asset {
+
+    // On-disk layout, little endian:
+    //   AssetPackHeader
+    //   AssetPackEntry[entry_count], sorted by name_hash
+    //   name table (names are not null terminated)
+    //   blobs, each starting on an ASSET_PACK_ALIGNMENT boundary
+    static constexpr std::array<char, 8> ASSET_PACK_MAGIC     = {'N', 'R', 'N', 'P', 'A', 'C', 'K', '\0'};
+    static constexpr uint32_t            ASSET_PACK_VERSION   = 1;
+    static constexpr uint64_t            ASSET_PACK_ALIGNMENT = 4096;
+
+    enum class AssetType : uint32_t {
+        Blob    = 0,
+        SpirV   = 1,
+        Glsl    = 2,
+        Mesh    = 3,
+        Texture = 4,
+    };
+
+    struct AssetPackHeader {
+        std::array<char, 8> magic;
+        uint32_t            version;
+        uint32_t            entry_count;
+        uint64_t            names_offset;
+        uint64_t            names_size;
+        uint64_t            data_offset;
+        uint64_t            file_size;
+    };
+
+    struct AssetPackEntry {
+        uint64_t  name_hash;
+        uint32_t  name_offset; // relative to names_offset
+        uint32_t  name_length;
+        uint64_t  offset; // absolute, ASSET_PACK_ALIGNMENT aligned
+        uint64_t  size;
+        AssetType type;
+        uint32_t  flags; // free for the asset type to use
+    };
+
+    static_assert(sizeof(AssetPackHeader) == 48);
+    static_assert(sizeof(AssetPackEntry) == 40);
+
+    // 64-bit FNV-1a, stable across platforms so it can be stored in the pack.
+    [[nodiscard]] constexpr uint64_t asset_name_hash(std::string_view name) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Memory-mapped asset pack. Blob spans point straight into the mapping and stay valid for the lifetime of the pack.
+    class NEURON_API AssetPack {
+        explicit AssetPack(const std::filesystem::path &path);
+
+      public:
+        static std::shared_ptr<AssetPack> open(const std::filesystem::path &path);
+
+        [[nodiscard]] const AssetPackEntry *find(std::string_view name) const;
+
+        // Throws if the asset does not exist.
+        [[nodiscard]] const AssetPackEntry &get(std::string_view name) const;
+
+        [[nodiscard]] std::span<const std::byte> data(const AssetPackEntry &entry) const;
+
+        [[nodiscard]] std::string_view name(const AssetPackEntry &entry) const;
+
+        [[nodiscard]] inline std::span<const AssetPackEntry> entries() const { return m_entries; }
+
+        // Asks the OS to page the blobs in ahead of use, e.g. at the start of a loading screen.
+        void prefetch(std::span<const AssetPackEntry *const> entries) const;
+
+        // Copies the blob from the mapping into staging memory and uploads it; the mapping is the only CPU-side copy.
+        [[nodiscard]] VmaAllocated<vk::Buffer> upload_buffer(const std::shared_ptr<Context> &context, const AssetPackEntry &entry, vk::BufferUsageFlags usage) const;
+
+      private:
+        os::MappedFile                  m_file;
+        std::span<const AssetPackEntry> m_entries;
+        std::string_view                m_names;
+    };
+
+    // Builds packs; used by the neuron_asset_packer tool. Files are streamed into the pack at write() time.
+    class NEURON_API AssetPackWriter {
+      public:
+        AssetPackWriter &add_file(std::string name, const std::filesystem::path &path, AssetType type = AssetType::Blob, uint32_t flags = 0);
+        AssetPackWriter &add_data(std::string name, std::vector<std::byte> data, AssetType type = AssetType::Blob, uint32_t flags = 0);
+
+        void write(const std::filesystem::path &path) const;
+
+      private:
+        struct Source {
+            std::string                                                 name;
+            std::variant<std::filesystem::path, std::vector<std::byte>> content;
+            AssetType                                                   type;
+            uint32_t                                                    flags;
+        };
+
+        std::vector<Source> m_sources;
+    };
+
+} // namespace neuron::asset
@@ -15,6 +15,8 @@
 #endif
 
 
+#include <functional>
+
 #include <vulkan/vulkan.hpp>
 
 #define GLFW_INCLUDE_NONE
@@ -32,6 +34,22 @@ namespace neuron {
     concept reference_satisfy = std::is_reference_v<T> && (std::derived_from<std::remove_cvref_t<T>, D> || std::same_as<std::remove_cvref_t<T>, D>);
 
 
+    template <typename T>
+    inline void hash_combine(size_t &seed, const T &v) {
+        seed ^= std::hash<T>{}(v) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+
+    // Raw bits of a vulkan-hpp handle, for keying maps and sorts on both dispatchable and non-dispatchable handles.
+    template <typename H>
+    inline uint64_t handle_bits(H handle) {
+        using C = typename H::CType;
+        if constexpr (std::is_pointer_v<C>) {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<C>(handle)));
+        } else {
+            return static_cast<uint64_t>(static_cast<C>(handle));
+        }
+    }
+
     template <typename T, typename R>
     concept pointer_like = pointer_satisfy<T, R> || requires (T t)
     {
@@ -0,0 +1,148 @@
+#include "allocation_tracker.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace neuron::debug {
+    namespace {
+        // relaxed: the counts are read between frames, not used to order anything
+        std::atomic<uint64_t> g_heap_allocations{0};
+        std::atomic<uint64_t> g_heap_frees{0};
+        std::atomic<uint64_t> g_heap_bytes{0};
+        std::atomic<uint64_t> g_vma_allocations{0};
+        std::atomic<uint64_t> g_vma_frees{0};
+        std::atomic<uint64_t> g_device_memory_allocations{0};
+        std::atomic<uint64_t> g_device_memory_frees{0};
+    } // namespace
+
+    AllocationCounts AllocationCounts::operator-(const AllocationCounts &other) const {
+        return {
+            heap_allocations - other.heap_allocations,
+            heap_frees - other.heap_frees,
+            heap_bytes - other.heap_bytes,
+            vma_allocations - other.vma_allocations,
+            vma_frees - other.vma_frees,
+            device_memory_allocations - other.device_memory_allocations,
+            device_memory_frees - other.device_memory_frees,
+        };
+    }
+
+    bool heap_tracking_enabled() {
+#ifdef NEURON_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    AllocationCounts allocation_counts() {
+        return {
+            g_heap_allocations.load(std::memory_order_relaxed),
+            g_heap_frees.load(std::memory_order_relaxed),
+            g_heap_bytes.load(std::memory_order_relaxed),
+            g_vma_allocations.load(std::memory_order_relaxed),
+            g_vma_frees.load(std::memory_order_relaxed),
+            g_device_memory_allocations.load(std::memory_order_relaxed),
+            g_device_memory_frees.load(std::memory_order_relaxed),
+        };
+    }
+
+    namespace detail {
+        void count_vma_allocation() {
+            g_vma_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_vma_free() {
+            g_vma_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_device_memory_allocation() {
+            g_device_memory_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_device_memory_free() {
+            g_device_memory_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+    } // namespace detail
+
+#ifdef NEURON_TRACK_ALLOCATIONS
+    namespace {
+        void *tracked_allocate(size_t size) noexcept {
+            g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+            g_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+            return std::malloc(size == 0 ? 1 : size);
+        }
+
+        void *tracked_allocate(size_t size, std::align_val_t alignment) noexcept {
+            g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+            g_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+
+            const auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+            return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+            // aligned_alloc wants a non-zero multiple of the alignment
+            return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+        }
+
+        void tracked_free(void *ptr) noexcept {
+            if (ptr) {
+                g_heap_frees.fetch_add(1, std::memory_order_relaxed);
+                std::free(ptr);
+            }
+        }
+
+        void tracked_free(void *ptr, std::align_val_t) noexcept {
+            if (ptr) {
+                g_heap_frees.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+                _aligned_free(ptr);
+#else
+                std::free(ptr);
+#endif
+            }
+        }
+
+        template <typename... A>
+        void *throwing_allocate(A... args) {
+            void *ptr = tracked_allocate(args...);
+            if (!ptr) {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+    } // namespace
+#endif
+} // namespace neuron::debug
+
+#ifdef NEURON_TRACK_ALLOCATIONS
+// Replacements for the global allocation functions. With a shared neuron on Windows these only cover allocations made
+// inside the DLL; everywhere else they replace the process-wide ones.
+using neuron::debug::throwing_allocate;
+using neuron::debug::tracked_allocate;
+using neuron::debug::tracked_free;
+
+void *operator new(size_t size) { return throwing_allocate(size); }
+void *operator new[](size_t size) { return throwing_allocate(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return tracked_allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return tracked_allocate(size); }
+void *operator new(size_t size, std::align_val_t alignment) { return throwing_allocate(size, alignment); }
+void *operator new[](size_t size, std::align_val_t alignment) { return throwing_allocate(size, alignment); }
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return tracked_allocate(size, alignment); }
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return tracked_allocate(size, alignment); }
+
+void operator delete(void *ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr) noexcept { tracked_free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { tracked_free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { tracked_free(ptr); }
+void operator delete(void *ptr, std::align_val_t alignment) noexcept { tracked_free(ptr, alignment); }
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept { tracked_free(ptr, alignment); }
+void operator delete(void *ptr, size_t, std::align_val_t alignment) noexcept { tracked_free(ptr, alignment); }
+void operator delete[](void *ptr, size_t, std::align_val_t alignment) noexcept { tracked_free(ptr, alignment); }
+void operator delete(void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept { tracked_free(ptr, alignment); }
+void operator delete[](void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept { tracked_free(ptr, alignment); }
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "neuron/base.hpp"
+
+#include <cstdint>
+
+namespace neuron::debug {
+
+    // Process-wide totals since startup. Heap counts stay zero unless neuron is built with NEURON_TRACK_ALLOCATIONS,
+    // which replaces the global operator new/delete. VMA counts cover the Context's allocate_*/free_* calls, device
+    // memory counts the vkAllocateMemory calls VMA makes underneath them.
+    struct AllocationCounts {
+        uint64_t heap_allocations          = 0;
+        uint64_t heap_frees                = 0;
+        uint64_t heap_bytes                = 0;
+        uint64_t vma_allocations           = 0;
+        uint64_t vma_frees                 = 0;
+        uint64_t device_memory_allocations = 0;
+        uint64_t device_memory_frees       = 0;
+
+        [[nodiscard]] inline uint64_t allocations() const { return heap_allocations + vma_allocations + device_memory_allocations; }
+
+        [[nodiscard]] AllocationCounts operator-(const AllocationCounts &other) const;
+    };
+
+    [[nodiscard]] NEURON_API bool heap_tracking_enabled();
+
+    [[nodiscard]] NEURON_API AllocationCounts allocation_counts();
+
+    // Counts from construction (or reset()) to delta(), e.g. around one frame. Counts every thread, not just the caller.
+    class NEURON_API AllocationScope {
+      public:
+        inline AllocationScope() : m_begin(allocation_counts()) {}
+
+        inline void reset() { m_begin = allocation_counts(); }
+
+        [[nodiscard]] inline AllocationCounts delta() const { return allocation_counts() - m_begin; }
+
+      private:
+        AllocationCounts m_begin;
+    };
+
+    namespace detail {
+        NEURON_API void count_vma_allocation();
+        NEURON_API void count_vma_free();
+        NEURON_API void count_device_memory_allocation();
+        NEURON_API void count_device_memory_free();
+    } // namespace detail
+
+} // namespace neuron::debug
@@ -0,0 +1,231 @@
+#include "job_system.hpp"
+
+#include <iostream>
+#include <optional>
+#include <utility>
+
+namespace neuron::jobs {
+    // worker index of the current thread in the job system it belongs to, -1 elsewhere
+    static thread_local const JobSystem *t_system = nullptr;
+    static thread_local int32_t          t_worker = -1;
+
+    JobSystem::JobSystem(const JobSystemSettings &settings) : m_main_thread(std::this_thread::get_id()) {
+        uint32_t worker_count = settings.worker_count;
+        if (worker_count == 0) {
+            worker_count = std::max(2U, std::thread::hardware_concurrency()) - 1;
+        }
+
+        for (uint32_t i = 0; i < worker_count; i++) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (uint32_t i = 0; i < worker_count; i++) {
+            m_workers.emplace_back([this, i] { worker_main(i); });
+        }
+    }
+
+    std::shared_ptr<JobSystem> JobSystem::create(const JobSystemSettings &settings) {
+        return std::shared_ptr<JobSystem>(new JobSystem(settings));
+    }
+
+    const std::shared_ptr<JobSystem> &JobSystem::global() {
+        static std::shared_ptr<JobSystem> instance = create();
+        return instance;
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard lock(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (auto &worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void JobSystem::run(JobFn fn, Counter *counter) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        push({std::move(fn), counter});
+    }
+
+    void JobSystem::run_after(Counter &dependency, JobFn fn, Counter *counter) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        {
+            // finish() takes the same lock after the count reaches zero, so the waiter is either seen there or runs now
+            std::lock_guard lock(dependency.m_mutex);
+            if (!dependency.done()) {
+                dependency.m_waiters.push_back({std::move(fn), counter});
+                return;
+            }
+        }
+
+        push({std::move(fn), counter});
+    }
+
+    void JobSystem::run_on_main_thread(JobFn fn, Counter *counter) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        std::lock_guard lock(m_main_mutex);
+        m_main_jobs.push_back({std::move(fn), counter});
+    }
+
+    void JobSystem::wait(Counter &counter) {
+        const int32_t worker  = t_system == this ? t_worker : -1;
+        const bool    on_main = is_main_thread();
+
+        while (!counter.done()) {
+            if (on_main) {
+                pump_main_thread();
+            }
+
+            if (!try_run_one(worker)) {
+                std::this_thread::yield();
+            }
+        }
+
+        // also waits for the job that finished last to leave finish()
+        std::lock_guard lock(counter.m_mutex);
+        if (counter.m_exception) {
+            std::rethrow_exception(std::exchange(counter.m_exception, nullptr));
+        }
+    }
+
+    void JobSystem::pump_main_thread() {
+        // a local list, since main-thread jobs may wait and pump again
+        std::vector<Job> jobs;
+        {
+            std::lock_guard lock(m_main_mutex);
+            jobs.swap(m_main_jobs);
+        }
+
+        for (auto &job : jobs) {
+            execute(job);
+        }
+    }
+
+    bool JobSystem::is_main_thread() const {
+        return std::this_thread::get_id() == m_main_thread;
+    }
+
+    void JobSystem::push(Job job) {
+        const auto queue_count = static_cast<uint32_t>(m_queues.size());
+        const auto index       = t_system == this ? static_cast<uint32_t>(t_worker) : m_next_queue.fetch_add(1, std::memory_order_relaxed) % queue_count;
+
+        {
+            std::lock_guard lock(m_queues[index]->mutex);
+            m_queues[index]->jobs.push_back(std::move(job));
+        }
+
+        m_queued.fetch_add(1, std::memory_order_acq_rel);
+
+        // a worker that just found nothing holds the mutex until it sleeps, so the notify cannot fall in between
+        { std::lock_guard lock(m_sleep_mutex); }
+        m_wake.notify_one();
+    }
+
+    bool JobSystem::try_run_one(int32_t worker) {
+        const auto queue_count = static_cast<uint32_t>(m_queues.size());
+
+        std::optional<Job> job;
+
+        if (worker >= 0) {
+            WorkerQueue    &own = *m_queues[worker];
+            std::lock_guard lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job.emplace(std::move(own.jobs.back()));
+                own.jobs.pop_back();
+            }
+        }
+
+        const uint32_t start = worker >= 0 ? static_cast<uint32_t>(worker) + 1 : m_next_queue.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < queue_count && !job; i++) {
+            WorkerQueue &victim = *m_queues[(start + i) % queue_count];
+
+            std::lock_guard lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job.emplace(std::move(victim.jobs.front()));
+                victim.jobs.pop_front();
+            }
+        }
+
+        if (!job) {
+            return false;
+        }
+
+        m_queued.fetch_sub(1, std::memory_order_acq_rel);
+        execute(*job);
+        return true;
+    }
+
+    void JobSystem::execute(Job &job) {
+        std::exception_ptr exception;
+        try {
+            job.fn();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        // release captures before dependents run
+        job.fn = nullptr;
+        finish(job.counter, exception);
+    }
+
+    void JobSystem::finish(Counter *counter, std::exception_ptr exception) {
+        if (!counter) {
+            if (exception) {
+                try {
+                    std::rethrow_exception(exception);
+                } catch (const std::exception &e) {
+                    std::cerr << "Unhandled exception in job: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Unhandled exception in job" << std::endl;
+                }
+            }
+            return;
+        }
+
+        // under the lock, so a wait() that sees the counter done cannot destroy it while this is still using it
+        std::vector<Counter::Waiter> waiters;
+        {
+            std::lock_guard lock(counter->m_mutex);
+            if (exception && !counter->m_exception) {
+                counter->m_exception = exception;
+            }
+
+            if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                waiters.swap(counter->m_waiters);
+            }
+        }
+
+        for (auto &waiter : waiters) {
+            push({std::move(waiter.fn), waiter.counter});
+        }
+    }
+
+    void JobSystem::worker_main(uint32_t index) {
+        t_system = this;
+        t_worker = static_cast<int32_t>(index);
+
+        while (true) {
+            if (try_run_one(t_worker)) {
+                continue;
+            }
+
+            std::unique_lock lock(m_sleep_mutex);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+            if (m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+} // namespace neuron::jobs
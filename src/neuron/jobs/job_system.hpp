@@ -0,0 +1,150 @@
+#pragma once
+
+#include "neuron/base.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neuron::jobs {
+
+    using JobFn = std::function<void()>;
+
+    // Counts unfinished jobs. Jobs started with a counter increment it and decrement it when they finish; jobs can be
+    // started after a counter reaches zero with run_after(). The first exception thrown by one of its jobs is rethrown by
+    // JobSystem::wait(). Must outlive the jobs that reference it.
+    class NEURON_API Counter {
+      public:
+        Counter() = default;
+
+        Counter(const Counter &other)            = delete;
+        Counter &operator=(const Counter &other) = delete;
+
+        [[nodiscard]] inline bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+      private:
+        friend class JobSystem;
+
+        struct Waiter {
+            JobFn    fn;
+            Counter *counter;
+        };
+
+        std::atomic<uint32_t> m_pending{0};
+        std::mutex            m_mutex;
+        std::vector<Waiter>   m_waiters;
+        std::exception_ptr    m_exception;
+    };
+
+    struct JobSystemSettings {
+        uint32_t worker_count = 0; // 0: one per hardware thread, minus the main thread
+    };
+
+    // Work-stealing job system. Each worker owns a deque: it pushes and pops its own jobs at the back while idle workers
+    // steal from the front of the others. Jobs started from outside the workers are spread round-robin.
+    //
+    // Waiting is cooperative: wait() runs other jobs until the counter is done, so jobs may wait on jobs they started.
+    // Work that must run on the main thread (GLFW) is queued with run_on_main_thread() and runs in pump_main_thread(),
+    // which wait() also calls when invoked from the main thread.
+    class NEURON_API JobSystem {
+        explicit JobSystem(const JobSystemSettings &settings);
+
+      public:
+        static std::shared_ptr<JobSystem> create(const JobSystemSettings &settings = {});
+
+        // Process-wide instance used by the engine's subsystems. The thread that first calls this is the main thread.
+        static const std::shared_ptr<JobSystem> &global();
+
+        ~JobSystem();
+
+        JobSystem(const JobSystem &other)            = delete;
+        JobSystem &operator=(const JobSystem &other) = delete;
+
+        void run(JobFn fn, Counter *counter = nullptr);
+        void run_after(Counter &dependency, JobFn fn, Counter *counter = nullptr);
+        void run_on_main_thread(JobFn fn, Counter *counter = nullptr);
+
+        void wait(Counter &counter);
+
+        // Call regularly on the main thread, e.g. next to Window::poll_events().
+        void pump_main_thread();
+
+        // Calls f(begin, end) on sub-ranges of at least `grain` elements across the workers and the calling thread.
+        // Returns once every sub-range is done; rethrows the first exception thrown by f.
+        template <typename F>
+        void parallel_for(size_t begin, size_t end, size_t grain, const F &f) {
+            const size_t count = end - begin;
+            grain              = std::max<size_t>(grain, 1);
+
+            const size_t chunks = std::min((count + grain - 1) / grain, static_cast<size_t>(worker_count() + 1) * 4);
+            if (chunks <= 1) {
+                if (count > 0) {
+                    f(begin, end);
+                }
+                return;
+            }
+
+            auto chunk_begin = [&](size_t c) { return begin + count * c / chunks; };
+
+            Counter counter;
+            for (size_t c = 1; c < chunks; c++) {
+                run([&f, b = chunk_begin(c), e = chunk_begin(c + 1)] { f(b, e); }, &counter);
+            }
+            // the jobs reference f and counter, so they must finish before this returns, even when the caller's chunk throws;
+            // its exception wins over one from a job, which wait() rethrows otherwise
+            try {
+                f(chunk_begin(0), chunk_begin(1));
+            } catch (...) {
+                try {
+                    wait(counter);
+                } catch (...) {}
+                throw;
+            }
+            wait(counter);
+        }
+
+        [[nodiscard]] inline uint32_t worker_count() const { return static_cast<uint32_t>(m_workers.size()); }
+
+        [[nodiscard]] bool is_main_thread() const;
+
+      private:
+        struct Job {
+            JobFn    fn;
+            Counter *counter;
+        };
+
+        struct WorkerQueue {
+            std::mutex      mutex;
+            std::deque<Job> jobs;
+        };
+
+        void push(Job job);
+        bool try_run_one(int32_t worker);
+        void execute(Job &job);
+        void finish(Counter *counter, std::exception_ptr exception);
+        void worker_main(uint32_t index);
+
+        std::thread::id                           m_main_thread;
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread>                  m_workers;
+        std::atomic<uint32_t>                     m_next_queue{0};
+
+        // jobs sitting in a queue; workers sleep while this is zero
+        std::atomic<int64_t>    m_queued{0};
+        std::mutex              m_sleep_mutex;
+        std::condition_variable m_wake;
+        bool                    m_stop = false;
+
+        std::mutex       m_main_mutex;
+        std::vector<Job> m_main_jobs;
+    };
+
+} // namespace neuron::jobs
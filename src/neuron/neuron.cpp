@@ -2,10 +2,18 @@
 
 #include "neuron.hpp"
 
+#include "debug/allocation_tracker.hpp"
+#include "jobs/job_system.hpp"
+#include "render/pipeline_layout.hpp"
+#include "render/submission_scheduler.hpp"
+#include "render/texture_uploader.hpp"
+
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>  // Required for enable_shared_from_this
+#include <string_view>
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE;
 
@@ -41,7 +49,20 @@ namespace neuron {
         return VK_FALSE;
     }
 
-    Context::Context(const ContextSettings &settings) : m_optional_features(settings.optional_features) {
+    static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    static void VKAPI_PTR count_device_memory_allocation(VmaAllocator, uint32_t, VkDeviceMemory, VkDeviceSize, void *) {
+        debug::detail::count_device_memory_allocation();
+    }
+
+    static void VKAPI_PTR count_device_memory_free(VmaAllocator, uint32_t, VkDeviceMemory, VkDeviceSize, void *) {
+        debug::detail::count_device_memory_free();
+    }
+
+    Context::Context(const ContextSettings &settings)
+        : m_optional_features(settings.optional_features), m_warm_up(settings.warm_up), m_startup_begin(Clock::now()) {
         glfwInit();
 
         // Check if Vulkan is supported by GLFW
@@ -89,12 +110,17 @@ namespace neuron {
         // Enumerate available instance extensions
         auto available_extensions = vk::enumerateInstanceExtensionProperties();
         std::unordered_set<std::string> available_extension_names;
-        std::cout << "Available instance extensions:" << std::endl;
         for (const auto &ext : available_extensions) {
-            std::cout << "\t" << ext.extensionName << std::endl;
             available_extension_names.insert(ext.extensionName);
         }
 
+        if (settings.print_diagnostics) {
+            std::cout << "Available instance extensions:" << std::endl;
+            for (const auto &ext : available_extensions) {
+                std::cout << "\t" << ext.extensionName << std::endl;
+            }
+        }
+
         // Check that all requested extensions are available
         for (const auto &requested_ext : instance_extensions_set) {
             if (available_extension_names.find(requested_ext) == available_extension_names.end()) {
@@ -106,12 +132,17 @@ namespace neuron {
         // Enumerate available instance layers
         auto available_layers = vk::enumerateInstanceLayerProperties();
         std::unordered_set<std::string> available_layer_names;
-        std::cout << "Available instance layers:" << std::endl;
         for (const auto &layer : available_layers) {
-            std::cout << "\t" << layer.layerName << std::endl;
             available_layer_names.insert(layer.layerName);
         }
 
+        if (settings.print_diagnostics) {
+            std::cout << "Available instance layers:" << std::endl;
+            for (const auto &layer : available_layers) {
+                std::cout << "\t" << layer.layerName << std::endl;
+            }
+        }
+
         // Check that all requested layers are available
         for (const auto &requested_layer : layers_set) {
             if (available_layer_names.find(requested_layer) == available_layer_names.end()) {
@@ -166,6 +197,9 @@ namespace neuron {
             m_debug_messenger = m_instance.createDebugUtilsMessengerEXT(messenger_create_info);
         }
 
+        m_startup_timings.instance = elapsed_ms(m_startup_begin);
+        Clock::time_point phase    = Clock::now();
+
         std::vector<vk::PhysicalDevice> physical_devices = m_instance.enumeratePhysicalDevices();
 
         switch (settings.device_selection_strategy) {
@@ -210,8 +244,13 @@ namespace neuron {
             throw std::runtime_error("Failed to select a valid physical device.");
         }
 
-        vk::PhysicalDeviceProperties properties = m_physical_device.getProperties();
-        std::cout << "Selected GPU: " << properties.deviceName << '\n';
+        m_physical_device_properties = m_physical_device.getProperties();
+        if (settings.print_diagnostics) {
+            std::cout << "Selected GPU: " << m_physical_device_properties.deviceName << '\n';
+        }
+
+        m_startup_timings.device_selection = elapsed_ms(phase);
+        phase                              = Clock::now();
 
         std::optional<uint32_t> mqf;
         std::optional<uint32_t> tqf;
@@ -255,12 +294,129 @@ namespace neuron {
         device_extensions_set.insert(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
         //device_extensions_set.insert(VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME);
 
-        std::vector<const char *> device_extensions;
-        for (const auto &extension : device_extensions_set) {
-            device_extensions.push_back(extension.c_str());
+        const auto available_device_extensions = m_physical_device.enumerateDeviceExtensionProperties();
+        auto       has_device_extension        = [&](std::string_view name) {
+            return std::ranges::any_of(available_device_extensions, [&](const vk::ExtensionProperties &p) { return std::string_view(p.extensionName.data()) == name; });
+        };
+
+        const OptionalFeatureSet &requested = m_optional_features;
+
+        // Preferred features are enabled when supported, required ones fail device creation when they are not
+        auto negotiate = [](FeatureRequest request, bool supported, const char *name) {
+            if (request == FeatureRequest::Required && !supported) {
+                throw std::runtime_error(std::string("Required device feature not supported: ") + name);
+            }
+            return request != FeatureRequest::Disabled && supported;
+        };
+
+        // Extension feature structs are only chained when the extension is there
+        auto link = [](void **&tail, auto &s) {
+            *tail = &s;
+            tail  = &s.pNext;
+        };
+
+        const bool has_synchronization2      = has_device_extension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        const bool has_extended_dyn_state    = has_device_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+        const bool has_extended_dyn_state2   = has_device_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+        const bool has_extended_dyn_state3   = has_device_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+        const bool has_vertex_input_dyn      = has_device_extension(VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME);
+        const bool has_pipeline_library      = has_device_extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && has_device_extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        const bool has_cache_control         = has_device_extension(VK_EXT_PIPELINE_CREATION_CACHE_CONTROL_EXTENSION_NAME);
+        const bool has_subgroup_size_control = has_device_extension(VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME);
+
+        vk::PhysicalDeviceFeatures2                               supported_f2{};
+        vk::PhysicalDeviceVulkan11Features                        supported_v11{};
+        vk::PhysicalDeviceVulkan12Features                        supported_v12{};
+        vk::PhysicalDeviceSynchronization2FeaturesKHR             supported_synchronization2{};
+        vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT         supported_extended_dynamic_state{};
+        vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT        supported_extended_dynamic_state2{};
+        vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT        supported_extended_dynamic_state3{};
+        vk::PhysicalDeviceVertexInputDynamicStateFeaturesEXT      supported_vertex_input_dynamic_state{};
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT      supported_pipeline_library{};
+        vk::PhysicalDevicePipelineCreationCacheControlFeaturesEXT supported_cache_control{};
+        vk::PhysicalDeviceSubgroupSizeControlFeaturesEXT          supported_subgroup_size_control{};
+
+        void **query_tail = &supported_f2.pNext;
+        link(query_tail, supported_v11);
+        link(query_tail, supported_v12);
+        if (has_synchronization2) {
+            link(query_tail, supported_synchronization2);
+        }
+        if (has_extended_dyn_state) {
+            link(query_tail, supported_extended_dynamic_state);
+        }
+        if (has_extended_dyn_state2) {
+            link(query_tail, supported_extended_dynamic_state2);
+        }
+        if (has_extended_dyn_state3) {
+            link(query_tail, supported_extended_dynamic_state3);
+        }
+        if (has_vertex_input_dyn) {
+            link(query_tail, supported_vertex_input_dynamic_state);
+        }
+        if (has_pipeline_library) {
+            link(query_tail, supported_pipeline_library);
+        }
+        if (has_cache_control) {
+            link(query_tail, supported_cache_control);
+        }
+        if (has_subgroup_size_control) {
+            link(query_tail, supported_subgroup_size_control);
+        }
+        m_physical_device.getFeatures2(&supported_f2);
+
+        const vk::PhysicalDeviceFeatures &supported = supported_f2.features;
+
+        // Descriptor indexing (bindless). Only enabled as a whole, partial support is treated as no support.
+        m_enabled_features.descriptor_indexing = negotiate(requested.descriptor_indexing,
+                                                           supported_v12.descriptorIndexing && supported_v12.runtimeDescriptorArray && supported_v12.descriptorBindingPartiallyBound &&
+                                                               supported_v12.descriptorBindingSampledImageUpdateAfterBind && supported_v12.descriptorBindingStorageBufferUpdateAfterBind &&
+                                                               supported_v12.shaderSampledImageArrayNonUniformIndexing && supported_v12.shaderStorageBufferArrayNonUniformIndexing,
+                                                           "descriptor indexing");
+        m_enabled_features.buffer_device_address = negotiate(requested.buffer_device_address, supported_v12.bufferDeviceAddress, "buffer device address");
+        m_enabled_features.synchronization2      = negotiate(requested.synchronization2, has_synchronization2 && supported_synchronization2.synchronization2, "synchronization2");
+        m_enabled_features.extended_dynamic_state =
+            negotiate(requested.extended_dynamic_state, has_extended_dyn_state && supported_extended_dynamic_state.extendedDynamicState, "extended dynamic state");
+        m_enabled_features.extended_dynamic_state2 =
+            negotiate(requested.extended_dynamic_state2, has_extended_dyn_state2 && supported_extended_dynamic_state2.extendedDynamicState2, "extended dynamic state 2");
+        // Only the states DynamicStateTracker sets, as a whole; the multisample and rarer raster states stay baked.
+        const auto &eds3 = supported_extended_dynamic_state3;
+        m_enabled_features.extended_dynamic_state3 =
+            negotiate(requested.extended_dynamic_state3,
+                      has_extended_dyn_state3 && eds3.extendedDynamicState3PolygonMode && eds3.extendedDynamicState3DepthClampEnable && eds3.extendedDynamicState3LogicOpEnable &&
+                          eds3.extendedDynamicState3ColorBlendEnable && eds3.extendedDynamicState3ColorBlendEquation && eds3.extendedDynamicState3ColorWriteMask,
+                      "extended dynamic state 3");
+        m_enabled_features.vertex_input_dynamic_state =
+            negotiate(requested.vertex_input_dynamic_state, has_vertex_input_dyn && supported_vertex_input_dynamic_state.vertexInputDynamicState, "vertex input dynamic state");
+        m_enabled_features.graphics_pipeline_library =
+            negotiate(requested.graphics_pipeline_library, has_pipeline_library && supported_pipeline_library.graphicsPipelineLibrary, "graphics pipeline library");
+        if (m_enabled_features.graphics_pipeline_library) {
+            vk::PhysicalDeviceProperties2                          properties{};
+            vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT pipeline_library_properties{};
+            properties.pNext = &pipeline_library_properties;
+            m_physical_device.getProperties2(&properties);
+
+            m_enabled_features.graphics_pipeline_fast_linking = pipeline_library_properties.graphicsPipelineLibraryFastLinking;
+        }
+        // Real per-heap budgets for VMA (used by the streaming manager), otherwise VMA estimates from heap sizes
+        m_enabled_features.memory_budget = negotiate(requested.memory_budget, has_device_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME), "memory budget");
+        m_enabled_features.pipeline_creation_cache_control =
+            negotiate(requested.pipeline_creation_cache_control, has_cache_control && supported_cache_control.pipelineCreationCacheControl, "pipeline creation cache control");
+        m_enabled_features.storage_8bit  = negotiate(requested.storage_8bit, supported_v12.storageBuffer8BitAccess && supported_v12.shaderInt8, "8-bit storage");
+        m_enabled_features.storage_16bit = negotiate(requested.storage_16bit, supported_v11.storageBuffer16BitAccess && supported.shaderInt16, "16-bit storage");
+        m_enabled_features.subgroup_size_control =
+            negotiate(requested.subgroup_size_control, has_subgroup_size_control && supported_subgroup_size_control.subgroupSizeControl, "subgroup size control");
+        // GPU-driven rendering: multi-draw indirect with a GPU-written draw count, gl_DrawID in shaders
+        m_enabled_features.multi_draw_indirect = negotiate(requested.multi_draw, supported.multiDrawIndirect && supported_v11.shaderDrawParameters, "multi-draw indirect");
+        m_enabled_features.draw_indirect_count = m_enabled_features.multi_draw_indirect && supported_v12.drawIndirectCount;
+        // Attachments that are neither loaded nor stored (read-only depth, untouched color), see RenderPassDescription
+        m_enabled_features.load_store_op_none = negotiate(requested.load_store_op_none, has_device_extension(VK_EXT_LOAD_STORE_OP_NONE_EXTENSION_NAME), "load/store op none");
+
+        if (!m_enabled_features.descriptor_indexing && settings.print_diagnostics) {
+            std::cout << "Descriptor indexing not enabled on this device, bindless resources unavailable." << std::endl;
         }
 
-        vk::PhysicalDeviceFeatures2 f2{};
+        vk::PhysicalDeviceFeatures2        f2{};
         vk::PhysicalDeviceVulkan11Features v11f{};
         vk::PhysicalDeviceVulkan12Features v12f{};
         // Downgrading to v12 temporarily :(
@@ -274,34 +430,123 @@ namespace neuron {
         vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
         dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
 
+        vk::PhysicalDeviceSynchronization2FeaturesKHR             synchronization2Features{VK_TRUE};
+        vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT         extendedDynamicStateFeatures{VK_TRUE};
+        vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT        extendedDynamicState2Features{VK_TRUE};
+        vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT        extendedDynamicState3Features{};
+        vk::PhysicalDeviceVertexInputDynamicStateFeaturesEXT      vertexInputDynamicStateFeatures{VK_TRUE};
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT      pipelineLibraryFeatures{VK_TRUE};
+        vk::PhysicalDevicePipelineCreationCacheControlFeaturesEXT cacheControlFeatures{VK_TRUE};
+        vk::PhysicalDeviceSubgroupSizeControlFeaturesEXT          subgroupSizeControlFeatures{VK_TRUE, supported_subgroup_size_control.computeFullSubgroups};
+
         // Add to the pNext chain
-        f2.pNext = &v11f;
-        v11f.pNext = &v12f;
-        v12f.pNext = &dynamicRenderingFeatures;
-        dynamicRenderingFeatures.pNext = nullptr; // End of pNext chain
-        //v12f.pNext = &portabilitySubsetFeatures;
-        //portabilitySubsetFeatures.pNext = nullptr; // End of pNext chain
+        void **tail = &f2.pNext;
+        link(tail, v11f);
+        link(tail, v12f);
+        link(tail, dynamicRenderingFeatures);
+        //link(tail, portabilitySubsetFeatures);
+
+        if (m_enabled_features.synchronization2) {
+            device_extensions_set.insert(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+            link(tail, synchronization2Features);
+        }
+        if (m_enabled_features.extended_dynamic_state) {
+            device_extensions_set.insert(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+            link(tail, extendedDynamicStateFeatures);
+        }
+        if (m_enabled_features.extended_dynamic_state2) {
+            device_extensions_set.insert(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+            link(tail, extendedDynamicState2Features);
+        }
+        if (m_enabled_features.extended_dynamic_state3) {
+            extendedDynamicState3Features.extendedDynamicState3PolygonMode        = true;
+            extendedDynamicState3Features.extendedDynamicState3DepthClampEnable   = true;
+            extendedDynamicState3Features.extendedDynamicState3LogicOpEnable      = true;
+            extendedDynamicState3Features.extendedDynamicState3ColorBlendEnable   = true;
+            extendedDynamicState3Features.extendedDynamicState3ColorBlendEquation = true;
+            extendedDynamicState3Features.extendedDynamicState3ColorWriteMask     = true;
+
+            device_extensions_set.insert(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+            link(tail, extendedDynamicState3Features);
+        }
+        if (m_enabled_features.vertex_input_dynamic_state) {
+            device_extensions_set.insert(VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME);
+            link(tail, vertexInputDynamicStateFeatures);
+        }
+        if (m_enabled_features.graphics_pipeline_library) {
+            device_extensions_set.insert(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            device_extensions_set.insert(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            link(tail, pipelineLibraryFeatures);
+        }
+        if (m_enabled_features.pipeline_creation_cache_control) {
+            device_extensions_set.insert(VK_EXT_PIPELINE_CREATION_CACHE_CONTROL_EXTENSION_NAME);
+            link(tail, cacheControlFeatures);
+        }
+        if (m_enabled_features.subgroup_size_control) {
+            device_extensions_set.insert(VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME);
+            link(tail, subgroupSizeControlFeatures);
+        }
+        if (m_enabled_features.memory_budget) {
+            device_extensions_set.insert(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+        if (m_enabled_features.load_store_op_none) {
+            device_extensions_set.insert(VK_EXT_LOAD_STORE_OP_NONE_EXTENSION_NAME);
+        }
+
+        std::vector<const char *> device_extensions;
+        for (const auto &extension : device_extensions_set) {
+            device_extensions.push_back(extension.c_str());
+        }
 
         v12f.timelineSemaphore = true;
 
-        // Adjust features based on what's supported
-        vk::PhysicalDeviceFeatures2 supportedFeatures = m_physical_device.getFeatures2();
+        if (m_enabled_features.descriptor_indexing) {
+            v12f.descriptorIndexing                            = true;
+            v12f.runtimeDescriptorArray                        = true;
+            v12f.descriptorBindingPartiallyBound               = true;
+            v12f.descriptorBindingSampledImageUpdateAfterBind  = true;
+            v12f.descriptorBindingStorageBufferUpdateAfterBind = true;
+            v12f.shaderSampledImageArrayNonUniformIndexing     = true;
+            v12f.shaderStorageBufferArrayNonUniformIndexing    = true;
+            v12f.descriptorBindingUpdateUnusedWhilePending     = supported_v12.descriptorBindingUpdateUnusedWhilePending;
+            v12f.descriptorBindingVariableDescriptorCount      = supported_v12.descriptorBindingVariableDescriptorCount;
+        }
 
-        if (supportedFeatures.features.geometryShader) {
+        v12f.bufferDeviceAddress = m_enabled_features.buffer_device_address;
+
+        if (m_enabled_features.storage_8bit) {
+            v12f.storageBuffer8BitAccess           = true;
+            v12f.uniformAndStorageBuffer8BitAccess = supported_v12.uniformAndStorageBuffer8BitAccess;
+            v12f.storagePushConstant8              = supported_v12.storagePushConstant8;
+            v12f.shaderInt8                        = true;
+        }
+        if (m_enabled_features.storage_16bit) {
+            v11f.storageBuffer16BitAccess           = true;
+            v11f.uniformAndStorageBuffer16BitAccess = supported_v11.uniformAndStorageBuffer16BitAccess;
+            v11f.storagePushConstant16              = supported_v11.storagePushConstant16;
+            f2.features.shaderInt16                 = true;
+            v12f.shaderFloat16                      = supported_v12.shaderFloat16;
+        }
+
+        f2.features.multiDrawIndirect = m_enabled_features.multi_draw_indirect;
+        v11f.shaderDrawParameters     = m_enabled_features.multi_draw_indirect;
+        v12f.drawIndirectCount        = m_enabled_features.draw_indirect_count;
+
+        if (supported.geometryShader) {
             f2.features.geometryShader = true;
         }
-        if (supportedFeatures.features.tessellationShader) {
+        if (supported.tessellationShader) {
             f2.features.tessellationShader = true;
         }
-        if (supportedFeatures.features.imageCubeArray) {
+        if (supported.imageCubeArray) {
             f2.features.imageCubeArray = true;
         }
-        if (supportedFeatures.features.wideLines) {
+        if (supported.wideLines) {
             f2.features.wideLines = true;
         } else {
             std::cout << "Wide lines not supported on this device." << std::endl;
         }
-        if (supportedFeatures.features.largePoints) {
+        if (supported.largePoints) {
             f2.features.largePoints = true;
         } else {
             std::cout << "Large points not supported on this device." << std::endl;
@@ -322,39 +567,67 @@ namespace neuron {
         m_transfer_queue = m_device.getQueue(m_transfer_queue_family, 0);
         m_compute_queue  = m_device.getQueue(m_compute_queue_family, 0);
 
+        m_startup_timings.device = elapsed_ms(phase);
+        phase                    = Clock::now();
 
-        // setup pipeline cache
-
-        // TODO: use actual cache dir (do this when updating to use proper application folders)
-        void  *pc_init_data      = nullptr;
-        size_t pc_init_data_size = 0;
-        if (std::filesystem::exists("pipeline_cache")) {
-            std::ifstream f("pipeline_cache", std::ios::ate | std::ios::binary);
-            pc_init_data_size = f.tellg();
-            pc_init_data      = malloc(pc_init_data_size);
-            f.seekg(0);
-            f.read(static_cast<char *>(pc_init_data), pc_init_data_size);
-            f.close();
+        if (settings.fast_start) {
+            // nothing below needs the cache; the destructor and pipeline_cache() wait for it
+            m_pipeline_cache_ready = std::make_unique<jobs::Counter>();
+            jobs::JobSystem::global()->run([this] { load_pipeline_cache(); }, m_pipeline_cache_ready.get());
+        } else {
+            load_pipeline_cache();
+            phase = Clock::now();
         }
 
-        m_pipeline_cache = m_device.createPipelineCache({{}, pc_init_data_size, pc_init_data});
-
-        if (pc_init_data) {
-            free(pc_init_data);
+        VmaAllocatorCreateInfo aci{};
+        aci.device           = m_device;
+        aci.instance         = m_instance;
+        aci.physicalDevice   = m_physical_device;
+        aci.vulkanApiVersion = VK_API_VERSION_1_2;
+        if (m_enabled_features.memory_budget) {
+            aci.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        }
+        if (m_enabled_features.buffer_device_address) {
+            aci.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
         }
 
-        VmaAllocatorCreateInfo aci{};
-        aci.device         = m_device;
-        aci.instance       = m_instance;
-        aci.physicalDevice = m_physical_device;
+        // VMA copies the callbacks
+        VmaDeviceMemoryCallbacks memory_callbacks{count_device_memory_allocation, count_device_memory_free, nullptr};
+        aci.pDeviceMemoryCallbacks = &memory_callbacks;
 
         vmaCreateAllocator(&aci, &m_allocator);
+
+        // Resizable BAR exposes the whole VRAM heap as host-visible; integrated and CPU devices have no separate VRAM at all.
+        // Without either, the only host-visible device-local memory is the small 256 MiB BAR window, which is left alone.
+        const auto memory_properties = m_physical_device.getMemoryProperties();
+        const auto device_type       = m_physical_device_properties.deviceType;
+        const bool unified_memory    = device_type == vk::PhysicalDeviceType::eIntegratedGpu || device_type == vk::PhysicalDeviceType::eCpu;
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+            const auto &type = memory_properties.memoryTypes[i];
+            if ((type.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal) && (type.propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) &&
+                (unified_memory || memory_properties.memoryHeaps[type.heapIndex].size > 256ULL * 1024 * 1024)) {
+                m_host_visible_device_memory = true;
+            }
+        }
+
+        m_startup_timings.allocator = elapsed_ms(phase);
     }
 
     Context::~Context() {
-        m_main_pool.reset();
+        m_main_scheduler.reset();
+        m_transfer_scheduler.reset();
+        m_compute_scheduler.reset();
         m_transfer_pool.reset();
-        m_compute_pool.reset();
+        m_pipeline_layout_cache.reset();
+        m_descriptor_set_layout_cache.reset();
+
+        if (m_pipeline_cache_ready) {
+            try {
+                jobs::JobSystem::global()->wait(*m_pipeline_cache_ready);
+            } catch (const std::exception &e) {
+                std::cerr << "Failed to load pipeline cache: " << e.what() << std::endl;
+            }
+        }
 
         if (m_instance) {
             if (m_device)
@@ -363,14 +636,7 @@ namespace neuron {
                 }
 
             if (m_pipeline_cache) {
-                auto data = m_device.getPipelineCacheData(m_pipeline_cache);
-                {
-                    std::ofstream f("pipeline_cache", std::ios::binary | std::ios::out);
-                    f.write(reinterpret_cast<const char *>(data.data()), data.size());
-
-                    f.close();
-                }
-
+                save_pipeline_cache();
                 m_device.destroy(m_pipeline_cache);
             }
 
@@ -427,6 +693,9 @@ namespace neuron {
     }
 
     vk::PipelineCache Context::pipeline_cache() const {
+        if (m_pipeline_cache_ready && !m_pipeline_cache_ready->done()) {
+            jobs::JobSystem::global()->wait(*m_pipeline_cache_ready);
+        }
         return m_pipeline_cache;
     }
 
@@ -434,6 +703,87 @@ namespace neuron {
         return m_allocator;
     }
 
+    bool Context::descriptor_indexing_enabled() const {
+        return m_enabled_features.descriptor_indexing;
+    }
+
+    bool Context::draw_indirect_count_enabled() const {
+        return m_enabled_features.draw_indirect_count;
+    }
+
+    bool Context::memory_budget_enabled() const {
+        return m_enabled_features.memory_budget;
+    }
+
+    bool Context::host_visible_device_memory() const {
+        return m_host_visible_device_memory;
+    }
+
+    bool Context::synchronization2_enabled() const {
+        return m_enabled_features.synchronization2;
+    }
+
+    const EnabledFeatureSet &Context::enabled_features() const {
+        return m_enabled_features;
+    }
+
+    const vk::PhysicalDeviceProperties &Context::physical_device_properties() const {
+        return m_physical_device_properties;
+    }
+
+    const std::shared_ptr<render::DescriptorSetLayoutCache> &Context::descriptor_set_layout_cache() const {
+        return m_descriptor_set_layout_cache;
+    }
+
+    const std::shared_ptr<render::PipelineLayoutCache> &Context::pipeline_layout_cache() const {
+        return m_pipeline_layout_cache;
+    }
+
+    const std::shared_ptr<render::SubmissionScheduler> &Context::main_scheduler() const {
+        return m_main_scheduler;
+    }
+
+    const std::shared_ptr<render::SubmissionScheduler> &Context::transfer_scheduler() const {
+        return m_transfer_scheduler;
+    }
+
+    const std::shared_ptr<render::SubmissionScheduler> &Context::compute_scheduler() const {
+        return m_compute_scheduler;
+    }
+
+    void Context::wait_idle() const {
+        m_main_scheduler->wait_idle();
+        if (m_transfer_scheduler != m_main_scheduler) {
+            m_transfer_scheduler->wait_idle();
+        }
+        if (m_compute_scheduler != m_main_scheduler) {
+            m_compute_scheduler->wait_idle();
+        }
+    }
+
+    void Context::wait_for_warm_up() const {
+        if (m_warm_up_done.valid()) {
+            m_warm_up_done.get();
+        }
+    }
+
+    StartupTimings Context::startup_timings() const {
+        auto _ = pipeline_cache();
+
+        StartupTimings timings = m_startup_timings;
+        timings.first_frame    = m_first_frame.load(std::memory_order_relaxed);
+        return timings;
+    }
+
+    void Context::mark_first_frame() {
+        if (m_first_frame.load(std::memory_order_relaxed) != 0.0) {
+            return;
+        }
+
+        double expected = 0.0;
+        m_first_frame.compare_exchange_strong(expected, elapsed_ms(m_startup_begin), std::memory_order_relaxed);
+    }
+
     VmaAllocated<vk::Image> Context::allocate_image(const vk::ImageCreateInfo &ici, const VmaAllocationCreateInfo &allocation_create_info) const {
         VmaAllocated<vk::Image> res;
 
@@ -442,6 +792,7 @@ namespace neuron {
         VkImageCreateInfo ici_ = ici;
         vmaCreateImage(m_allocator, &ici_, &allocation_create_info, &img, &res.allocation, &res.allocation_info);
         res.resource = img;
+        debug::detail::count_vma_allocation();
 
         return res;
     }
@@ -455,24 +806,38 @@ namespace neuron {
 
         vmaCreateBuffer(m_allocator, &bci_, &allocation_create_info, &buf, &res.allocation, &res.allocation_info);
         res.resource = buf;
+        debug::detail::count_vma_allocation();
 
         return res;
     }
 
     void Context::free_image(const VmaAllocated<vk::Image> &image) const {
         vmaDestroyImage(m_allocator, image.resource, image.allocation);
+        debug::detail::count_vma_free();
     }
 
     void Context::free_buffer(const VmaAllocated<vk::Buffer> &buffer) const {
         vmaDestroyBuffer(m_allocator, buffer.resource, buffer.allocation);
+        debug::detail::count_vma_free();
     }
 
     VmaAllocated<vk::Buffer> Context::allocate_gpu_buffer(size_t size, const void *data, vk::BufferUsageFlags usage) const {
-        auto buf = allocate_buffer(vk::BufferCreateInfo{{}, size, usage | vk::BufferUsageFlagBits::eTransferDst}, VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+        VmaAllocationCreateInfo allocation_create_info{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE};
+        if (data && m_host_visible_device_memory) {
+            // VMA may still pick a memory type that is not host-visible, in which case the staging path below runs
+            allocation_create_info.flags =
+                VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        }
 
-        if (data) {
+        auto buf = allocate_buffer(vk::BufferCreateInfo{{}, size, usage | vk::BufferUsageFlagBits::eTransferDst}, allocation_create_info);
+
+        if (data && buf.allocation_info.pMappedData) {
+            std::memcpy(buf.allocation_info.pMappedData, data, size);
+            vmaFlushAllocation(m_allocator, buf.allocation, 0, VK_WHOLE_SIZE);
+        } else if (data) {
             auto stage = allocate_staging_buffer(size, data, {});
             copy_buffer_to_buffer(stage, buf, size, 0, 0);
+            free_buffer(stage);
         }
 
         return buf;
@@ -502,6 +867,13 @@ namespace neuron {
         return buf;
     }
 
+    vk::DeviceAddress Context::buffer_device_address(const VmaAllocated<vk::Buffer> &buffer) const {
+        if (!m_enabled_features.buffer_device_address) {
+            throw std::runtime_error("Buffer device address is not enabled on this device");
+        }
+        return m_device.getBufferAddress(vk::BufferDeviceAddressInfo{buffer.resource});
+    }
+
     void *Context::map_buffer(const VmaAllocated<vk::Buffer> &buffer) const {
         void *p;
         vmaMapMemory(m_allocator, buffer.allocation, &p);
@@ -514,8 +886,12 @@ namespace neuron {
 
     void Context::copy_buffer_to_buffer(const VmaAllocated<vk::Buffer> &src, const VmaAllocated<vk::Buffer> &dst, vk::DeviceSize size, vk::DeviceSize src_offset,
                                         vk::DeviceSize dst_offset) const {
-        vk::Fence         fence = m_device.createFence({});
-        vk::CommandBuffer cmd   = m_transfer_pool->allocate_command_buffer();
+        vk::CommandBuffer cmd;
+        {
+            // command pools are not thread-safe either
+            std::lock_guard lock(m_transfer_pool_mutex);
+            cmd = transfer_pool()->allocate_command_buffer();
+        }
 
         vk::BufferCopy copy{src_offset, dst_offset, size};
 
@@ -523,19 +899,89 @@ namespace neuron {
         cmd.copyBuffer(src.resource, dst.resource, copy);
         cmd.end();
 
-        vk::SubmitInfo si{};
-        si.setCommandBuffers(cmd);
-        m_transfer_queue.submit(si, fence);
-        auto _ = m_device.waitForFences(fence, true, UINT64_MAX);
+        m_transfer_scheduler->wait(m_transfer_scheduler->submit({.command_buffers = std::span(&cmd, 1)}));
 
+        std::lock_guard lock(m_transfer_pool_mutex);
         m_transfer_pool->free_command_buffers({cmd});
-        m_device.destroy(fence);
+    }
+
+    VmaAllocated<vk::Image> Context::allocate_gpu_image(const void *data, const vk::Extent2D &extent, vk::Format format) const {
+        auto uploader = render::TextureUploader::create(std::const_pointer_cast<Context>(shared_from_this()),
+                                                        {.staging_size = std::max<vk::DeviceSize>(render::texture_level_size(format, extent, 0), 4)});
+
+        auto image = uploader->enqueue(render::TextureUploadInfo{.data = data, .extent = extent, .format = format});
+        uploader->flush();
+        uploader->wait();
+        return image;
     }
 
     void Context::setup(const std::shared_ptr<Context> &me) {
-        m_main_pool = std::make_shared<CommandPool>(me, m_main_queue_family);
-        m_transfer_pool = std::make_shared<CommandPool>(me, m_transfer_queue_family);
-        m_compute_pool = std::make_shared<CommandPool>(me, m_compute_queue_family);
+        const Clock::time_point begin = Clock::now();
+
+        m_main_scheduler     = render::SubmissionScheduler::create(me, m_main_queue, m_main_queue_family);
+        m_transfer_scheduler = m_transfer_queue_family == m_main_queue_family ? m_main_scheduler : render::SubmissionScheduler::create(me, m_transfer_queue, m_transfer_queue_family);
+        m_compute_scheduler  = m_compute_queue_family == m_main_queue_family ? m_main_scheduler : render::SubmissionScheduler::create(me, m_compute_queue, m_compute_queue_family);
+
+        m_descriptor_set_layout_cache = std::make_shared<render::DescriptorSetLayoutCache>();
+        m_pipeline_layout_cache       = std::make_shared<render::PipelineLayoutCache>();
+
+        if (m_warm_up) {
+            // the promise is kept before the job lets go of the context, which may be the last reference
+            auto promise   = std::make_shared<std::promise<void>>();
+            m_warm_up_done = promise->get_future().share();
+
+            jobs::JobFn job = [me, promise, fn = std::move(m_warm_up)] {
+                try {
+                    fn(me);
+                    promise->set_value();
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            };
+
+            // pipelines built during warm-up should hit the cache
+            if (m_pipeline_cache_ready) {
+                jobs::JobSystem::global()->run_after(*m_pipeline_cache_ready, std::move(job));
+            } else {
+                jobs::JobSystem::global()->run(std::move(job));
+            }
+        }
+
+        m_startup_timings.setup         = elapsed_ms(begin);
+        m_startup_timings.context_total = elapsed_ms(m_startup_begin);
+    }
+
+    void Context::load_pipeline_cache() {
+        const Clock::time_point begin = Clock::now();
+
+        // TODO: use actual cache dir (do this when updating to use proper application folders)
+        std::vector<char> data;
+        if (std::filesystem::exists("pipeline_cache")) {
+            std::ifstream f("pipeline_cache", std::ios::ate | std::ios::binary);
+            data.resize(static_cast<size_t>(f.tellg()));
+            f.seekg(0);
+            f.read(data.data(), static_cast<std::streamsize>(data.size()));
+            f.close();
+        }
+
+        m_pipeline_cache = m_device.createPipelineCache({{}, data.size(), data.data()});
+
+        m_startup_timings.pipeline_cache = elapsed_ms(begin);
+    }
+
+    void Context::save_pipeline_cache() {
+        auto data = m_device.getPipelineCacheData(m_pipeline_cache);
+
+        std::ofstream f("pipeline_cache", std::ios::binary | std::ios::out);
+        f.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        f.close();
+    }
+
+    const std::shared_ptr<CommandPool> &Context::transfer_pool() const {
+        if (!m_transfer_pool) {
+            m_transfer_pool = std::make_shared<CommandPool>(std::const_pointer_cast<Context>(shared_from_this()), m_transfer_queue_family);
+        }
+        return m_transfer_pool;
     }
 
     CommandPool::CommandPool(const std::shared_ptr<Context> &context, uint32_t queue_family, bool resettable) : m_context(context) {
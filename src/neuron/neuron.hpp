@@ -2,9 +2,13 @@
 
 #include "base.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_set>
@@ -25,7 +29,47 @@ namespace neuron {
         std::function<vk::PhysicalDevice(const std::vector<vk::PhysicalDevice> &)> selector;
     };
 
-    struct OptionalFeatureSet {};
+    enum class FeatureRequest { Disabled, Preferred, Required };
+
+    // Device features negotiated at Context creation. Preferred features are enabled when the device supports them,
+    // required ones make Context creation throw when it does not. Context::enabled_features() reports the outcome.
+    struct OptionalFeatureSet {
+        FeatureRequest descriptor_indexing             = FeatureRequest::Preferred;
+        FeatureRequest buffer_device_address           = FeatureRequest::Preferred;
+        FeatureRequest synchronization2                = FeatureRequest::Preferred;
+        FeatureRequest extended_dynamic_state          = FeatureRequest::Preferred;
+        FeatureRequest extended_dynamic_state2         = FeatureRequest::Preferred;
+        FeatureRequest extended_dynamic_state3         = FeatureRequest::Preferred; // the subset DynamicStateTracker sets, see EnabledFeatureSet
+        FeatureRequest vertex_input_dynamic_state      = FeatureRequest::Preferred;
+        FeatureRequest graphics_pipeline_library       = FeatureRequest::Preferred;
+        FeatureRequest memory_budget                   = FeatureRequest::Preferred;
+        FeatureRequest pipeline_creation_cache_control = FeatureRequest::Preferred;
+        FeatureRequest storage_8bit                    = FeatureRequest::Preferred;
+        FeatureRequest storage_16bit                   = FeatureRequest::Preferred;
+        FeatureRequest subgroup_size_control           = FeatureRequest::Preferred;
+        FeatureRequest multi_draw                      = FeatureRequest::Preferred; // multiDrawIndirect and gl_DrawID, plus drawIndirectCount where supported
+        FeatureRequest load_store_op_none              = FeatureRequest::Preferred;
+    };
+
+    struct EnabledFeatureSet {
+        bool descriptor_indexing             = false;
+        bool buffer_device_address           = false;
+        bool synchronization2                = false;
+        bool extended_dynamic_state          = false;
+        bool extended_dynamic_state2         = false; // rasterizer discard, depth bias and primitive restart enables
+        bool extended_dynamic_state3         = false; // polygon mode, depth clamp, logic op enable and per-attachment blend state
+        bool vertex_input_dynamic_state      = false;
+        bool graphics_pipeline_library       = false;
+        bool graphics_pipeline_fast_linking  = false; // only with graphics_pipeline_library; without it linking may cost as much as compiling
+        bool memory_budget                   = false;
+        bool pipeline_creation_cache_control = false;
+        bool storage_8bit                    = false;
+        bool storage_16bit                   = false;
+        bool subgroup_size_control           = false;
+        bool multi_draw_indirect             = false;
+        bool draw_indirect_count             = false; // only with multi_draw_indirect
+        bool load_store_op_none              = false; // AttachmentLoadOp::eNoneEXT; AttachmentStoreOp::eNone comes with dynamic rendering
+    };
 
     using ValidationCallbackFn =
         std::function<bool(vk::DebugUtilsMessageSeverityFlagBitsEXT, vk::DebugUtilsMessageTypeFlagsEXT, const vk::DebugUtilsMessengerCallbackDataEXT *, void *)>;
@@ -36,6 +80,14 @@ namespace neuron {
         uint32_t patch;
     };
 
+    class Context;
+
+    namespace jobs {
+        class Counter;
+    }
+
+    using WarmUpFn = std::function<void(const std::shared_ptr<Context> &)>;
+
     struct ContextSettings {
         std::string application_name = "Application";
         Version     application_version{0, 0, 1};
@@ -55,6 +107,16 @@ namespace neuron {
 
         OptionalFeatureSet optional_features;
 
+        // Lists every instance extension and layer and the selected GPU on stdout.
+        bool print_diagnostics = true;
+
+        // Reads and creates the pipeline cache on the job system instead of blocking Context::create(); pipeline_cache()
+        // waits for it. Meant to overlap with window and surface creation.
+        bool fast_start = false;
+
+        // Runs on the job system once the pipeline cache is ready, e.g. to compile shaders and build pipelines while the
+        // application creates its window. See Context::wait_for_warm_up().
+        WarmUpFn warm_up;
 
         NEURON_API ContextSettings &set_naive_device_selection();
         NEURON_API ContextSettings &set_device_index_selection(size_t index);
@@ -66,6 +128,18 @@ namespace neuron {
         void                *user_data;
     };
 
+    // Where Context::create() spent its time, in milliseconds.
+    struct StartupTimings {
+        double instance         = 0.0; // GLFW, extension/layer checks and instance creation
+        double device_selection = 0.0;
+        double device           = 0.0; // logical device and queues
+        double allocator        = 0.0;
+        double pipeline_cache   = 0.0; // file read and cache creation, off the critical path with fast_start
+        double setup            = 0.0; // schedulers and caches
+        double context_total    = 0.0; // all of Context::create()
+        double first_frame      = 0.0; // from the start of Context::create() to the first present, 0 until then
+    };
+
     template <typename T>
     struct VmaAllocated {
         T                 resource;
@@ -75,6 +149,12 @@ namespace neuron {
 
     class CommandPool;
 
+    namespace render {
+        class DescriptorSetLayoutCache;
+        class PipelineLayoutCache;
+        class SubmissionScheduler;
+    }
+
     class NEURON_API Context final : public std::enable_shared_from_this<Context> {
         explicit Context(const ContextSettings &settings);
       public:
@@ -99,6 +179,34 @@ namespace neuron {
         [[nodiscard]] uint32_t                                  compute_queue_family() const;
         [[nodiscard]] vk::PipelineCache                         pipeline_cache() const;
         [[nodiscard]] VmaAllocator                              allocator() const;
+        [[nodiscard]] bool                                      descriptor_indexing_enabled() const;
+        [[nodiscard]] bool                                      draw_indirect_count_enabled() const;
+        [[nodiscard]] bool                                      memory_budget_enabled() const;
+        [[nodiscard]] bool                                      host_visible_device_memory() const;
+        [[nodiscard]] bool                                      synchronization2_enabled() const;
+        [[nodiscard]] const vk::PhysicalDeviceProperties       &physical_device_properties() const;
+        [[nodiscard]] const EnabledFeatureSet                  &enabled_features() const;
+
+        [[nodiscard]] const std::shared_ptr<render::DescriptorSetLayoutCache> &descriptor_set_layout_cache() const;
+        [[nodiscard]] const std::shared_ptr<render::PipelineLayoutCache>      &pipeline_layout_cache() const;
+
+        // All submissions and presents go through these; the raw queues above are not externally synchronized.
+        // Queues that share a family share one scheduler.
+        [[nodiscard]] const std::shared_ptr<render::SubmissionScheduler> &main_scheduler() const;
+        [[nodiscard]] const std::shared_ptr<render::SubmissionScheduler> &transfer_scheduler() const;
+        [[nodiscard]] const std::shared_ptr<render::SubmissionScheduler> &compute_scheduler() const;
+
+        // vkDeviceWaitIdle through the schedulers.
+        void wait_idle() const;
+
+        // Blocks until ContextSettings::warm_up has run, rethrowing what it threw. Returns at once without one.
+        void wait_for_warm_up() const;
+
+        // Waits for the pipeline cache so that its time is known.
+        [[nodiscard]] StartupTimings startup_timings() const;
+
+        // Called by DisplaySystem on every present; only the first one is recorded.
+        void mark_first_frame();
 
         [[nodiscard]] VmaAllocated<vk::Image>  allocate_image(const vk::ImageCreateInfo &ici, const VmaAllocationCreateInfo &allocation_create_info) const;
         [[nodiscard]] VmaAllocated<vk::Buffer> allocate_buffer(const vk::BufferCreateInfo &bci, const VmaAllocationCreateInfo &allocation_create_info) const;
@@ -106,12 +214,17 @@ namespace neuron {
         void free_image(const VmaAllocated<vk::Image> &image) const;
         void free_buffer(const VmaAllocated<vk::Buffer> &buffer) const;
 
+        // Device-local buffer. On resizable BAR and unified memory devices the data is written straight into mapped device
+        // memory; otherwise it goes through a staging buffer and a blocking copy on the transfer queue.
         [[nodiscard]] VmaAllocated<vk::Buffer> allocate_gpu_buffer(size_t size, const void *data, vk::BufferUsageFlags usage) const;
 
         [[nodiscard]] VmaAllocated<vk::Buffer> allocate_staging_buffer(size_t size, const void *data, vk::BufferUsageFlags usage) const;
 
         [[nodiscard]] VmaAllocated<vk::Buffer> allocate_host_buffer(size_t size, const void *data, vk::BufferUsageFlags usage) const;
 
+        // Requires buffer_device_address in enabled_features() and a buffer created with eShaderDeviceAddress.
+        [[nodiscard]] vk::DeviceAddress buffer_device_address(const VmaAllocated<vk::Buffer> &buffer) const;
+
         [[nodiscard]] void *map_buffer(const VmaAllocated<vk::Buffer> &buffer) const;
         void                unmap_buffer(const VmaAllocated<vk::Buffer> &buffer) const;
 
@@ -133,12 +246,22 @@ namespace neuron {
             return  allocate_host_buffer(v.size() * sizeof(T), v.data(), usage);
         };
 
+        // Blocking upload of a single 2D texture with a generated mip chain (where the format allows blits).
+        // Use render::TextureUploader to batch many textures into few submissions.
         [[nodiscard]] VmaAllocated<vk::Image> allocate_gpu_image(const void* data, const vk::Extent2D& extent, vk::Format format) const;
 
       private:
 
         void setup(const std::shared_ptr<Context>& me);
 
+        void load_pipeline_cache();
+        void save_pipeline_cache();
+
+        // with m_transfer_pool_mutex held
+        const std::shared_ptr<CommandPool> &transfer_pool() const;
+
+        using Clock = std::chrono::steady_clock;
+
         vk::Instance                              m_instance;
         std::optional<vk::DebugUtilsMessengerEXT> m_debug_messenger;
         vk::PhysicalDevice                        m_physical_device;
@@ -152,16 +275,34 @@ namespace neuron {
         uint32_t m_transfer_queue_family;
         uint32_t m_compute_queue_family;
 
+        vk::PhysicalDeviceProperties m_physical_device_properties;
+
         OptionalFeatureSet m_optional_features;
-        DebugUserData     *m_debug_user_data = nullptr;
+        EnabledFeatureSet  m_enabled_features;
+        bool               m_host_visible_device_memory = false;
+        DebugUserData     *m_debug_user_data            = nullptr;
 
-        vk::PipelineCache m_pipeline_cache = VK_NULL_HANDLE;
+        vk::PipelineCache              m_pipeline_cache = VK_NULL_HANDLE;
+        std::unique_ptr<jobs::Counter> m_pipeline_cache_ready; // only with fast_start
+        WarmUpFn                       m_warm_up;
+        std::shared_future<void>       m_warm_up_done;
+
+        Clock::time_point   m_startup_begin;
+        StartupTimings      m_startup_timings;
+        std::atomic<double> m_first_frame{0.0};
 
         VmaAllocator m_allocator;
 
-        std::shared_ptr<CommandPool> m_main_pool;
-        std::shared_ptr<CommandPool> m_transfer_pool;
-        std::shared_ptr<CommandPool> m_compute_pool;
+        // created on first use
+        mutable std::shared_ptr<CommandPool> m_transfer_pool;
+        mutable std::mutex                   m_transfer_pool_mutex;
+
+        std::shared_ptr<render::DescriptorSetLayoutCache> m_descriptor_set_layout_cache;
+        std::shared_ptr<render::PipelineLayoutCache>      m_pipeline_layout_cache;
+
+        std::shared_ptr<render::SubmissionScheduler> m_main_scheduler;
+        std::shared_ptr<render::SubmissionScheduler> m_transfer_scheduler;
+        std::shared_ptr<render::SubmissionScheduler> m_compute_scheduler;
     };
 
     class NEURON_API CommandPool {
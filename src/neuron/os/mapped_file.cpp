@@ -0,0 +1,133 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace neuron::os {
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+        m_file_handle = file;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            close();
+            throw std::runtime_error("Failed to query file size: " + path.string());
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        if (m_size == 0) {
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path.string());
+        }
+        m_mapping_handle = mapping;
+
+        m_data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path.string());
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+
+        struct stat st {};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to query file size: " + path.string());
+        }
+        m_size = static_cast<size_t>(st.st_size);
+
+        if (m_size > 0) {
+            void *p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map file: " + path.string());
+            }
+            m_data = static_cast<const std::byte *>(p);
+        }
+
+        // the mapping keeps the file referenced
+        ::close(fd);
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)), m_file_handle(std::exchange(other.m_file_handle, nullptr)),
+          m_mapping_handle(std::exchange(other.m_mapping_handle, nullptr)) {}
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            close();
+            m_data           = std::exchange(other.m_data, nullptr);
+            m_size           = std::exchange(other.m_size, 0);
+            m_file_handle    = std::exchange(other.m_file_handle, nullptr);
+            m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+        }
+        return *this;
+    }
+
+    void MappedFile::prefetch(size_t offset, size_t size) const {
+        if (m_data == nullptr || offset >= m_size) {
+            return;
+        }
+        size = std::min(size, m_size - offset);
+
+#ifdef _WIN32
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<std::byte *>(m_data + offset), size};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        const auto   page  = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t begin = offset / page * page;
+        madvise(const_cast<std::byte *>(m_data + begin), size + (offset - begin), MADV_WILLNEED);
+#endif
+    }
+
+    void MappedFile::close() {
+#ifdef _WIN32
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping_handle) {
+            CloseHandle(m_mapping_handle);
+        }
+        if (m_file_handle) {
+            CloseHandle(m_file_handle);
+        }
+#else
+        if (m_data) {
+            munmap(const_cast<std::byte *>(m_data), m_size);
+        }
+#endif
+        m_data           = nullptr;
+        m_size           = 0;
+        m_file_handle    = nullptr;
+        m_mapping_handle = nullptr;
+    }
+} // namespace neuron::os
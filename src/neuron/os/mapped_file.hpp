@@ -0,0 +1,41 @@
+#pragma once
+
+#include "neuron/base.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace neuron::os {
+
+    // Read-only memory mapping of a whole file. The mapping starts page-aligned.
+    class NEURON_API MappedFile {
+      public:
+        explicit MappedFile(const std::filesystem::path &path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &other)            = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        [[nodiscard]] inline std::span<const std::byte> data() const { return {m_data, m_size}; }
+
+        [[nodiscard]] inline size_t size() const { return m_size; }
+
+        // Hints the OS to start paging in the given range.
+        void prefetch(size_t offset, size_t size) const;
+
+      private:
+        void close();
+
+        const std::byte *m_data = nullptr;
+        size_t           m_size = 0;
+
+        // only used on Windows
+        void *m_file_handle    = nullptr;
+        void *m_mapping_handle = nullptr;
+    };
+
+} // namespace neuron::os
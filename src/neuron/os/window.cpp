@@ -15,6 +15,37 @@ namespace neuron::os {
 
         m_window = glfwCreateWindow(settings.width, settings.height, settings.title.c_str(), nullptr, nullptr);
 
+        m_cached_extent = std::make_shared<CachedExtentProvider>(get_extent());
+
+        // the callbacks only forward; the cached extent is kept current whether or not events are forwarded
+        glfwSetWindowUserPointer(m_window, this);
+        glfwSetFramebufferSizeCallback(m_window, [](GLFWwindow *w, int width, int height) {
+            const auto        *window = static_cast<Window *>(glfwGetWindowUserPointer(w));
+            const vk::Extent2D extent{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+
+            window->m_cached_extent->set_extent(extent);
+            window->forward({.type = WindowEventType::Resize, .extent = extent});
+        });
+        glfwSetKeyCallback(m_window, [](GLFWwindow *w, int key, int scancode, int action, int mods) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::Key, .key = key, .scancode = scancode, .action = action, .mods = mods});
+        });
+        glfwSetCharCallback(m_window, [](GLFWwindow *w, unsigned int codepoint) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::Char, .codepoint = codepoint});
+        });
+        glfwSetMouseButtonCallback(m_window, [](GLFWwindow *w, int button, int action, int mods) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::MouseButton, .key = button, .action = action, .mods = mods});
+        });
+        glfwSetCursorPosCallback(m_window, [](GLFWwindow *w, double x, double y) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::CursorMove, .x = x, .y = y});
+        });
+        glfwSetScrollCallback(m_window, [](GLFWwindow *w, double x, double y) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::Scroll, .x = x, .y = y});
+        });
+        glfwSetWindowFocusCallback(m_window, [](GLFWwindow *w, int focused) {
+            static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::Focus, .action = focused});
+        });
+        glfwSetWindowCloseCallback(m_window, [](GLFWwindow *w) { static_cast<Window *>(glfwGetWindowUserPointer(w))->forward({.type = WindowEventType::Close}); });
+
         VkSurfaceKHR s;
         glfwCreateWindowSurface(m_context->instance(), m_window, nullptr, &s);
         m_surface = s;
@@ -41,6 +72,20 @@ namespace neuron::os {
         glfwPollEvents();
     }
 
+    void Window::wait_events(double timeout) {
+        glfwWaitEventsTimeout(timeout);
+    }
+
+    void Window::forward_events(const std::shared_ptr<WindowEventQueue> &queue) {
+        m_event_queue = queue;
+    }
+
+    void Window::forward(const WindowEvent &event) const {
+        if (m_event_queue) {
+            m_event_queue->push(event);
+        }
+    }
+
     bool Window::is_open() const {
         return !glfwWindowShouldClose(m_window);
     }
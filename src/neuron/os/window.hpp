@@ -10,6 +10,7 @@
 #include <string>
 
 #include "neuron/interface.hpp"
+#include "window_events.hpp"
 
 namespace neuron::os {
 
@@ -32,6 +33,16 @@ namespace neuron::os {
 
         static void poll_events();
 
+        // Blocks until an event arrives or timeout seconds pass.
+        static void wait_events(double timeout);
+
+        // Mirrors this window's input, resize and close events into the queue from here on. Call on the main thread;
+        // nullptr stops forwarding.
+        void forward_events(const std::shared_ptr<WindowEventQueue> &queue);
+
+        // The framebuffer extent, for threads that must not call into GLFW (e.g. a DisplaySystem on a render thread).
+        [[nodiscard]] inline const std::shared_ptr<CachedExtentProvider> &cached_extent() const { return m_cached_extent; }
+
         [[nodiscard]] bool is_open() const;
 
         [[nodiscard]] vk::SurfaceKHR get_surface() const override;
@@ -39,10 +50,15 @@ namespace neuron::os {
         [[nodiscard]] vk::Extent2D get_extent() const override;
 
       protected:
+        void forward(const WindowEvent &event) const;
+
         GLFWwindow *m_window;
 
         vk::SurfaceKHR m_surface = nullptr;
 
+        std::shared_ptr<CachedExtentProvider> m_cached_extent;
+        std::shared_ptr<WindowEventQueue>     m_event_queue;
+
         std::shared_ptr<Context> m_context;
     };
 
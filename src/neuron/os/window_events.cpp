@@ -0,0 +1,51 @@
+#include "window_events.hpp"
+
+#include <algorithm>
+
+namespace neuron::os {
+    WindowEventQueue::WindowEventQueue(uint32_t capacity) : m_events(std::max(capacity, 1U)) {}
+
+    std::shared_ptr<WindowEventQueue> WindowEventQueue::create(uint32_t capacity) {
+        return std::shared_ptr<WindowEventQueue>(new WindowEventQueue(capacity));
+    }
+
+    bool WindowEventQueue::push(const WindowEvent &event) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_events.size()) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_events[tail % m_events.size()] = event;
+
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool WindowEventQueue::try_pop(WindowEvent &event) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        event = m_events[head % m_events.size()];
+
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    static uint64_t pack_extent(vk::Extent2D extent) {
+        return static_cast<uint64_t>(extent.width) << 32 | extent.height;
+    }
+
+    CachedExtentProvider::CachedExtentProvider(vk::Extent2D extent) : m_extent(pack_extent(extent)) {}
+
+    void CachedExtentProvider::set_extent(vk::Extent2D extent) {
+        m_extent.store(pack_extent(extent), std::memory_order_release);
+    }
+
+    vk::Extent2D CachedExtentProvider::get_extent() const {
+        const uint64_t packed = m_extent.load(std::memory_order_acquire);
+        return {static_cast<uint32_t>(packed >> 32), static_cast<uint32_t>(packed)};
+    }
+} // namespace neuron::os
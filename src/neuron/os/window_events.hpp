@@ -0,0 +1,75 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/interface.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace neuron::os {
+
+    enum class WindowEventType : uint8_t { Resize, Key, Char, MouseButton, CursorMove, Scroll, Focus, Close };
+
+    // Fields not used by an event's type are zero.
+    struct WindowEvent {
+        WindowEventType type;
+
+        vk::Extent2D extent; // Resize: framebuffer size in pixels
+
+        int32_t  key       = 0; // Key: GLFW_KEY_*, MouseButton: GLFW_MOUSE_BUTTON_*
+        int32_t  scancode  = 0;
+        int32_t  action    = 0; // GLFW_PRESS/RELEASE/REPEAT, Focus: 1 when focused
+        int32_t  mods      = 0;
+        uint32_t codepoint = 0; // Char
+
+        double x = 0.0; // CursorMove: position, Scroll: offset
+        double y = 0.0;
+    };
+
+    // Single-producer single-consumer ring of window events: the main thread pushes from the GLFW callbacks, another
+    // thread pops. Neither side locks or allocates; events pushed while the ring is full are dropped.
+    class NEURON_API WindowEventQueue {
+        explicit WindowEventQueue(uint32_t capacity);
+
+      public:
+        static std::shared_ptr<WindowEventQueue> create(uint32_t capacity = 256);
+
+        WindowEventQueue(const WindowEventQueue &other)            = delete;
+        WindowEventQueue &operator=(const WindowEventQueue &other) = delete;
+
+        // Producer side. Returns false when the event was dropped.
+        bool push(const WindowEvent &event);
+
+        // Consumer side.
+        bool try_pop(WindowEvent &event);
+
+        [[nodiscard]] inline uint64_t dropped_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+      private:
+        std::vector<WindowEvent> m_events;
+
+        // on separate cache lines, each is written by one side only
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+    // The last extent it was given, readable from any thread. Window keeps one up to date from its framebuffer size
+    // callback, so a DisplaySystem on another thread can rebuild the swapchain without calling into GLFW.
+    class NEURON_API CachedExtentProvider final : public intfc::ExtentProvider {
+      public:
+        explicit CachedExtentProvider(vk::Extent2D extent = {});
+
+        void set_extent(vk::Extent2D extent);
+
+        [[nodiscard]] vk::Extent2D get_extent() const override;
+
+      private:
+        // width in the high half, height in the low one, so both change together
+        std::atomic<uint64_t> m_extent;
+    };
+
+} // namespace neuron::os
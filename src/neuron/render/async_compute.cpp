@@ -0,0 +1,123 @@
+#include "async_compute.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace neuron::render {
+    void record_ownership_release(const vk::CommandBuffer &cmd, uint32_t src_family, uint32_t dst_family, std::span<const BufferOwnershipTransfer> buffers,
+                                  std::span<const ImageOwnershipTransfer> images) {
+        if (src_family == dst_family) {
+            return;
+        }
+
+        std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+        std::vector<vk::ImageMemoryBarrier>  image_barriers;
+        vk::PipelineStageFlags               src_stages;
+
+        for (const auto &t : buffers) {
+            buffer_barriers.emplace_back(t.src_access, vk::AccessFlags{}, src_family, dst_family, t.buffer, t.offset, t.size);
+            src_stages |= t.src_stage;
+        }
+
+        for (const auto &t : images) {
+            image_barriers.emplace_back(t.src_access, vk::AccessFlags{}, t.old_layout, t.new_layout, src_family, dst_family, t.image, t.range);
+            src_stages |= t.src_stage;
+        }
+
+        if (buffer_barriers.empty() && image_barriers.empty()) {
+            return;
+        }
+
+        cmd.pipelineBarrier(src_stages, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, buffer_barriers, image_barriers);
+    }
+
+    void record_ownership_acquire(const vk::CommandBuffer &cmd, uint32_t src_family, uint32_t dst_family, std::span<const BufferOwnershipTransfer> buffers,
+                                  std::span<const ImageOwnershipTransfer> images) {
+        std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+        std::vector<vk::ImageMemoryBarrier>  image_barriers;
+        vk::PipelineStageFlags               dst_stages;
+
+        if (src_family != dst_family) {
+            for (const auto &t : buffers) {
+                buffer_barriers.emplace_back(vk::AccessFlags{}, t.dst_access, src_family, dst_family, t.buffer, t.offset, t.size);
+                dst_stages |= t.dst_stage;
+            }
+        }
+
+        for (const auto &t : images) {
+            if (src_family == dst_family && t.old_layout == t.new_layout) {
+                continue;
+            }
+
+            // same family: a plain layout transition, ordered after the semaphore wait
+            const uint32_t src = src_family == dst_family ? VK_QUEUE_FAMILY_IGNORED : src_family;
+            const uint32_t dst = src_family == dst_family ? VK_QUEUE_FAMILY_IGNORED : dst_family;
+            image_barriers.emplace_back(vk::AccessFlags{}, t.dst_access, t.old_layout, t.new_layout, src, dst, t.image, t.range);
+            dst_stages |= t.dst_stage;
+        }
+
+        if (buffer_barriers.empty() && image_barriers.empty()) {
+            return;
+        }
+
+        const vk::PipelineStageFlags src_stage = src_family == dst_family ? vk::PipelineStageFlagBits::eAllCommands : vk::PipelineStageFlagBits::eTopOfPipe;
+        cmd.pipelineBarrier(src_stage, dst_stages, {}, {}, buffer_barriers, image_barriers);
+    }
+
+    AsyncComputeScheduler::AsyncComputeScheduler(const std::shared_ptr<Context> &context)
+        : m_context(context), m_compute_family(context->compute_queue_family()), m_graphics_family(context->main_queue_family()), m_compute(context->compute_scheduler()),
+          m_graphics(context->main_scheduler()) {
+        m_compute_pool = std::make_shared<CommandPool>(m_context, m_compute_family, true);
+    }
+
+    std::shared_ptr<AsyncComputeScheduler> AsyncComputeScheduler::create(const std::shared_ptr<Context> &context) {
+        return std::shared_ptr<AsyncComputeScheduler>(new AsyncComputeScheduler(context));
+    }
+
+    AsyncComputeScheduler::~AsyncComputeScheduler() = default;
+
+    uint64_t AsyncComputeScheduler::submit_compute(std::span<const vk::CommandBuffer> command_buffers, std::span<const TimelineWait> waits) {
+        if (waits.size() > MAX_WAITS) {
+            throw std::runtime_error("Too many timeline waits in one submission");
+        }
+
+        return m_compute->submit({.command_buffers = command_buffers, .waits = waits});
+    }
+
+    uint64_t AsyncComputeScheduler::submit_graphics(std::span<const vk::CommandBuffer> command_buffers, std::span<const TimelineWait> waits, const GraphicsSubmitExtras &extras) {
+        if (waits.size() > MAX_WAITS) {
+            throw std::runtime_error("Too many timeline waits in one submission");
+        }
+
+        std::array<TimelineWait, MAX_WAITS + 1> all_waits{};
+        std::ranges::copy(waits, all_waits.begin());
+        size_t wait_count = waits.size();
+        if (extras.wait_binary) {
+            all_waits[wait_count++] = {extras.wait_binary, 0, extras.wait_binary_stage};
+        }
+
+        const size_t signal_count = extras.signal_binary ? 1 : 0;
+
+        return m_graphics->submit({.command_buffers = command_buffers,
+                                   .waits           = std::span(all_waits.data(), wait_count),
+                                   .signal_binary   = std::span(&extras.signal_binary, signal_count),
+                                   .fence           = extras.fence});
+    }
+
+    uint64_t AsyncComputeScheduler::completed_compute() const {
+        return m_compute->completed();
+    }
+
+    uint64_t AsyncComputeScheduler::completed_graphics() const {
+        return m_graphics->completed();
+    }
+
+    void AsyncComputeScheduler::wait_compute(uint64_t value) const {
+        m_compute->wait(value);
+    }
+
+    void AsyncComputeScheduler::wait_graphics(uint64_t value) const {
+        m_graphics->wait(value);
+    }
+} // namespace neuron::render
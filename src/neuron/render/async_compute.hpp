@@ -0,0 +1,106 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "submission_scheduler.hpp"
+
+#include <memory>
+#include <span>
+
+namespace neuron::render {
+
+    // Binary semaphores and fence for the swapchain side of a graphics submission.
+    struct GraphicsSubmitExtras {
+        vk::Semaphore          wait_binary       = VK_NULL_HANDLE;
+        vk::PipelineStageFlags wait_binary_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        vk::Semaphore          signal_binary     = VK_NULL_HANDLE;
+        vk::Fence              fence             = VK_NULL_HANDLE;
+    };
+
+    struct BufferOwnershipTransfer {
+        vk::Buffer     buffer;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size   = VK_WHOLE_SIZE;
+
+        vk::PipelineStageFlags src_stage;
+        vk::AccessFlags        src_access;
+        vk::PipelineStageFlags dst_stage;
+        vk::AccessFlags        dst_access;
+    };
+
+    struct ImageOwnershipTransfer {
+        vk::Image                 image;
+        vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eColor, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+        vk::ImageLayout           old_layout;
+        vk::ImageLayout           new_layout;
+
+        vk::PipelineStageFlags src_stage;
+        vk::AccessFlags        src_access;
+        vk::PipelineStageFlags dst_stage;
+        vk::AccessFlags        dst_access;
+    };
+
+    // Half of a queue family ownership transfer. Record the release on the queue that last used the resources and the
+    // matching acquire (same arguments) on the queue that uses them next, with a semaphore dependency in between.
+    // When both families are the same no ownership changes hands; only image layout transitions are recorded on acquire.
+    NEURON_API void record_ownership_release(const vk::CommandBuffer &cmd, uint32_t src_family, uint32_t dst_family, std::span<const BufferOwnershipTransfer> buffers,
+                                             std::span<const ImageOwnershipTransfer> images = {});
+    NEURON_API void record_ownership_acquire(const vk::CommandBuffer &cmd, uint32_t src_family, uint32_t dst_family, std::span<const BufferOwnershipTransfer> buffers,
+                                             std::span<const ImageOwnershipTransfer> images = {});
+
+    // Submits to the compute and main queues through their SubmissionSchedulers, so compute work can overlap graphics
+    // work and either side can wait on the other's timeline. Each submit returns the timeline value it signals.
+    // Without a dedicated compute family both go to the main queue's scheduler, which keeps the same API working serially.
+    class NEURON_API AsyncComputeScheduler {
+        explicit AsyncComputeScheduler(const std::shared_ptr<Context> &context);
+
+      public:
+        static constexpr size_t MAX_WAITS = SubmissionScheduler::MAX_WAITS - 1;
+
+        static std::shared_ptr<AsyncComputeScheduler> create(const std::shared_ptr<Context> &context);
+
+        ~AsyncComputeScheduler();
+
+        AsyncComputeScheduler(const AsyncComputeScheduler &other)            = delete;
+        AsyncComputeScheduler &operator=(const AsyncComputeScheduler &other) = delete;
+
+        uint64_t submit_compute(std::span<const vk::CommandBuffer> command_buffers, std::span<const TimelineWait> waits = {});
+        uint64_t submit_graphics(std::span<const vk::CommandBuffer> command_buffers, std::span<const TimelineWait> waits = {}, const GraphicsSubmitExtras &extras = {});
+
+        [[nodiscard]] inline TimelineWait after_compute(uint64_t value, vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands) const {
+            return m_compute->after(value, stage);
+        }
+
+        [[nodiscard]] inline TimelineWait after_graphics(uint64_t value, vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands) const {
+            return m_graphics->after(value, stage);
+        }
+
+        [[nodiscard]] uint64_t completed_compute() const;
+        [[nodiscard]] uint64_t completed_graphics() const;
+
+        void wait_compute(uint64_t value) const;
+        void wait_graphics(uint64_t value) const;
+
+        [[nodiscard]] inline bool is_async() const { return m_compute_family != m_graphics_family; }
+
+        [[nodiscard]] inline uint32_t compute_family() const { return m_compute_family; }
+
+        [[nodiscard]] inline uint32_t graphics_family() const { return m_graphics_family; }
+
+        [[nodiscard]] inline vk::Semaphore compute_timeline() const { return m_compute->timeline(); }
+
+        [[nodiscard]] inline vk::Semaphore graphics_timeline() const { return m_graphics->timeline(); }
+
+        // Pool on the compute family for recording compute submissions.
+        [[nodiscard]] inline const std::shared_ptr<CommandPool> &compute_command_pool() const { return m_compute_pool; }
+
+      private:
+        std::shared_ptr<Context>             m_context;
+        uint32_t                             m_compute_family;
+        uint32_t                             m_graphics_family;
+        std::shared_ptr<SubmissionScheduler> m_compute;
+        std::shared_ptr<SubmissionScheduler> m_graphics;
+        std::shared_ptr<CommandPool>         m_compute_pool;
+    };
+
+} // namespace neuron::render
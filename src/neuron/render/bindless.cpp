@@ -0,0 +1,147 @@
+#include "bindless.hpp"
+
+#include "display_system.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace neuron::render {
+    BindlessHandle BindlessResourceTable::HandleAllocator::allocate() {
+        if (!free_list.empty()) {
+            BindlessHandle handle = free_list.back();
+            free_list.pop_back();
+            return handle;
+        }
+
+        if (next >= capacity) {
+            throw std::runtime_error("Bindless resource table is full");
+        }
+
+        return next++;
+    }
+
+    void BindlessResourceTable::HandleAllocator::retire(BindlessHandle handle, uint64_t frame) {
+        retired.emplace_back(handle, frame);
+    }
+
+    void BindlessResourceTable::HandleAllocator::recycle(uint64_t frame) {
+        std::erase_if(retired, [&](const std::pair<BindlessHandle, uint64_t> &r) {
+            if (frame - r.second >= DisplaySystem::MAX_FRAMES_IN_FLIGHT) {
+                free_list.push_back(r.first);
+                return true;
+            }
+            return false;
+        });
+    }
+
+    BindlessResourceTable::BindlessResourceTable(const std::shared_ptr<Context> &context, const BindlessTableSettings &settings) : m_context(context), m_settings(settings) {
+        if (!m_context->descriptor_indexing_enabled()) {
+            throw std::runtime_error("Bindless resource table requires descriptor indexing support");
+        }
+
+        auto props = m_context->physical_device().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorIndexingProperties>();
+        const auto &di_props = props.get<vk::PhysicalDeviceDescriptorIndexingProperties>();
+
+        m_settings.max_sampled_images = std::min({m_settings.max_sampled_images, di_props.maxDescriptorSetUpdateAfterBindSampledImages,
+                                                  di_props.maxPerStageDescriptorUpdateAfterBindSampledImages});
+        m_settings.max_storage_buffers = std::min({m_settings.max_storage_buffers, di_props.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                                   di_props.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+        m_settings.max_samplers = std::min({m_settings.max_samplers, di_props.maxDescriptorSetUpdateAfterBindSamplers, di_props.maxPerStageDescriptorUpdateAfterBindSamplers});
+
+        m_sampled_images.capacity  = m_settings.max_sampled_images;
+        m_storage_buffers.capacity = m_settings.max_storage_buffers;
+        m_samplers.capacity        = m_settings.max_samplers;
+
+        vk::DescriptorBindingFlags binding_flags = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+
+        auto v12 = m_context->physical_device().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        if (v12.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingUpdateUnusedWhilePending) {
+            binding_flags |= vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+        }
+
+        m_set_layout = DescriptorSetLayoutBuilder()
+                           .set_flags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool)
+                           .add_binding(SAMPLED_IMAGE_BINDING, vk::DescriptorType::eSampledImage, vk::ShaderStageFlagBits::eAll, m_settings.max_sampled_images, binding_flags)
+                           .add_binding(STORAGE_BUFFER_BINDING, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eAll, m_settings.max_storage_buffers, binding_flags)
+                           .add_binding(SAMPLER_BINDING, vk::DescriptorType::eSampler, vk::ShaderStageFlagBits::eAll, m_settings.max_samplers, binding_flags)
+                           .build(m_context);
+
+        std::array<vk::DescriptorPoolSize, 3> pool_sizes = {
+            vk::DescriptorPoolSize{vk::DescriptorType::eSampledImage, m_settings.max_sampled_images},
+            vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, m_settings.max_storage_buffers},
+            vk::DescriptorPoolSize{vk::DescriptorType::eSampler, m_settings.max_samplers},
+        };
+
+        m_descriptor_pool = m_context->device().createDescriptorPool(vk::DescriptorPoolCreateInfo{vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, pool_sizes});
+
+        vk::DescriptorSetLayout set_layout = m_set_layout->set_layout();
+        m_descriptor_set                   = m_context->device().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{m_descriptor_pool, set_layout})[0];
+    }
+
+    std::shared_ptr<BindlessResourceTable> BindlessResourceTable::create(const std::shared_ptr<Context> &context, const BindlessTableSettings &settings) {
+        return std::shared_ptr<BindlessResourceTable>(new BindlessResourceTable(context, settings));
+    }
+
+    BindlessResourceTable::~BindlessResourceTable() {
+        m_context->device().destroy(m_descriptor_pool);
+    }
+
+    BindlessHandle BindlessResourceTable::add_sampled_image(vk::ImageView image_view, vk::ImageLayout layout) {
+        std::lock_guard lock(m_mutex);
+
+        BindlessHandle          handle = m_sampled_images.allocate();
+        vk::DescriptorImageInfo image_info{nullptr, image_view, layout};
+
+        m_context->device().updateDescriptorSets(vk::WriteDescriptorSet{m_descriptor_set, SAMPLED_IMAGE_BINDING, handle, vk::DescriptorType::eSampledImage, image_info}, {});
+        return handle;
+    }
+
+    BindlessHandle BindlessResourceTable::add_storage_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+        std::lock_guard lock(m_mutex);
+
+        BindlessHandle           handle = m_storage_buffers.allocate();
+        vk::DescriptorBufferInfo buffer_info{buffer, offset, range};
+
+        m_context->device().updateDescriptorSets(vk::WriteDescriptorSet{m_descriptor_set, STORAGE_BUFFER_BINDING, handle, vk::DescriptorType::eStorageBuffer, {}, buffer_info},
+                                                 {});
+        return handle;
+    }
+
+    BindlessHandle BindlessResourceTable::add_sampler(vk::Sampler sampler) {
+        std::lock_guard lock(m_mutex);
+
+        BindlessHandle          handle = m_samplers.allocate();
+        vk::DescriptorImageInfo image_info{sampler, nullptr, vk::ImageLayout::eUndefined};
+
+        m_context->device().updateDescriptorSets(vk::WriteDescriptorSet{m_descriptor_set, SAMPLER_BINDING, handle, vk::DescriptorType::eSampler, image_info}, {});
+        return handle;
+    }
+
+    void BindlessResourceTable::remove_sampled_image(BindlessHandle handle) {
+        std::lock_guard lock(m_mutex);
+        m_sampled_images.retire(handle, m_frame);
+    }
+
+    void BindlessResourceTable::remove_storage_buffer(BindlessHandle handle) {
+        std::lock_guard lock(m_mutex);
+        m_storage_buffers.retire(handle, m_frame);
+    }
+
+    void BindlessResourceTable::remove_sampler(BindlessHandle handle) {
+        std::lock_guard lock(m_mutex);
+        m_samplers.retire(handle, m_frame);
+    }
+
+    void BindlessResourceTable::begin_frame() {
+        std::lock_guard lock(m_mutex);
+        m_frame++;
+
+        m_sampled_images.recycle(m_frame);
+        m_storage_buffers.recycle(m_frame);
+        m_samplers.recycle(m_frame);
+    }
+
+    void BindlessResourceTable::bind(const vk::CommandBuffer &cmd, vk::PipelineBindPoint bind_point, const std::shared_ptr<PipelineLayout> &layout, uint32_t set_index) const {
+        cmd.bindDescriptorSets(bind_point, layout->pipeline_layout(), set_index, m_descriptor_set, {});
+    }
+} // namespace neuron::render
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "pipeline_layout.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace neuron::render {
+
+    using BindlessHandle = uint32_t;
+
+    constexpr BindlessHandle INVALID_BINDLESS_HANDLE = ~0U;
+
+    struct BindlessTableSettings {
+        uint32_t max_sampled_images  = 16384;
+        uint32_t max_storage_buffers = 16384;
+        uint32_t max_samplers        = 256;
+    };
+
+    // One global, update-after-bind descriptor set holding every sampled image, storage buffer and sampler.
+    // Shaders index into it with handles passed through push constants, e.g.
+    //
+    //   #extension GL_EXT_nonuniform_qualifier : require
+    //   layout(set = 0, binding = 0) uniform texture2D bindless_textures[];
+    //   layout(set = 0, binding = 1) readonly buffer BindlessBuffer { uint data[]; } bindless_buffers[];
+    //   layout(set = 0, binding = 2) uniform sampler bindless_samplers[];
+    //
+    // Handles are stable until removed, and removed handles are only recycled once the frames that could
+    // still reference them have retired (see begin_frame).
+    class NEURON_API BindlessResourceTable {
+        BindlessResourceTable(const std::shared_ptr<Context> &context, const BindlessTableSettings &settings);
+
+      public:
+        static std::shared_ptr<BindlessResourceTable> create(const std::shared_ptr<Context> &context, const BindlessTableSettings &settings = {});
+
+        ~BindlessResourceTable();
+
+        BindlessResourceTable(const BindlessResourceTable &other)            = delete;
+        BindlessResourceTable &operator=(const BindlessResourceTable &other) = delete;
+
+        static constexpr uint32_t SAMPLED_IMAGE_BINDING  = 0;
+        static constexpr uint32_t STORAGE_BUFFER_BINDING = 1;
+        static constexpr uint32_t SAMPLER_BINDING        = 2;
+
+        [[nodiscard]] BindlessHandle add_sampled_image(vk::ImageView image_view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+        [[nodiscard]] BindlessHandle add_storage_buffer(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+        [[nodiscard]] BindlessHandle add_sampler(vk::Sampler sampler);
+
+        void remove_sampled_image(BindlessHandle handle);
+        void remove_storage_buffer(BindlessHandle handle);
+        void remove_sampler(BindlessHandle handle);
+
+        // Advances the table by one frame, recycling handles removed at least MAX_FRAMES_IN_FLIGHT frames ago.
+        void begin_frame();
+
+        void bind(const vk::CommandBuffer &cmd, vk::PipelineBindPoint bind_point, const std::shared_ptr<PipelineLayout> &layout, uint32_t set_index = 0) const;
+
+        [[nodiscard]] inline const std::shared_ptr<DescriptorSetLayout> &set_layout() const { return m_set_layout; }
+
+        [[nodiscard]] inline vk::DescriptorSet descriptor_set() const { return m_descriptor_set; }
+
+        [[nodiscard]] inline const BindlessTableSettings &settings() const { return m_settings; }
+
+      private:
+        struct HandleAllocator {
+            uint32_t capacity = 0;
+            uint32_t next     = 0;
+
+            std::vector<BindlessHandle>                        free_list;
+            std::vector<std::pair<BindlessHandle, uint64_t>> retired;
+
+            BindlessHandle allocate();
+            void           retire(BindlessHandle handle, uint64_t frame);
+            void           recycle(uint64_t frame);
+        };
+
+        std::shared_ptr<Context>             m_context;
+        BindlessTableSettings                m_settings;
+        std::shared_ptr<DescriptorSetLayout> m_set_layout;
+        vk::DescriptorPool                   m_descriptor_pool;
+        vk::DescriptorSet                    m_descriptor_set;
+
+        std::mutex      m_mutex;
+        uint64_t        m_frame = 0;
+        HandleAllocator m_sampled_images;
+        HandleAllocator m_storage_buffers;
+        HandleAllocator m_samplers;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,103 @@
+#include "compute_pipeline.hpp"
+
+#include "shader_reflection.hpp"
+
+namespace neuron::render {
+    ComputePipelineBuilder &ComputePipelineBuilder::set_shader(const ShaderModuleSource &module) {
+        shader = module;
+        return *this;
+    }
+
+    ComputePipelineBuilder &ComputePipelineBuilder::set_shader(const ShaderModuleInfo &module) {
+        shader = module;
+        return *this;
+    }
+
+    ComputePipelineBuilder &ComputePipelineBuilder::set_glsl_shader(const std::filesystem::path &path) {
+        shader = ShaderModuleInfo{.source = path, .type = ShaderModuleSourceType::GLSL, .stage = vk::ShaderStageFlagBits::eCompute};
+        return *this;
+    }
+
+    ComputePipelineBuilder &ComputePipelineBuilder::set_descriptor_set_layout(uint32_t set, const std::shared_ptr<DescriptorSetLayout> &set_layout) {
+        descriptor_set_layout_overrides[set] = set_layout;
+        return *this;
+    }
+
+    ComputePipelineBuilder &ComputePipelineBuilder::reflect(const std::shared_ptr<Context> &ctx) {
+        if (shader.index() == 2) {
+            shader = ShaderModule::load(ctx, std::get<2>(shader));
+        }
+
+        if (!layout) {
+            if (shader.index() != 1) {
+                throw std::runtime_error("Cannot derive a pipeline layout from a raw vk::ShaderModule");
+            }
+
+            const ShaderReflection *reflection = &std::get<1>(shader)->reflection();
+            layout = build_pipeline_layout(ctx, merge_reflections(std::span<const ShaderReflection *const>(&reflection, 1), canonicalize_layout),
+                                           descriptor_set_layout_overrides);
+        }
+
+        return *this;
+    }
+
+    std::shared_ptr<ComputePipeline> ComputePipelineBuilder::build(const std::shared_ptr<Context> &ctx) {
+        if (!layout || shader.index() == 2) {
+            reflect(ctx);
+        }
+
+        return std::make_shared<ComputePipeline>(ctx, *this);
+    }
+
+    ComputePipeline::ComputePipeline(const std::shared_ptr<Context> &context, const ComputePipelineBuilder &builder) : m_context(context), m_layout(builder.layout) {
+        vk::ShaderModule module;
+
+        switch (builder.shader.index()) {
+        case 0:
+            module = std::get<0>(builder.shader);
+            break;
+        case 1:
+            m_shader_module = std::get<1>(builder.shader);
+            break;
+        case 2:
+            m_shader_module = ShaderModule::load(m_context, std::get<2>(builder.shader));
+            break;
+        default:
+            throw std::runtime_error("Invalid shader module (variant incorrectly set)");
+        }
+
+        if (m_shader_module) {
+            module       = m_shader_module->module();
+            m_local_size = m_shader_module->reflection().local_size;
+        }
+
+        if (!m_layout) {
+            throw std::runtime_error("Compute pipeline has no layout");
+        }
+
+        vk::ComputePipelineCreateInfo create_info{};
+        create_info.setStage(vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, module, "main"));
+        create_info.setLayout(m_layout->pipeline_layout());
+        create_info.setBasePipelineHandle(builder.base_pipeline);
+        create_info.setBasePipelineIndex(builder.base_pipeline_index);
+
+        auto result = m_context->device().createComputePipeline(m_context->pipeline_cache(), create_info);
+        if (result.result != vk::Result::eSuccess) {
+            throw std::runtime_error("Failed to create compute pipeline");
+        }
+
+        m_pipeline = result.value;
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        m_context->device().destroyPipeline(m_pipeline);
+    }
+
+    void ComputePipeline::bind(const vk::CommandBuffer &cmd) const {
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+    }
+
+    void ComputePipeline::dispatch_invocations(const vk::CommandBuffer &cmd, uint32_t x, uint32_t y, uint32_t z) const {
+        cmd.dispatch((x + m_local_size[0] - 1) / m_local_size[0], (y + m_local_size[1] - 1) / m_local_size[1], (z + m_local_size[2] - 1) / m_local_size[2]);
+    }
+} // namespace neuron::render
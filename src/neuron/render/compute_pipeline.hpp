@@ -0,0 +1,69 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "graphics_pipeline.hpp"
+#include "pipeline_layout.hpp"
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+
+namespace neuron::render {
+
+    class ComputePipeline;
+
+    struct NEURON_API ComputePipelineBuilder {
+        ShaderModuleSource shader;
+
+        // When null the layout is derived from the shader's SPIR-V, see reflect().
+        std::shared_ptr<PipelineLayout>                          layout;
+        std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> descriptor_set_layout_overrides;
+        bool                                                     canonicalize_layout = true;
+
+        vk::Pipeline base_pipeline       = VK_NULL_HANDLE;
+        int32_t      base_pipeline_index = -1;
+
+        ComputePipelineBuilder &set_shader(const ShaderModuleSource &module);
+        ComputePipelineBuilder &set_shader(const ShaderModuleInfo &module);
+        ComputePipelineBuilder &set_glsl_shader(const std::filesystem::path &path);
+        ComputePipelineBuilder &set_descriptor_set_layout(uint32_t set, const std::shared_ptr<DescriptorSetLayout> &set_layout);
+
+        // Loads the shader module and derives the layout from its SPIR-V if none was given. Called by build() when needed.
+        ComputePipelineBuilder &reflect(const std::shared_ptr<Context> &ctx);
+
+        std::shared_ptr<ComputePipeline> build(const std::shared_ptr<Context> &ctx);
+
+        inline ComputePipelineBuilder() = default;
+        explicit inline ComputePipelineBuilder(const std::shared_ptr<PipelineLayout> &layout_) : layout(layout_) {}
+    };
+
+    class NEURON_API ComputePipeline {
+      public:
+        ComputePipeline(const std::shared_ptr<Context> &context, const ComputePipelineBuilder &builder);
+
+        ~ComputePipeline();
+
+        [[nodiscard]] inline vk::Pipeline pipeline() const { return m_pipeline; }
+
+        [[nodiscard]] inline const std::shared_ptr<PipelineLayout> &layout() const { return m_layout; }
+
+        // Workgroup size declared by the shader, {1, 1, 1} when it could not be reflected.
+        [[nodiscard]] inline const std::array<uint32_t, 3> &local_size() const { return m_local_size; }
+
+        void bind(const vk::CommandBuffer &cmd) const;
+
+        // Dispatches enough workgroups to cover the given number of invocations per dimension.
+        void dispatch_invocations(const vk::CommandBuffer &cmd, uint32_t x, uint32_t y = 1, uint32_t z = 1) const;
+
+      private:
+        std::shared_ptr<Context>        m_context;
+        std::shared_ptr<PipelineLayout> m_layout;
+        std::shared_ptr<ShaderModule>   m_shader_module;
+        std::array<uint32_t, 3>         m_local_size = {1, 1, 1};
+
+        vk::Pipeline m_pipeline;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,181 @@
+#include "descriptors.hpp"
+
+#include "display_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neuron::render {
+    DescriptorAllocator::DescriptorAllocator(const std::shared_ptr<Context> &context, const DescriptorAllocatorSettings &settings)
+        : m_context(context), m_settings(settings), m_sets_per_pool(settings.initial_sets_per_pool) {
+        if (m_settings.update_after_bind && !m_context->descriptor_indexing_enabled()) {
+            throw std::runtime_error("Update-after-bind descriptor pools require descriptor indexing");
+        }
+    }
+
+    DescriptorAllocator::~DescriptorAllocator() {
+        for (const auto &pool : m_ready_pools) {
+            m_context->device().destroy(pool);
+        }
+
+        for (const auto &pool : m_full_pools) {
+            m_context->device().destroy(pool);
+        }
+    }
+
+    vk::DescriptorSet DescriptorAllocator::allocate(const std::shared_ptr<DescriptorSetLayout> &layout) {
+        if (layout->update_after_bind() && !m_settings.update_after_bind) {
+            throw std::runtime_error("Descriptor set layout is update-after-bind but the allocator's pools are not");
+        }
+
+        return allocate(layout->set_layout());
+    }
+
+    vk::DescriptorSet DescriptorAllocator::allocate(vk::DescriptorSetLayout layout) {
+        if (!m_current_pool) {
+            m_current_pool = acquire_pool();
+        }
+
+        vk::DescriptorSetAllocateInfo alloc_info{m_current_pool, layout};
+        vk::DescriptorSet             set;
+
+        // non-throwing overload, running out of pool space is the expected way to find out we need to grow
+        vk::Result result = m_context->device().allocateDescriptorSets(&alloc_info, &set);
+        if (result == vk::Result::eErrorOutOfPoolMemory || result == vk::Result::eErrorFragmentedPool) {
+            m_full_pools.push_back(m_current_pool);
+            m_current_pool = acquire_pool();
+
+            alloc_info.descriptorPool = m_current_pool;
+            result                    = m_context->device().allocateDescriptorSets(&alloc_info, &set);
+        }
+
+        if (result != vk::Result::eSuccess) {
+            throw std::runtime_error("Failed to allocate descriptor set");
+        }
+
+        return set;
+    }
+
+    void DescriptorAllocator::reset() {
+        for (const auto &pool : m_full_pools) {
+            m_context->device().resetDescriptorPool(pool);
+            m_ready_pools.push_back(pool);
+        }
+        m_full_pools.clear();
+
+        if (m_current_pool) {
+            m_context->device().resetDescriptorPool(m_current_pool);
+            m_ready_pools.push_back(m_current_pool);
+            m_current_pool = VK_NULL_HANDLE;
+        }
+    }
+
+    vk::DescriptorPool DescriptorAllocator::acquire_pool() {
+        if (!m_ready_pools.empty()) {
+            vk::DescriptorPool pool = m_ready_pools.back();
+            m_ready_pools.pop_back();
+            return pool;
+        }
+
+        vk::DescriptorPool pool = create_pool(m_sets_per_pool);
+        m_sets_per_pool = std::min(static_cast<uint32_t>(static_cast<float>(m_sets_per_pool) * m_settings.growth_factor), m_settings.max_sets_per_pool);
+        return pool;
+    }
+
+    vk::DescriptorPool DescriptorAllocator::create_pool(uint32_t set_count) const {
+        std::vector<vk::DescriptorPoolSize> pool_sizes;
+        pool_sizes.reserve(m_settings.ratios.size());
+        for (const auto &ratio : m_settings.ratios) {
+            pool_sizes.emplace_back(ratio.type, std::max(1U, static_cast<uint32_t>(std::ceil(ratio.ratio * static_cast<float>(set_count)))));
+        }
+
+        vk::DescriptorPoolCreateFlags flags{};
+        if (m_settings.update_after_bind) {
+            flags |= vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+        }
+
+        return m_context->device().createDescriptorPool(vk::DescriptorPoolCreateInfo{flags, set_count, pool_sizes});
+    }
+
+    FrameDescriptorAllocator::FrameDescriptorAllocator(const std::shared_ptr<Context> &context, const DescriptorAllocatorSettings &settings) {
+        m_allocators.reserve(DisplaySystem::MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < DisplaySystem::MAX_FRAMES_IN_FLIGHT; i++) {
+            m_allocators.push_back(std::make_unique<DescriptorAllocator>(context, settings));
+        }
+    }
+
+    void FrameDescriptorAllocator::begin_frame(uint32_t frame_index) {
+        m_current_frame = frame_index % static_cast<uint32_t>(m_allocators.size());
+        m_allocators[m_current_frame]->reset();
+    }
+
+    vk::DescriptorSet FrameDescriptorAllocator::allocate(const std::shared_ptr<DescriptorSetLayout> &layout) {
+        return m_allocators[m_current_frame]->allocate(layout);
+    }
+
+    static size_t descriptor_info_size(vk::DescriptorType type) {
+        switch (type) {
+        case vk::DescriptorType::eSampler:
+        case vk::DescriptorType::eCombinedImageSampler:
+        case vk::DescriptorType::eSampledImage:
+        case vk::DescriptorType::eStorageImage:
+        case vk::DescriptorType::eInputAttachment:
+            return sizeof(vk::DescriptorImageInfo);
+        case vk::DescriptorType::eUniformTexelBuffer:
+        case vk::DescriptorType::eStorageTexelBuffer:
+            return sizeof(vk::BufferView);
+        case vk::DescriptorType::eUniformBuffer:
+        case vk::DescriptorType::eStorageBuffer:
+        case vk::DescriptorType::eUniformBufferDynamic:
+        case vk::DescriptorType::eStorageBufferDynamic:
+            return sizeof(vk::DescriptorBufferInfo);
+        default:
+            throw std::runtime_error("Descriptor type not supported by update templates");
+        }
+    }
+
+    DescriptorUpdateTemplate::DescriptorUpdateTemplate(const std::shared_ptr<Context> &context, const std::shared_ptr<DescriptorSetLayout> &layout)
+        : m_context(context), m_layout(layout) {
+        std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+        entries.reserve(layout->bindings().size());
+
+        size_t offset = 0;
+        for (const auto &binding : layout->bindings()) {
+            const size_t stride = descriptor_info_size(binding.descriptorType);
+            entries.emplace_back(binding.binding, 0, binding.descriptorCount, binding.descriptorType, offset, stride);
+            offset += stride * binding.descriptorCount;
+        }
+
+        create(entries);
+    }
+
+    DescriptorUpdateTemplate::DescriptorUpdateTemplate(const std::shared_ptr<Context> &context, const std::shared_ptr<DescriptorSetLayout> &layout,
+                                                       const std::vector<vk::DescriptorUpdateTemplateEntry> &entries)
+        : m_context(context), m_layout(layout) {
+        create(entries);
+    }
+
+    DescriptorUpdateTemplate::~DescriptorUpdateTemplate() {
+        m_context->device().destroy(m_update_template);
+    }
+
+    void DescriptorUpdateTemplate::update(vk::DescriptorSet set, const void *data) const {
+        m_context->device().updateDescriptorSetWithTemplate(set, m_update_template, data);
+    }
+
+    void DescriptorUpdateTemplate::create(const std::vector<vk::DescriptorUpdateTemplateEntry> &entries) {
+        m_data_size = 0;
+        for (const auto &entry : entries) {
+            if (entry.descriptorCount > 0) {
+                m_data_size = std::max(m_data_size, entry.offset + entry.stride * (entry.descriptorCount - 1) + descriptor_info_size(entry.descriptorType));
+            }
+        }
+
+        vk::DescriptorUpdateTemplateCreateInfo create_info{};
+        create_info.setDescriptorUpdateEntries(entries);
+        create_info.setTemplateType(vk::DescriptorUpdateTemplateType::eDescriptorSet);
+        create_info.setDescriptorSetLayout(m_layout->set_layout());
+
+        m_update_template = m_context->device().createDescriptorUpdateTemplate(create_info);
+    }
+} // namespace neuron::render
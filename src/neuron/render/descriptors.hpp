@@ -0,0 +1,115 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "pipeline_layout.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace neuron::render {
+
+    struct DescriptorPoolRatio {
+        vk::DescriptorType type;
+        float              ratio;
+    };
+
+    struct DescriptorAllocatorSettings {
+        uint32_t initial_sets_per_pool = 64;
+        uint32_t max_sets_per_pool     = 4096;
+        float    growth_factor         = 1.5f;
+
+        // Creates the pools with eUpdateAfterBind, needed to allocate sets whose layout has eUpdateAfterBindPool. Such
+        // pools count against the much smaller update-after-bind limits, so only set it for allocators serving those layouts.
+        // Requires descriptor indexing.
+        bool update_after_bind = false;
+
+        std::vector<DescriptorPoolRatio> ratios = {
+            {vk::DescriptorType::eUniformBuffer, 2.0f},        {vk::DescriptorType::eStorageBuffer, 2.0f}, {vk::DescriptorType::eCombinedImageSampler, 4.0f},
+            {vk::DescriptorType::eSampledImage, 2.0f},         {vk::DescriptorType::eSampler, 1.0f},       {vk::DescriptorType::eStorageImage, 1.0f},
+            {vk::DescriptorType::eUniformBufferDynamic, 1.0f}, {vk::DescriptorType::eStorageBufferDynamic, 1.0f},
+        };
+    };
+
+    // Growable descriptor allocator. Pools are created on demand and never freed individually, reset() returns every
+    // set at once and keeps the pools around so steady-state allocation never calls vkCreateDescriptorPool.
+    // Not thread-safe, use one per recording thread.
+    class NEURON_API DescriptorAllocator {
+      public:
+        explicit DescriptorAllocator(const std::shared_ptr<Context> &context, const DescriptorAllocatorSettings &settings = {});
+        ~DescriptorAllocator();
+
+        DescriptorAllocator(const DescriptorAllocator &other)            = delete;
+        DescriptorAllocator &operator=(const DescriptorAllocator &other) = delete;
+
+        [[nodiscard]] vk::DescriptorSet allocate(const std::shared_ptr<DescriptorSetLayout> &layout);
+        [[nodiscard]] vk::DescriptorSet allocate(vk::DescriptorSetLayout layout);
+
+        void reset();
+
+        [[nodiscard]] inline size_t pool_count() const { return m_ready_pools.size() + m_full_pools.size(); }
+
+      private:
+        [[nodiscard]] vk::DescriptorPool acquire_pool();
+        [[nodiscard]] vk::DescriptorPool create_pool(uint32_t set_count) const;
+
+        std::shared_ptr<Context>    m_context;
+        DescriptorAllocatorSettings m_settings;
+
+        std::vector<vk::DescriptorPool> m_ready_pools;
+        std::vector<vk::DescriptorPool> m_full_pools;
+        vk::DescriptorPool              m_current_pool = VK_NULL_HANDLE;
+        uint32_t                        m_sets_per_pool;
+    };
+
+    // One DescriptorAllocator per frame in flight. begin_frame resets the slot's pools in bulk, call it after the frame's
+    // fence has been waited on (DisplaySystem::acquire_next_frame does this).
+    class NEURON_API FrameDescriptorAllocator {
+      public:
+        explicit FrameDescriptorAllocator(const std::shared_ptr<Context> &context, const DescriptorAllocatorSettings &settings = {});
+
+        void begin_frame(uint32_t frame_index);
+
+        [[nodiscard]] vk::DescriptorSet allocate(const std::shared_ptr<DescriptorSetLayout> &layout);
+
+        [[nodiscard]] inline DescriptorAllocator &current() { return *m_allocators[m_current_frame]; }
+
+      private:
+        std::vector<std::unique_ptr<DescriptorAllocator>> m_allocators;
+        uint32_t                                          m_current_frame = 0;
+    };
+
+    // Writes a whole descriptor set from one packed struct in a single call.
+    // The default entries lay out every binding of the layout in binding order: each descriptor takes one
+    // vk::DescriptorImageInfo, vk::DescriptorBufferInfo or vk::BufferView depending on its type, tightly packed.
+    class NEURON_API DescriptorUpdateTemplate {
+      public:
+        DescriptorUpdateTemplate(const std::shared_ptr<Context> &context, const std::shared_ptr<DescriptorSetLayout> &layout);
+        DescriptorUpdateTemplate(const std::shared_ptr<Context> &context, const std::shared_ptr<DescriptorSetLayout> &layout,
+                                 const std::vector<vk::DescriptorUpdateTemplateEntry> &entries);
+        ~DescriptorUpdateTemplate();
+
+        DescriptorUpdateTemplate(const DescriptorUpdateTemplate &other)            = delete;
+        DescriptorUpdateTemplate &operator=(const DescriptorUpdateTemplate &other) = delete;
+
+        void update(vk::DescriptorSet set, const void *data) const;
+
+        template <typename T>
+        inline void update(vk::DescriptorSet set, const T &data) const {
+            update(set, static_cast<const void *>(&data));
+        }
+
+        [[nodiscard]] inline vk::DescriptorUpdateTemplate update_template() const { return m_update_template; }
+
+        [[nodiscard]] inline size_t data_size() const { return m_data_size; }
+
+      private:
+        void create(const std::vector<vk::DescriptorUpdateTemplateEntry> &entries);
+
+        std::shared_ptr<Context>             m_context;
+        std::shared_ptr<DescriptorSetLayout> m_layout;
+        vk::DescriptorUpdateTemplate         m_update_template;
+        size_t                               m_data_size = 0;
+    };
+
+} // namespace neuron::render
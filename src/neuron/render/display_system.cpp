@@ -4,6 +4,8 @@
 
 #include "display_system.hpp"
 
+#include "submission_scheduler.hpp"
+
 #include <iostream>
 #include <limits>
 
@@ -129,11 +131,11 @@ namespace neuron::render {
         return m_swapchain;
     }
 
-    SwapchainConfiguration DisplaySystem::swapchain_config() const {
+    const SwapchainConfiguration &DisplaySystem::swapchain_config() const {
         return m_swapchain_config;
     }
 
-    DisplayTargetConfiguration DisplaySystem::display_target_config() const {
+    const DisplayTargetConfiguration &DisplaySystem::display_target_config() const {
         return m_display_target_config;
     }
 
@@ -215,7 +217,7 @@ namespace neuron::render {
             try {
                 auto res = m_context->device().acquireNextImageKHR(m_swapchain, UINT64_MAX, m_image_available_semaphores[m_current_frame], VK_NULL_HANDLE);
                 if (res.result == vk::Result::eErrorOutOfDateKHR || res.result == vk::Result::eSuboptimalKHR) {
-                    m_context->device().waitIdle();
+                    m_context->wait_idle();
                     build_swapchain();
                     continue;
                 }
@@ -224,7 +226,7 @@ namespace neuron::render {
 
                 acquired = true;
             } catch (vk::OutOfDateKHRError &e) {
-                m_context->device().waitIdle();
+                m_context->wait_idle();
                 build_swapchain();
             }
         } while (!acquired);
@@ -248,13 +250,14 @@ namespace neuron::render {
         present_info.setWaitSemaphores(m_frame_info.render_finished);
 
         try {
-            vk::Result result = m_context->main_queue().presentKHR(present_info);
+            vk::Result result = m_context->main_scheduler()->present(present_info);
+            m_context->mark_first_frame();
             if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
-                m_context->device().waitIdle();
+                m_context->wait_idle();
                 build_swapchain();
             }
         } catch (vk::OutOfDateKHRError &e) {
-            m_context->device().waitIdle();
+            m_context->wait_idle();
             build_swapchain();
         }
 
@@ -58,11 +58,12 @@ namespace neuron::render {
 
         void set_extent_provider(const std::shared_ptr<intfc::ExtentProvider> &extent_provider);
 
-        [[nodiscard]] vk::SwapchainKHR           swapchain() const;
-        [[nodiscard]] SwapchainConfiguration     swapchain_config() const;
-        [[nodiscard]] DisplayTargetConfiguration display_target_config() const;
-        [[nodiscard]] uint32_t                   current_frame() const;
-        [[nodiscard]] uint32_t                   current_image_index() const;
+        // References stay valid until the next build_swapchain(), which acquire_next_frame() and present_frame() may call.
+        [[nodiscard]] vk::SwapchainKHR                  swapchain() const;
+        [[nodiscard]] const SwapchainConfiguration     &swapchain_config() const;
+        [[nodiscard]] const DisplayTargetConfiguration &display_target_config() const;
+        [[nodiscard]] uint32_t                          current_frame() const;
+        [[nodiscard]] uint32_t                          current_image_index() const;
 
         void build_swapchain();
 
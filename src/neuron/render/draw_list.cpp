@@ -0,0 +1,238 @@
+#include "draw_list.hpp"
+
+#include "neuron/jobs/job_system.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace neuron::render {
+    static constexpr size_t PARALLEL_SORT_THRESHOLD = 16384;
+
+    template <typename F>
+    static void run_workers(uint32_t worker_count, const F &f) {
+        jobs::JobSystem::global()->parallel_for(0, worker_count, 1, [&f](size_t begin, size_t end) {
+            for (size_t w = begin; w < end; w++) {
+                f(static_cast<uint32_t>(w));
+            }
+        });
+    }
+
+    void DrawList::reset() {
+        m_packets.clear();
+        m_entries.clear();
+        m_push_data.clear();
+
+        // ids only order draws within one list; kept across lists they would outgrow their key fields
+        m_pipeline_ids.clear();
+        m_descriptor_ids.clear();
+        m_vertex_ids.clear();
+    }
+
+    uint32_t DrawList::intern(std::unordered_map<uint64_t, uint32_t> &ids, uint64_t handle, uint32_t bits) {
+        auto [it, inserted] = ids.try_emplace(handle, static_cast<uint32_t>(ids.size()));
+        if (inserted && it->second >= (1U << bits)) {
+            ids.erase(it);
+            throw std::runtime_error("Draw list has more distinct pipelines, descriptor sets or vertex buffers than its sort key can hold");
+        }
+        return it->second;
+    }
+
+    void DrawList::submit(const DrawPacket &packet, std::span<const std::byte> push_constants) {
+        size_t descriptor_handle = handle_bits(packet.layout);
+        hash_combine(descriptor_handle, handle_bits(packet.descriptor_set));
+
+        const uint32_t pipeline_id   = intern(m_pipeline_ids, handle_bits(packet.pipeline), DrawKey::PIPELINE_BITS);
+        const uint32_t descriptor_id = intern(m_descriptor_ids, descriptor_handle, DrawKey::DESCRIPTOR_BITS);
+        const uint32_t vertex_id     = intern(m_vertex_ids, handle_bits(packet.vertex_buffer), DrawKey::VERTEX_BITS);
+
+        const auto push_offset = static_cast<uint32_t>(m_push_data.size());
+        m_push_data.insert(m_push_data.end(), push_constants.begin(), push_constants.end());
+
+        constexpr uint32_t max_depth = (1U << DrawKey::DEPTH_BITS) - 1;
+        auto               depth     = static_cast<uint32_t>(std::clamp(packet.depth, 0.0f, 1.0f) * static_cast<float>(max_depth));
+        if (packet.back_to_front) {
+            depth = max_depth - depth;
+        }
+
+        m_entries.push_back(SortEntry{DrawKey::pack(packet.layer, pipeline_id, descriptor_id, vertex_id, depth), static_cast<uint32_t>(m_packets.size())});
+        m_packets.push_back(StoredPacket{packet, push_offset, static_cast<uint32_t>(push_constants.size())});
+    }
+
+    void DrawList::sort(uint32_t worker_count) {
+        const size_t n = m_entries.size();
+        if (n < 2) {
+            return;
+        }
+
+        if (worker_count == 0) {
+            worker_count = n >= PARALLEL_SORT_THRESHOLD ? jobs::JobSystem::global()->worker_count() + 1 : 1U;
+        }
+        worker_count = static_cast<uint32_t>(std::min<size_t>(worker_count, n));
+
+        m_scratch.resize(n);
+
+        if (m_histograms.size() < worker_count) {
+            m_histograms.resize(worker_count);
+        }
+        const std::span histograms(m_histograms.data(), worker_count);
+
+        SortEntry *src = m_entries.data();
+        SortEntry *dst = m_scratch.data();
+
+        auto chunk_begin = [&](uint32_t w) { return n * w / worker_count; };
+
+        for (uint32_t pass = 0; pass < 8; pass++) {
+            const uint32_t shift = pass * 8;
+
+            run_workers(worker_count, [&](uint32_t w) {
+                auto &histogram = histograms[w];
+                histogram.fill(0);
+                for (size_t i = chunk_begin(w); i < chunk_begin(w + 1); i++) {
+                    histogram[(src[i].key >> shift) & 0xFF]++;
+                }
+            });
+
+            // every key shares this byte, nothing to reorder
+            bool trivial = false;
+            for (uint32_t bucket = 0; bucket < 256 && !trivial; bucket++) {
+                size_t total = 0;
+                for (const auto &histogram : histograms) {
+                    total += histogram[bucket];
+                }
+                trivial = total == n;
+            }
+
+            if (trivial) {
+                continue;
+            }
+
+            size_t running = 0;
+            for (uint32_t bucket = 0; bucket < 256; bucket++) {
+                for (auto &histogram : histograms) {
+                    const size_t count = histogram[bucket];
+                    histogram[bucket]  = running;
+                    running += count;
+                }
+            }
+
+            run_workers(worker_count, [&](uint32_t w) {
+                auto &offsets = histograms[w];
+                for (size_t i = chunk_begin(w); i < chunk_begin(w + 1); i++) {
+                    dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+                }
+            });
+
+            std::swap(src, dst);
+        }
+
+        if (src != m_entries.data()) {
+            std::copy(src, src + n, m_entries.data());
+        }
+    }
+
+    bool DrawList::can_merge(const StoredPacket &a, const StoredPacket &b) const {
+        const DrawPacket &pa = a.packet;
+        const DrawPacket &pb = b.packet;
+
+        return pa.pipeline == pb.pipeline && pa.layout == pb.layout && pa.descriptor_set == pb.descriptor_set && pa.descriptor_set_index == pb.descriptor_set_index &&
+            pa.vertex_buffer == pb.vertex_buffer && pa.vertex_buffer_offset == pb.vertex_buffer_offset && pa.index_buffer == pb.index_buffer &&
+            pa.index_buffer_offset == pb.index_buffer_offset && pa.index_type == pb.index_type && pa.count == pb.count && pa.first == pb.first &&
+            pa.vertex_offset == pb.vertex_offset && pb.first_instance == pa.first_instance + pa.instance_count && pa.push_constant_stages == pb.push_constant_stages &&
+            pa.push_constant_offset == pb.push_constant_offset && a.push_data_size == b.push_data_size &&
+            std::memcmp(m_push_data.data() + a.push_data_offset, m_push_data.data() + b.push_data_offset, a.push_data_size) == 0;
+    }
+
+    DrawListStats DrawList::record(const vk::CommandBuffer &cmd) const {
+        DrawListStats stats{};
+        stats.packets = static_cast<uint32_t>(m_entries.size());
+
+        vk::Pipeline       bound_pipeline;
+        vk::PipelineLayout bound_layout;
+        vk::DescriptorSet  bound_set;
+        uint32_t           bound_set_index = 0;
+        vk::Buffer         bound_vertex_buffer;
+        vk::DeviceSize     bound_vertex_offset = 0;
+        vk::Buffer         bound_index_buffer;
+        vk::DeviceSize     bound_index_offset = 0;
+        vk::IndexType      bound_index_type   = vk::IndexType::eUint32;
+        const StoredPacket *last_push         = nullptr;
+
+        size_t i = 0;
+        while (i < m_entries.size()) {
+            const StoredPacket &stored = m_packets[m_entries[i].index];
+            const DrawPacket   &p      = stored.packet;
+
+            uint32_t instance_count = p.instance_count;
+
+            size_t j = i + 1;
+            if (auto_instancing) {
+                const StoredPacket *previous = &stored;
+                while (j < m_entries.size() && can_merge(*previous, m_packets[m_entries[j].index])) {
+                    previous = &m_packets[m_entries[j].index];
+                    instance_count += previous->packet.instance_count;
+                    j++;
+                }
+            }
+
+            if (p.pipeline != bound_pipeline) {
+                cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, p.pipeline);
+                bound_pipeline = p.pipeline;
+                stats.pipeline_binds++;
+            }
+
+            // a different layout may disturb every set and push constant, so rebind both
+            if (p.layout != bound_layout) {
+                bound_layout = p.layout;
+                bound_set    = VK_NULL_HANDLE;
+                last_push    = nullptr;
+            }
+
+            if (p.descriptor_set && (p.descriptor_set != bound_set || p.descriptor_set_index != bound_set_index)) {
+                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, p.layout, p.descriptor_set_index, p.descriptor_set, {});
+                bound_set       = p.descriptor_set;
+                bound_set_index = p.descriptor_set_index;
+                stats.descriptor_set_binds++;
+            }
+
+            if (p.vertex_buffer && (p.vertex_buffer != bound_vertex_buffer || p.vertex_buffer_offset != bound_vertex_offset)) {
+                cmd.bindVertexBuffers(0, p.vertex_buffer, p.vertex_buffer_offset);
+                bound_vertex_buffer = p.vertex_buffer;
+                bound_vertex_offset = p.vertex_buffer_offset;
+                stats.vertex_buffer_binds++;
+            }
+
+            if (p.index_buffer && (p.index_buffer != bound_index_buffer || p.index_buffer_offset != bound_index_offset || p.index_type != bound_index_type)) {
+                cmd.bindIndexBuffer(p.index_buffer, p.index_buffer_offset, p.index_type);
+                bound_index_buffer = p.index_buffer;
+                bound_index_offset = p.index_buffer_offset;
+                bound_index_type   = p.index_type;
+                stats.index_buffer_binds++;
+            }
+
+            if (stored.push_data_size > 0) {
+                const bool same = last_push && last_push->push_data_size == stored.push_data_size &&
+                    last_push->packet.push_constant_offset == p.push_constant_offset && last_push->packet.push_constant_stages == p.push_constant_stages &&
+                    std::memcmp(m_push_data.data() + last_push->push_data_offset, m_push_data.data() + stored.push_data_offset, stored.push_data_size) == 0;
+
+                if (!same) {
+                    cmd.pushConstants(p.layout, p.push_constant_stages, p.push_constant_offset, stored.push_data_size, m_push_data.data() + stored.push_data_offset);
+                    last_push = &stored;
+                    stats.push_constant_updates++;
+                }
+            }
+
+            if (p.index_buffer) {
+                cmd.drawIndexed(p.count, instance_count, p.first, p.vertex_offset, p.first_instance);
+            } else {
+                cmd.draw(p.count, instance_count, p.first, p.first_instance);
+            }
+            stats.draws++;
+
+            i = j;
+        }
+
+        return stats;
+    }
+} // namespace neuron::render
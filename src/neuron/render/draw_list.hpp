@@ -0,0 +1,134 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "graphics_pipeline.hpp"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace neuron::render {
+
+    // 64-bit sort key, most significant first: layer | pipeline | layout & descriptor set | vertex buffer | depth.
+    struct DrawKey {
+        static constexpr uint32_t LAYER_BITS      = 4;
+        static constexpr uint32_t PIPELINE_BITS   = 12;
+        static constexpr uint32_t DESCRIPTOR_BITS = 12;
+        static constexpr uint32_t VERTEX_BITS     = 12;
+        static constexpr uint32_t DEPTH_BITS      = 24;
+
+        static_assert(LAYER_BITS + PIPELINE_BITS + DESCRIPTOR_BITS + VERTEX_BITS + DEPTH_BITS == 64);
+
+        [[nodiscard]] static constexpr uint64_t pack(uint32_t layer, uint32_t pipeline, uint32_t descriptor, uint32_t vertex, uint32_t depth) {
+            constexpr auto mask = [](uint32_t bits) { return (1ULL << bits) - 1; };
+
+            uint64_t key = layer & mask(LAYER_BITS);
+            key          = (key << PIPELINE_BITS) | (pipeline & mask(PIPELINE_BITS));
+            key          = (key << DESCRIPTOR_BITS) | (descriptor & mask(DESCRIPTOR_BITS));
+            key          = (key << VERTEX_BITS) | (vertex & mask(VERTEX_BITS));
+            key          = (key << DEPTH_BITS) | (depth & mask(DEPTH_BITS));
+            return key;
+        }
+    };
+
+    struct DrawPacket {
+        uint32_t layer         = 0;
+        float    depth         = 0.0f; // normalized view depth in [0, 1]
+        bool     back_to_front = false;
+
+        vk::Pipeline       pipeline;
+        vk::PipelineLayout layout;
+
+        vk::DescriptorSet descriptor_set       = VK_NULL_HANDLE;
+        uint32_t          descriptor_set_index = 0;
+
+        vk::Buffer     vertex_buffer        = VK_NULL_HANDLE;
+        vk::DeviceSize vertex_buffer_offset = 0;
+        vk::Buffer     index_buffer         = VK_NULL_HANDLE; // null means non-indexed draw
+        vk::DeviceSize index_buffer_offset  = 0;
+        vk::IndexType  index_type           = vk::IndexType::eUint32;
+
+        uint32_t count          = 0; // index count, or vertex count for non-indexed draws
+        uint32_t instance_count = 1;
+        uint32_t first          = 0; // first index, or first vertex
+        int32_t  vertex_offset  = 0;
+        uint32_t first_instance = 0;
+
+        vk::ShaderStageFlags push_constant_stages;
+        uint32_t             push_constant_offset = 0;
+
+        inline DrawPacket &set_pipeline(const GraphicsPipeline &graphics_pipeline) {
+            pipeline = graphics_pipeline.pipeline();
+            layout   = graphics_pipeline.layout()->pipeline_layout();
+            return *this;
+        }
+    };
+
+    struct DrawListStats {
+        uint32_t packets               = 0;
+        uint32_t draws                 = 0;
+        uint32_t pipeline_binds        = 0;
+        uint32_t descriptor_set_binds  = 0;
+        uint32_t vertex_buffer_binds   = 0;
+        uint32_t index_buffer_binds    = 0;
+        uint32_t push_constant_updates = 0;
+    };
+
+    // Collects draw packets, sorts them by a packed 64-bit key and records them with redundant binds removed.
+    // Consecutive packets that only differ by a contiguous first_instance are merged into one instanced draw.
+    // Not thread-safe; use one list per producing thread.
+    class NEURON_API DrawList {
+      public:
+        // Clears the packets and the handle ids used for the sort keys, keeping the packet storage.
+        void reset();
+
+        // Throws once the list holds more distinct pipelines, descriptor sets or vertex buffers than the DrawKey fields.
+        void submit(const DrawPacket &packet, std::span<const std::byte> push_constants = {});
+
+        template <typename T>
+        inline void submit(const DrawPacket &packet, const T &push_constants) {
+            submit(packet, std::as_bytes(std::span<const T, 1>(&push_constants, 1)));
+        }
+
+        // LSD radix sort over the keys, split into worker_count parts run on the global job system (0 picks automatically).
+        void sort(uint32_t worker_count = 0);
+
+        DrawListStats record(const vk::CommandBuffer &cmd) const;
+
+        [[nodiscard]] inline size_t size() const { return m_packets.size(); }
+
+        bool auto_instancing = true;
+
+      private:
+        struct SortEntry {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        struct StoredPacket {
+            DrawPacket packet;
+            uint32_t   push_data_offset;
+            uint32_t   push_data_size;
+        };
+
+        [[nodiscard]] uint32_t intern(std::unordered_map<uint64_t, uint32_t> &ids, uint64_t handle, uint32_t bits);
+
+        [[nodiscard]] bool can_merge(const StoredPacket &a, const StoredPacket &b) const;
+
+        std::vector<StoredPacket> m_packets;
+        std::vector<SortEntry>    m_entries;
+        std::vector<SortEntry>    m_scratch;
+        std::vector<std::byte>    m_push_data;
+
+        // one per sort worker, kept between sorts like m_scratch
+        std::vector<std::array<size_t, 256>> m_histograms;
+
+        std::unordered_map<uint64_t, uint32_t> m_pipeline_ids;
+        std::unordered_map<uint64_t, uint32_t> m_descriptor_ids;
+        std::unordered_map<uint64_t, uint32_t> m_vertex_ids;
+    };
+
+} // namespace neuron::render
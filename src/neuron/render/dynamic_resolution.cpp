@@ -0,0 +1,144 @@
+#include "dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace neuron::render {
+    DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings &settings)
+        : m_settings(settings), m_scale(std::clamp(settings.initial_scale, settings.min_scale, settings.max_scale)) {}
+
+    float DynamicResolutionController::update(double gpu_frame_ms) {
+        if (gpu_frame_ms <= 0.0) {
+            return m_scale;
+        }
+
+        // GPU time grows with the pixel count, the square of the scale, so this is how far off the scale that would have
+        // met the budget was: positive while under budget
+        const double error  = std::sqrt(m_settings.target_frame_ms / gpu_frame_ms) - 1.0;
+        const double change = m_has_error ? error - m_last_error : 0.0;
+
+        m_last_error = error;
+        m_has_error  = true;
+
+        const double scale = m_scale * (1.0 + m_settings.proportional_gain * change + m_settings.integral_gain * error);
+        m_scale            = std::clamp(static_cast<float>(scale), m_settings.min_scale, m_settings.max_scale);
+        return m_scale;
+    }
+
+    void DynamicResolutionController::reset() {
+        m_scale      = std::clamp(m_settings.initial_scale, m_settings.min_scale, m_settings.max_scale);
+        m_last_error = 0.0;
+        m_has_error  = false;
+    }
+
+    DynamicResolutionRenderer::DynamicResolutionRenderer(const std::shared_ptr<Context> &context, const DynamicResolutionSettings &settings)
+        : m_context(context), m_settings(settings), m_controller(settings), m_timer(GpuFrameTimer::create(context)) {}
+
+    std::shared_ptr<DynamicResolutionRenderer> DynamicResolutionRenderer::create(const std::shared_ptr<Context> &context, const DynamicResolutionSettings &settings) {
+        return std::shared_ptr<DynamicResolutionRenderer>(new DynamicResolutionRenderer(context, settings));
+    }
+
+    void DynamicResolutionRenderer::allocate(vk::Extent2D output_extent) {
+        // frames in flight may still render into the old target
+        if (m_color) {
+            m_context->wait_idle();
+        }
+
+        const vk::Extent2D extent{std::max(1U, static_cast<uint32_t>(std::ceil(static_cast<float>(output_extent.width) * m_settings.max_scale))),
+                                  std::max(1U, static_cast<uint32_t>(std::ceil(static_cast<float>(output_extent.height) * m_settings.max_scale)))};
+
+        m_output_extent = output_extent;
+        m_color         = AttachmentImage::create(m_context, {.format = m_settings.color_format, .extent = extent, .usage = vk::ImageUsageFlagBits::eTransferSrc});
+
+        RenderAttachment color = m_color->attachment(vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::ClearColorValue{0.0f, 0.0f, 0.0f, 1.0f});
+        color.final_layout     = vk::ImageLayout::eTransferSrcOptimal;
+
+        m_frame.pass = RenderPassDescription{};
+        m_frame.pass.add_color_attachment(color);
+
+        if (m_settings.depth_format != vk::Format::eUndefined) {
+            m_depth = AttachmentImage::create(m_context, {.format = m_settings.depth_format, .extent = extent, .transient = true});
+
+            const auto depth = m_depth->attachment(vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare, vk::ClearDepthStencilValue{1.0f, 0});
+            if (m_depth->aspect() & vk::ImageAspectFlagBits::eStencil) {
+                m_frame.pass.set_depth_stencil_attachment(depth, vk::AttachmentLoadOp::eClear);
+            } else {
+                m_frame.pass.set_depth_attachment(depth);
+            }
+        }
+    }
+
+    const DynamicResolutionFrame &DynamicResolutionRenderer::begin_frame(const vk::CommandBuffer &cmd, uint32_t frame_index, vk::Extent2D output_extent) {
+        if (!m_color || output_extent != m_output_extent) {
+            allocate(output_extent);
+        }
+
+        // this slot's frame has been waited on before its command buffer could be reused
+        if (const auto gpu_ms = m_timer->take_ms(frame_index)) {
+            m_last_gpu_ms = *gpu_ms;
+            m_controller.update(*gpu_ms);
+        }
+
+        const float        scale    = m_controller.scale();
+        const vk::Extent2D capacity = m_color->info().extent;
+        const vk::Extent2D extent{std::clamp(static_cast<uint32_t>(std::lround(static_cast<float>(output_extent.width) * scale)), 1U, capacity.width),
+                                  std::clamp(static_cast<uint32_t>(std::lround(static_cast<float>(output_extent.height) * scale)), 1U, capacity.height)};
+
+        m_frame.scale            = scale;
+        m_frame.render_area      = vk::Rect2D{{0, 0}, extent};
+        m_frame.pass.render_area = m_frame.render_area;
+
+        m_timer->begin(cmd, frame_index);
+        return m_frame;
+    }
+
+    void DynamicResolutionRenderer::end_frame(const vk::CommandBuffer &cmd, uint32_t frame_index, vk::Image output, vk::ImageLayout output_layout) {
+        const vk::ImageSubresourceRange isr = {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+
+        // the scene pass left the target in eTransferSrcOptimal
+        {
+            vk::ImageMemoryBarrier b{};
+            b.image            = output;
+            b.srcAccessMask    = vk::AccessFlagBits::eNone;
+            b.dstAccessMask    = vk::AccessFlagBits::eTransferWrite;
+            b.oldLayout        = vk::ImageLayout::eUndefined;
+            b.newLayout        = vk::ImageLayout::eTransferDstOptimal;
+            b.subresourceRange = isr;
+
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, b);
+        }
+
+        const vk::Extent2D src = m_frame.render_area.extent;
+
+        vk::ImageBlit blit{};
+        blit.srcSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+        blit.srcOffsets     = std::array<vk::Offset3D, 2>{vk::Offset3D{0, 0, 0}, vk::Offset3D{static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), 1}};
+        blit.dstSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+        blit.dstOffsets     = std::array<vk::Offset3D, 2>{
+            vk::Offset3D{0, 0, 0}, vk::Offset3D{static_cast<int32_t>(m_output_extent.width), static_cast<int32_t>(m_output_extent.height), 1}};
+
+        cmd.blitImage(m_color->image(), vk::ImageLayout::eTransferSrcOptimal, output, vk::ImageLayout::eTransferDstOptimal, blit, m_settings.upscale_filter);
+
+        // The target is shared by the frames in flight: the next scene pass has to wait for this blit to read it before
+        // clearing it, which its begin barrier only does when it knows the target comes from a transfer.
+        m_frame.pass.color_attachments[0].initial_layout = vk::ImageLayout::eTransferSrcOptimal;
+
+        if (output_layout != vk::ImageLayout::eTransferDstOptimal) {
+            const bool present = output_layout == vk::ImageLayout::ePresentSrcKHR;
+
+            vk::ImageMemoryBarrier b{};
+            b.image            = output;
+            b.srcAccessMask    = vk::AccessFlagBits::eTransferWrite;
+            b.dstAccessMask    = present ? vk::AccessFlagBits::eNone : vk::AccessFlagBits::eMemoryRead;
+            b.oldLayout        = vk::ImageLayout::eTransferDstOptimal;
+            b.newLayout        = output_layout;
+            b.subresourceRange = isr;
+
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, present ? vk::PipelineStageFlagBits::eBottomOfPipe : vk::PipelineStageFlagBits::eAllCommands, {}, {}, {},
+                                b);
+        }
+
+        m_timer->end(cmd, frame_index);
+    }
+} // namespace neuron::render
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "gpu_timer.hpp"
+#include "render_pass.hpp"
+
+#include <memory>
+
+namespace neuron::render {
+
+    struct DynamicResolutionSettings {
+        // GPU time per frame to stay under; leave headroom below the display interval.
+        double target_frame_ms = 14.0;
+
+        float min_scale     = 0.5f;
+        float max_scale     = 1.0f;
+        float initial_scale = 1.0f;
+
+        // On the relative scale error sqrt(target / measured) - 1. Measurements lag by the frames in flight, so higher
+        // gains overshoot rather than react faster.
+        float proportional_gain = 0.2f;
+        float integral_gain     = 0.3f;
+
+        vk::Format color_format   = vk::Format::eR8G8B8A8Unorm;
+        vk::Format depth_format   = vk::Format::eUndefined; // no depth attachment
+        vk::Filter upscale_filter = vk::Filter::eLinear;
+    };
+
+    // PI controller from measured GPU frame time to a resolution scale, per axis. Works on the change of the scale, so
+    // clamping it to [min_scale, max_scale] cannot wind up. Settles a steady load at the budget within about ten
+    // measurements.
+    class NEURON_API DynamicResolutionController {
+      public:
+        explicit DynamicResolutionController(const DynamicResolutionSettings &settings = {});
+
+        // Feed one measurement, returns the new scale.
+        float update(double gpu_frame_ms);
+        void  reset();
+
+        [[nodiscard]] inline float scale() const { return m_scale; }
+
+      private:
+        DynamicResolutionSettings m_settings;
+        float                     m_scale;
+        double                    m_last_error = 0.0;
+        bool                      m_has_error  = false;
+    };
+
+    struct DynamicResolutionFrame {
+        vk::Rect2D render_area;
+        float      scale;
+
+        // Render the scene with these: the color attachment ends the pass ready for the upscale, depth is transient.
+        RenderPassDescription pass;
+    };
+
+    // Renders the scene into an offscreen target at a fraction of the output resolution, picked per frame by a
+    // DynamicResolutionController from timestamp measurements, and upscales it into the output (swapchain) image with a
+    // blit. The target is allocated at max_scale, so the scale changing only changes the render area.
+    //
+    // Per frame: begin_frame(), render frame.pass, end_frame(). Without GPU timestamps the scale stays where the
+    // controller is; feed it yourself through controller().
+    class NEURON_API DynamicResolutionRenderer {
+        DynamicResolutionRenderer(const std::shared_ptr<Context> &context, const DynamicResolutionSettings &settings);
+
+      public:
+        static std::shared_ptr<DynamicResolutionRenderer> create(const std::shared_ptr<Context> &context, const DynamicResolutionSettings &settings = {});
+
+        DynamicResolutionRenderer(const DynamicResolutionRenderer &other)            = delete;
+        DynamicResolutionRenderer &operator=(const DynamicResolutionRenderer &other) = delete;
+
+        // Outside a render pass. frame_index is FrameInfo::current_frame. Reallocates the target (waiting for the device)
+        // when the output extent changed.
+        const DynamicResolutionFrame &begin_frame(const vk::CommandBuffer &cmd, uint32_t frame_index, vk::Extent2D output_extent);
+
+        // Upscales into the output image, which starts with undefined contents and ends in output_layout.
+        void end_frame(const vk::CommandBuffer &cmd, uint32_t frame_index, vk::Image output, vk::ImageLayout output_layout = vk::ImageLayout::ePresentSrcKHR);
+
+        [[nodiscard]] inline DynamicResolutionController  &controller() { return m_controller; }
+        [[nodiscard]] inline const DynamicResolutionFrame &frame() const { return m_frame; }
+        [[nodiscard]] inline double                        last_gpu_frame_ms() const { return m_last_gpu_ms; }
+
+      private:
+        void allocate(vk::Extent2D output_extent);
+
+        std::shared_ptr<Context>       m_context;
+        DynamicResolutionSettings      m_settings;
+        DynamicResolutionController    m_controller;
+        std::shared_ptr<GpuFrameTimer> m_timer;
+
+        vk::Extent2D                     m_output_extent;
+        std::shared_ptr<AttachmentImage> m_color;
+        std::shared_ptr<AttachmentImage> m_depth;
+
+        DynamicResolutionFrame m_frame;
+        double                 m_last_gpu_ms = 0.0;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,482 @@
+#include "dynamic_state.hpp"
+
+#include "graphics_pipeline.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace neuron::render {
+    namespace {
+        // everything the tracker caches, for forgetting what a pipeline bind overwrites
+        constexpr vk::DynamicState TRACKED_STATES[] = {
+            vk::DynamicState::eViewport,
+            vk::DynamicState::eScissor,
+            vk::DynamicState::eLineWidth,
+            vk::DynamicState::eDepthBias,
+            vk::DynamicState::eBlendConstants,
+            vk::DynamicState::eDepthBounds,
+            vk::DynamicState::eStencilCompareMask,
+            vk::DynamicState::eStencilWriteMask,
+            vk::DynamicState::eStencilReference,
+            vk::DynamicState::eCullModeEXT,
+            vk::DynamicState::eFrontFaceEXT,
+            vk::DynamicState::ePrimitiveTopologyEXT,
+            vk::DynamicState::eDepthTestEnableEXT,
+            vk::DynamicState::eDepthWriteEnableEXT,
+            vk::DynamicState::eDepthCompareOpEXT,
+            vk::DynamicState::eDepthBoundsTestEnableEXT,
+            vk::DynamicState::eStencilTestEnableEXT,
+            vk::DynamicState::eStencilOpEXT,
+            vk::DynamicState::eRasterizerDiscardEnableEXT,
+            vk::DynamicState::eDepthBiasEnableEXT,
+            vk::DynamicState::ePrimitiveRestartEnableEXT,
+            vk::DynamicState::ePolygonModeEXT,
+            vk::DynamicState::eDepthClampEnableEXT,
+            vk::DynamicState::eLogicOpEnableEXT,
+            vk::DynamicState::eColorBlendEnableEXT,
+            vk::DynamicState::eColorBlendEquationEXT,
+            vk::DynamicState::eColorWriteMaskEXT,
+            vk::DynamicState::eVertexInputEXT,
+        };
+    } // namespace
+
+    std::vector<vk::DynamicState> supported_dynamic_states(const Context &ctx) {
+        const EnabledFeatureSet &features = ctx.enabled_features();
+
+        std::vector<vk::DynamicState> states = {
+            vk::DynamicState::eLineWidth,          vk::DynamicState::eDepthBias,        vk::DynamicState::eBlendConstants,    vk::DynamicState::eDepthBounds,
+            vk::DynamicState::eStencilCompareMask, vk::DynamicState::eStencilWriteMask, vk::DynamicState::eStencilReference,
+        };
+
+        if (features.extended_dynamic_state) {
+            states.insert(states.end(), {
+                                            vk::DynamicState::eViewportWithCountEXT,
+                                            vk::DynamicState::eScissorWithCountEXT,
+                                            vk::DynamicState::eCullModeEXT,
+                                            vk::DynamicState::eFrontFaceEXT,
+                                            vk::DynamicState::ePrimitiveTopologyEXT,
+                                            vk::DynamicState::eDepthTestEnableEXT,
+                                            vk::DynamicState::eDepthWriteEnableEXT,
+                                            vk::DynamicState::eDepthCompareOpEXT,
+                                            vk::DynamicState::eDepthBoundsTestEnableEXT,
+                                            vk::DynamicState::eStencilTestEnableEXT,
+                                            vk::DynamicState::eStencilOpEXT,
+                                        });
+        } else {
+            states.insert(states.end(), {vk::DynamicState::eViewport, vk::DynamicState::eScissor});
+        }
+
+        if (features.extended_dynamic_state2) {
+            states.insert(states.end(), {vk::DynamicState::eRasterizerDiscardEnableEXT, vk::DynamicState::eDepthBiasEnableEXT, vk::DynamicState::ePrimitiveRestartEnableEXT});
+        }
+
+        if (features.extended_dynamic_state3) {
+            states.insert(states.end(), {
+                                            vk::DynamicState::ePolygonModeEXT,
+                                            vk::DynamicState::eDepthClampEnableEXT,
+                                            vk::DynamicState::eLogicOpEnableEXT,
+                                            vk::DynamicState::eColorBlendEnableEXT,
+                                            vk::DynamicState::eColorBlendEquationEXT,
+                                            vk::DynamicState::eColorWriteMaskEXT,
+                                        });
+        }
+
+        if (features.vertex_input_dynamic_state) {
+            states.push_back(vk::DynamicState::eVertexInputEXT);
+        }
+
+        return states;
+    }
+
+    DynamicStateTracker::DynamicStateTracker(const std::shared_ptr<Context> &context) : m_features(context->enabled_features()) {}
+
+    template <typename T, typename F>
+    void DynamicStateTracker::update(std::optional<T> &current, const T &value, F &&issue) {
+        if (current == value) {
+            m_skipped++;
+            return;
+        }
+
+        current = value;
+        issue();
+        m_issued++;
+    }
+
+    template <typename F>
+    void DynamicStateTracker::update_faces(StencilFaces &current, vk::StencilFaceFlags faces, uint32_t value, F &&issue) {
+        const bool front = static_cast<bool>(faces & vk::StencilFaceFlagBits::eFront);
+        const bool back  = static_cast<bool>(faces & vk::StencilFaceFlagBits::eBack);
+        if ((!front || current.front == value) && (!back || current.back == value)) {
+            m_skipped++;
+            return;
+        }
+
+        if (front) {
+            current.front = value;
+        }
+        if (back) {
+            current.back = value;
+        }
+        issue();
+        m_issued++;
+    }
+
+    void DynamicStateTracker::begin(vk::CommandBuffer cmd) {
+        m_cmd = cmd;
+        invalidate();
+    }
+
+    void DynamicStateTracker::invalidate() {
+        m_pipeline = VK_NULL_HANDLE;
+
+        m_viewport.reset();
+        m_scissor.reset();
+        m_line_width.reset();
+        m_depth_bias.reset();
+        m_blend_constants.reset();
+        m_depth_bounds.reset();
+        m_stencil_compare_mask = {};
+        m_stencil_write_mask   = {};
+        m_stencil_reference    = {};
+
+        m_cull_mode.reset();
+        m_front_face.reset();
+        m_topology.reset();
+        m_depth_test_enable.reset();
+        m_depth_write_enable.reset();
+        m_depth_compare_op.reset();
+        m_depth_bounds_test_enable.reset();
+        m_stencil_test_enable.reset();
+        m_stencil_op_front.reset();
+        m_stencil_op_back.reset();
+
+        m_rasterizer_discard_enable.reset();
+        m_depth_bias_enable.reset();
+        m_primitive_restart_enable.reset();
+
+        m_polygon_mode.reset();
+        m_depth_clamp_enable.reset();
+        m_logic_op_enable.reset();
+        m_blend_enable.fill(std::nullopt);
+        m_blend_equation.fill(std::nullopt);
+        m_color_write_mask.fill(std::nullopt);
+
+        m_vertex_input_known = false;
+    }
+
+    void DynamicStateTracker::bind_pipeline(const GraphicsPipeline &pipeline) {
+        if (m_pipeline == pipeline.pipeline()) {
+            m_skipped++;
+            return;
+        }
+
+        m_cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+        m_pipeline = pipeline.pipeline();
+        m_issued++;
+
+        const auto &dynamic    = pipeline.dynamic_states();
+        auto        is_dynamic = [&](vk::DynamicState state) { return std::ranges::binary_search(dynamic, state); };
+
+        const bool viewport_with_count = is_dynamic(vk::DynamicState::eViewportWithCountEXT);
+        const bool scissor_with_count  = is_dynamic(vk::DynamicState::eScissorWithCountEXT);
+
+        // the plain and the WithCount commands set different state, a value recorded with one does not count for the other
+        if (viewport_with_count != m_viewport_with_count) {
+            invalidate(vk::DynamicState::eViewport);
+        }
+        if (scissor_with_count != m_scissor_with_count) {
+            invalidate(vk::DynamicState::eScissor);
+        }
+
+        m_viewport_with_count = viewport_with_count;
+        m_scissor_with_count  = scissor_with_count;
+
+        // the pipeline's baked values replace whatever was set for these
+        for (const vk::DynamicState state : TRACKED_STATES) {
+            if (!is_dynamic(state) && !(state == vk::DynamicState::eViewport && m_viewport_with_count) && !(state == vk::DynamicState::eScissor && m_scissor_with_count)) {
+                invalidate(state);
+            }
+        }
+    }
+
+    void DynamicStateTracker::set_viewport(const vk::Viewport &viewport) {
+        update(m_viewport, viewport, [&] {
+            if (m_viewport_with_count) {
+                m_cmd.setViewportWithCountEXT(viewport);
+            } else {
+                m_cmd.setViewport(0, viewport);
+            }
+        });
+    }
+
+    void DynamicStateTracker::set_scissor(const vk::Rect2D &scissor) {
+        update(m_scissor, scissor, [&] {
+            if (m_scissor_with_count) {
+                m_cmd.setScissorWithCountEXT(scissor);
+            } else {
+                m_cmd.setScissor(0, scissor);
+            }
+        });
+    }
+
+    void DynamicStateTracker::set_line_width(float width) {
+        update(m_line_width, width, [&] { m_cmd.setLineWidth(width); });
+    }
+
+    void DynamicStateTracker::set_depth_bias(float constant_factor, float clamp, float slope_factor) {
+        update(m_depth_bias, {constant_factor, clamp, slope_factor}, [&] { m_cmd.setDepthBias(constant_factor, clamp, slope_factor); });
+    }
+
+    void DynamicStateTracker::set_blend_constants(const std::array<float, 4> &constants) {
+        update(m_blend_constants, constants, [&] { m_cmd.setBlendConstants(constants.data()); });
+    }
+
+    void DynamicStateTracker::set_depth_bounds(float min_depth, float max_depth) {
+        update(m_depth_bounds, {min_depth, max_depth}, [&] { m_cmd.setDepthBounds(min_depth, max_depth); });
+    }
+
+    void DynamicStateTracker::set_stencil_compare_mask(vk::StencilFaceFlags faces, uint32_t mask) {
+        update_faces(m_stencil_compare_mask, faces, mask, [&] { m_cmd.setStencilCompareMask(faces, mask); });
+    }
+
+    void DynamicStateTracker::set_stencil_write_mask(vk::StencilFaceFlags faces, uint32_t mask) {
+        update_faces(m_stencil_write_mask, faces, mask, [&] { m_cmd.setStencilWriteMask(faces, mask); });
+    }
+
+    void DynamicStateTracker::set_stencil_reference(vk::StencilFaceFlags faces, uint32_t reference) {
+        update_faces(m_stencil_reference, faces, reference, [&] { m_cmd.setStencilReference(faces, reference); });
+    }
+
+    void DynamicStateTracker::set_cull_mode(vk::CullModeFlags cull_mode) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_cull_mode, cull_mode, [&] { m_cmd.setCullModeEXT(cull_mode); });
+    }
+
+    void DynamicStateTracker::set_front_face(vk::FrontFace front_face) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_front_face, front_face, [&] { m_cmd.setFrontFaceEXT(front_face); });
+    }
+
+    void DynamicStateTracker::set_primitive_topology(vk::PrimitiveTopology topology) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_topology, topology, [&] { m_cmd.setPrimitiveTopologyEXT(topology); });
+    }
+
+    void DynamicStateTracker::set_depth_test_enable(bool enable) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_depth_test_enable, enable, [&] { m_cmd.setDepthTestEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_depth_write_enable(bool enable) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_depth_write_enable, enable, [&] { m_cmd.setDepthWriteEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_depth_compare_op(vk::CompareOp op) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_depth_compare_op, op, [&] { m_cmd.setDepthCompareOpEXT(op); });
+    }
+
+    void DynamicStateTracker::set_depth_bounds_test_enable(bool enable) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_depth_bounds_test_enable, enable, [&] { m_cmd.setDepthBoundsTestEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_stencil_test_enable(bool enable) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+        update(m_stencil_test_enable, enable, [&] { m_cmd.setStencilTestEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_stencil_op(vk::StencilFaceFlags faces, vk::StencilOp fail, vk::StencilOp pass, vk::StencilOp depth_fail, vk::CompareOp compare) {
+        require(m_features.extended_dynamic_state, "extended dynamic state");
+
+        const StencilOps ops{fail, pass, depth_fail, compare};
+
+        const bool front = static_cast<bool>(faces & vk::StencilFaceFlagBits::eFront);
+        const bool back  = static_cast<bool>(faces & vk::StencilFaceFlagBits::eBack);
+        if ((!front || m_stencil_op_front == ops) && (!back || m_stencil_op_back == ops)) {
+            m_skipped++;
+            return;
+        }
+
+        if (front) {
+            m_stencil_op_front = ops;
+        }
+        if (back) {
+            m_stencil_op_back = ops;
+        }
+        m_cmd.setStencilOpEXT(faces, fail, pass, depth_fail, compare);
+        m_issued++;
+    }
+
+    void DynamicStateTracker::set_rasterizer_discard_enable(bool enable) {
+        require(m_features.extended_dynamic_state2, "extended dynamic state 2");
+        update(m_rasterizer_discard_enable, enable, [&] { m_cmd.setRasterizerDiscardEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_depth_bias_enable(bool enable) {
+        require(m_features.extended_dynamic_state2, "extended dynamic state 2");
+        update(m_depth_bias_enable, enable, [&] { m_cmd.setDepthBiasEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_primitive_restart_enable(bool enable) {
+        require(m_features.extended_dynamic_state2, "extended dynamic state 2");
+        update(m_primitive_restart_enable, enable, [&] { m_cmd.setPrimitiveRestartEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_polygon_mode(vk::PolygonMode mode) {
+        require(m_features.extended_dynamic_state3, "extended dynamic state 3");
+        update(m_polygon_mode, mode, [&] { m_cmd.setPolygonModeEXT(mode); });
+    }
+
+    void DynamicStateTracker::set_depth_clamp_enable(bool enable) {
+        require(m_features.extended_dynamic_state3, "extended dynamic state 3");
+        update(m_depth_clamp_enable, enable, [&] { m_cmd.setDepthClampEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_logic_op_enable(bool enable) {
+        require(m_features.extended_dynamic_state3, "extended dynamic state 3");
+        update(m_logic_op_enable, enable, [&] { m_cmd.setLogicOpEnableEXT(enable); });
+    }
+
+    void DynamicStateTracker::set_color_blend(uint32_t attachment, const vk::PipelineColorBlendAttachmentState &state) {
+        require(m_features.extended_dynamic_state3, "extended dynamic state 3");
+        if (attachment >= MAX_COLOR_ATTACHMENTS) {
+            throw std::runtime_error("Color attachment index out of range");
+        }
+
+        const vk::Bool32                enable = state.blendEnable;
+        const vk::ColorBlendEquationEXT equation{state.srcColorBlendFactor, state.dstColorBlendFactor, state.colorBlendOp,
+                                                 state.srcAlphaBlendFactor, state.dstAlphaBlendFactor, state.alphaBlendOp};
+
+        update(m_blend_enable[attachment], static_cast<bool>(enable), [&] { m_cmd.setColorBlendEnableEXT(attachment, enable); });
+        update(m_blend_equation[attachment], equation, [&] { m_cmd.setColorBlendEquationEXT(attachment, equation); });
+        update(m_color_write_mask[attachment], state.colorWriteMask, [&] { m_cmd.setColorWriteMaskEXT(attachment, state.colorWriteMask); });
+    }
+
+    void DynamicStateTracker::set_vertex_input(std::span<const vk::VertexInputBindingDescription> bindings, std::span<const vk::VertexInputAttributeDescription> attributes) {
+        require(m_features.vertex_input_dynamic_state, "vertex input dynamic state");
+
+        if (m_vertex_input_known && std::ranges::equal(bindings, m_vertex_bindings) && std::ranges::equal(attributes, m_vertex_attributes)) {
+            m_skipped++;
+            return;
+        }
+
+        m_vertex_bindings.assign(bindings.begin(), bindings.end());
+        m_vertex_attributes.assign(attributes.begin(), attributes.end());
+        m_vertex_input_known = true;
+
+        m_vertex_bindings2.clear();
+        for (const auto &b : bindings) {
+            m_vertex_bindings2.emplace_back(b.binding, b.stride, b.inputRate, 1);
+        }
+
+        m_vertex_attributes2.clear();
+        for (const auto &a : attributes) {
+            m_vertex_attributes2.emplace_back(a.location, a.binding, a.format, a.offset);
+        }
+
+        m_cmd.setVertexInputEXT(m_vertex_bindings2, m_vertex_attributes2);
+        m_issued++;
+    }
+
+    void DynamicStateTracker::apply(const GraphicsPipelineBuilder &builder) {
+        if (!builder.viewports.empty()) {
+            set_viewport(builder.viewports.front());
+        }
+        if (!builder.scissors.empty()) {
+            set_scissor(builder.scissors.front());
+        }
+        set_line_width(builder.line_width);
+        set_depth_bias(builder.depth_bias_constant_factor, builder.depth_bias_clamp, builder.depth_bias_slope_factor);
+        set_blend_constants(builder.blend_constants);
+        set_depth_bounds(builder.min_depth_bounds, builder.max_depth_bounds);
+        set_stencil_compare_mask(vk::StencilFaceFlagBits::eFront, builder.stencil_front.compareMask);
+        set_stencil_compare_mask(vk::StencilFaceFlagBits::eBack, builder.stencil_back.compareMask);
+        set_stencil_write_mask(vk::StencilFaceFlagBits::eFront, builder.stencil_front.writeMask);
+        set_stencil_write_mask(vk::StencilFaceFlagBits::eBack, builder.stencil_back.writeMask);
+        set_stencil_reference(vk::StencilFaceFlagBits::eFront, builder.stencil_front.reference);
+        set_stencil_reference(vk::StencilFaceFlagBits::eBack, builder.stencil_back.reference);
+
+        if (m_features.extended_dynamic_state) {
+            const auto &front = builder.stencil_front;
+            const auto &back  = builder.stencil_back;
+
+            set_cull_mode(builder.cull_mode);
+            set_front_face(builder.front_face);
+            set_primitive_topology(builder.primitive_topology);
+            set_depth_test_enable(builder.enable_depth_test);
+            set_depth_write_enable(builder.enable_depth_write);
+            set_depth_compare_op(builder.depth_compare_op);
+            set_depth_bounds_test_enable(builder.enable_depth_bounds_test);
+            set_stencil_test_enable(builder.enable_stencil_test);
+            set_stencil_op(vk::StencilFaceFlagBits::eFront, front.failOp, front.passOp, front.depthFailOp, front.compareOp);
+            set_stencil_op(vk::StencilFaceFlagBits::eBack, back.failOp, back.passOp, back.depthFailOp, back.compareOp);
+        }
+
+        if (m_features.extended_dynamic_state2) {
+            set_rasterizer_discard_enable(builder.enable_rasterizer_discard);
+            set_depth_bias_enable(builder.enable_depth_bias);
+            set_primitive_restart_enable(builder.enable_primitive_restart);
+        }
+
+        if (m_features.extended_dynamic_state3) {
+            set_polygon_mode(builder.polygon_mode);
+            set_depth_clamp_enable(builder.enable_depth_clamp);
+            set_logic_op_enable(builder.enable_logic_op);
+            for (uint32_t i = 0; i < builder.color_blend_attachments.size() && i < MAX_COLOR_ATTACHMENTS; i++) {
+                set_color_blend(i, builder.color_blend_attachments[i]);
+            }
+        }
+
+        if (m_features.vertex_input_dynamic_state) {
+            set_vertex_input(builder.vertex_bindings, builder.vertex_attributes);
+        }
+    }
+
+    void DynamicStateTracker::invalidate(vk::DynamicState state) {
+        switch (state) {
+        case vk::DynamicState::eViewport:
+        case vk::DynamicState::eViewportWithCountEXT: m_viewport.reset(); break;
+        case vk::DynamicState::eScissor:
+        case vk::DynamicState::eScissorWithCountEXT: m_scissor.reset(); break;
+        case vk::DynamicState::eLineWidth: m_line_width.reset(); break;
+        case vk::DynamicState::eDepthBias: m_depth_bias.reset(); break;
+        case vk::DynamicState::eBlendConstants: m_blend_constants.reset(); break;
+        case vk::DynamicState::eDepthBounds: m_depth_bounds.reset(); break;
+        case vk::DynamicState::eStencilCompareMask: m_stencil_compare_mask = {}; break;
+        case vk::DynamicState::eStencilWriteMask: m_stencil_write_mask = {}; break;
+        case vk::DynamicState::eStencilReference: m_stencil_reference = {}; break;
+        case vk::DynamicState::eCullModeEXT: m_cull_mode.reset(); break;
+        case vk::DynamicState::eFrontFaceEXT: m_front_face.reset(); break;
+        case vk::DynamicState::ePrimitiveTopologyEXT: m_topology.reset(); break;
+        case vk::DynamicState::eDepthTestEnableEXT: m_depth_test_enable.reset(); break;
+        case vk::DynamicState::eDepthWriteEnableEXT: m_depth_write_enable.reset(); break;
+        case vk::DynamicState::eDepthCompareOpEXT: m_depth_compare_op.reset(); break;
+        case vk::DynamicState::eDepthBoundsTestEnableEXT: m_depth_bounds_test_enable.reset(); break;
+        case vk::DynamicState::eStencilTestEnableEXT: m_stencil_test_enable.reset(); break;
+        case vk::DynamicState::eStencilOpEXT:
+            m_stencil_op_front.reset();
+            m_stencil_op_back.reset();
+            break;
+        case vk::DynamicState::eRasterizerDiscardEnableEXT: m_rasterizer_discard_enable.reset(); break;
+        case vk::DynamicState::eDepthBiasEnableEXT: m_depth_bias_enable.reset(); break;
+        case vk::DynamicState::ePrimitiveRestartEnableEXT: m_primitive_restart_enable.reset(); break;
+        case vk::DynamicState::ePolygonModeEXT: m_polygon_mode.reset(); break;
+        case vk::DynamicState::eDepthClampEnableEXT: m_depth_clamp_enable.reset(); break;
+        case vk::DynamicState::eLogicOpEnableEXT: m_logic_op_enable.reset(); break;
+        case vk::DynamicState::eColorBlendEnableEXT: m_blend_enable.fill(std::nullopt); break;
+        case vk::DynamicState::eColorBlendEquationEXT: m_blend_equation.fill(std::nullopt); break;
+        case vk::DynamicState::eColorWriteMaskEXT: m_color_write_mask.fill(std::nullopt); break;
+        case vk::DynamicState::eVertexInputEXT: m_vertex_input_known = false; break;
+        default: break;
+        }
+    }
+
+    void DynamicStateTracker::require(bool enabled, const char *feature) const {
+        if (!enabled) {
+            throw std::runtime_error(std::string("Dynamic state needs a device feature that is not enabled: ") + feature);
+        }
+    }
+} // namespace neuron::render
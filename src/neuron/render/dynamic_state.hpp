@@ -0,0 +1,153 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace neuron::render {
+
+    struct GraphicsPipelineBuilder;
+    class GraphicsPipeline;
+
+    // The states GraphicsPipelineBuilder::dynamic_pipeline_state leaves dynamic on this context: the core dynamic states,
+    // plus whatever extended dynamic state 1/2/3 and vertex input dynamic state were enabled. With extended dynamic state
+    // the viewport and scissor states are the with-count variants.
+    [[nodiscard]] NEURON_API std::vector<vk::DynamicState> supported_dynamic_states(const Context &ctx);
+
+    // Sets dynamic state on a command buffer, skipping calls that would set what is already set. Setters of states the
+    // context did not enable throw.
+    //
+    // Binding a pipeline resets the states it bakes, so bind through bind_pipeline(), or call invalidate() after binding
+    // one directly. State does not carry over between command buffers: call begin() for each one.
+    class NEURON_API DynamicStateTracker {
+      public:
+        static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+
+        explicit DynamicStateTracker(const std::shared_ptr<Context> &context);
+
+        void begin(vk::CommandBuffer cmd);
+        void invalidate();
+
+        // Binds unless already bound, and forgets the states the pipeline bakes.
+        void bind_pipeline(const GraphicsPipeline &pipeline);
+
+        void set_viewport(const vk::Viewport &viewport);
+        void set_scissor(const vk::Rect2D &scissor);
+        void set_line_width(float width);
+        void set_depth_bias(float constant_factor, float clamp, float slope_factor);
+        void set_blend_constants(const std::array<float, 4> &constants);
+        void set_depth_bounds(float min_depth, float max_depth);
+        void set_stencil_compare_mask(vk::StencilFaceFlags faces, uint32_t mask);
+        void set_stencil_write_mask(vk::StencilFaceFlags faces, uint32_t mask);
+        void set_stencil_reference(vk::StencilFaceFlags faces, uint32_t reference);
+
+        // extended dynamic state
+        void set_cull_mode(vk::CullModeFlags cull_mode);
+        void set_front_face(vk::FrontFace front_face);
+        void set_primitive_topology(vk::PrimitiveTopology topology);
+        void set_depth_test_enable(bool enable);
+        void set_depth_write_enable(bool enable);
+        void set_depth_compare_op(vk::CompareOp op);
+        void set_depth_bounds_test_enable(bool enable);
+        void set_stencil_test_enable(bool enable);
+        void set_stencil_op(vk::StencilFaceFlags faces, vk::StencilOp fail, vk::StencilOp pass, vk::StencilOp depth_fail, vk::CompareOp compare);
+
+        // extended dynamic state 2
+        void set_rasterizer_discard_enable(bool enable);
+        void set_depth_bias_enable(bool enable);
+        void set_primitive_restart_enable(bool enable);
+
+        // extended dynamic state 3
+        void set_polygon_mode(vk::PolygonMode mode);
+        void set_depth_clamp_enable(bool enable);
+        void set_logic_op_enable(bool enable);
+        void set_color_blend(uint32_t attachment, const vk::PipelineColorBlendAttachmentState &state);
+
+        // vertex input dynamic state; instanced bindings get a divisor of 1
+        void set_vertex_input(std::span<const vk::VertexInputBindingDescription> bindings, std::span<const vk::VertexInputAttributeDescription> attributes);
+
+        // Sets every enabled state from the builder's fixed-function fields.
+        void apply(const GraphicsPipelineBuilder &builder);
+
+        [[nodiscard]] inline uint64_t issued_count() const { return m_issued; }
+        [[nodiscard]] inline uint64_t skipped_count() const { return m_skipped; }
+
+      private:
+        struct StencilFaces {
+            std::optional<uint32_t> front;
+            std::optional<uint32_t> back;
+        };
+
+        struct StencilOps {
+            vk::StencilOp fail;
+            vk::StencilOp pass;
+            vk::StencilOp depth_fail;
+            vk::CompareOp compare;
+
+            bool operator==(const StencilOps &other) const = default;
+        };
+
+        template <typename T, typename F>
+        void update(std::optional<T> &current, const T &value, F &&issue);
+
+        template <typename F>
+        void update_faces(StencilFaces &current, vk::StencilFaceFlags faces, uint32_t value, F &&issue);
+
+        void invalidate(vk::DynamicState state);
+        void require(bool enabled, const char *feature) const;
+
+        EnabledFeatureSet m_features;
+        vk::CommandBuffer m_cmd;
+        vk::Pipeline      m_pipeline;
+        bool              m_viewport_with_count = false;
+        bool              m_scissor_with_count  = false;
+
+        std::optional<vk::Viewport>         m_viewport;
+        std::optional<vk::Rect2D>           m_scissor;
+        std::optional<float>                m_line_width;
+        std::optional<std::array<float, 3>> m_depth_bias;
+        std::optional<std::array<float, 4>> m_blend_constants;
+        std::optional<std::array<float, 2>> m_depth_bounds;
+        StencilFaces                        m_stencil_compare_mask;
+        StencilFaces                        m_stencil_write_mask;
+        StencilFaces                        m_stencil_reference;
+
+        std::optional<vk::CullModeFlags>     m_cull_mode;
+        std::optional<vk::FrontFace>         m_front_face;
+        std::optional<vk::PrimitiveTopology> m_topology;
+        std::optional<bool>                  m_depth_test_enable;
+        std::optional<bool>                  m_depth_write_enable;
+        std::optional<vk::CompareOp>         m_depth_compare_op;
+        std::optional<bool>                  m_depth_bounds_test_enable;
+        std::optional<bool>                  m_stencil_test_enable;
+        std::optional<StencilOps>            m_stencil_op_front;
+        std::optional<StencilOps>            m_stencil_op_back;
+
+        std::optional<bool> m_rasterizer_discard_enable;
+        std::optional<bool> m_depth_bias_enable;
+        std::optional<bool> m_primitive_restart_enable;
+
+        std::optional<vk::PolygonMode>                                              m_polygon_mode;
+        std::optional<bool>                                                         m_depth_clamp_enable;
+        std::optional<bool>                                                         m_logic_op_enable;
+        std::array<std::optional<bool>, MAX_COLOR_ATTACHMENTS>                      m_blend_enable;
+        std::array<std::optional<vk::ColorBlendEquationEXT>, MAX_COLOR_ATTACHMENTS> m_blend_equation;
+        std::array<std::optional<vk::ColorComponentFlags>, MAX_COLOR_ATTACHMENTS>   m_color_write_mask;
+
+        // the last vertex input set, and scratch for the EXT structs; both keep their capacity
+        bool                                                 m_vertex_input_known = false;
+        std::vector<vk::VertexInputBindingDescription>       m_vertex_bindings;
+        std::vector<vk::VertexInputAttributeDescription>     m_vertex_attributes;
+        std::vector<vk::VertexInputBindingDescription2EXT>   m_vertex_bindings2;
+        std::vector<vk::VertexInputAttributeDescription2EXT> m_vertex_attributes2;
+
+        uint64_t m_issued  = 0;
+        uint64_t m_skipped = 0;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,141 @@
+#include "gpu_culling.hpp"
+
+#include "display_system.hpp"
+
+#include "neuron/shaders/gpu_cull.comp.hpp"
+
+namespace neuron::render {
+    struct CullPushConstants {
+        std::array<glm::vec4, 6> planes;
+        uint32_t                 object_count;
+        uint32_t                 compact;
+    };
+
+    struct CullDescriptorData {
+        vk::DescriptorBufferInfo objects;
+        vk::DescriptorBufferInfo draws;
+        vk::DescriptorBufferInfo count;
+    };
+
+    GpuDrivenCuller::GpuDrivenCuller(const std::shared_ptr<Context> &context, const GpuCullingSettings &settings)
+        : m_context(context), m_settings(settings), m_compact(context->draw_indirect_count_enabled()),
+          m_multi_draw(context->enabled_features().multi_draw_indirect) {
+        m_pipeline = ComputePipelineBuilder()
+                         .set_shader(ShaderModuleInfo{.source = ShaderCode{.code = std::span<const uint32_t>(shaders::gpu_cull_comp)},
+                                                      .type   = ShaderModuleSourceType::SPIRV,
+                                                      .stage  = vk::ShaderStageFlagBits::eCompute})
+                         .build(m_context);
+        m_layout   = m_pipeline->layout();
+
+        const auto &set_layout = m_layout->descriptor_set_layouts().front();
+        m_descriptor_allocator = std::make_unique<DescriptorAllocator>(m_context, DescriptorAllocatorSettings{
+                                                                                      .initial_sets_per_pool = DisplaySystem::MAX_FRAMES_IN_FLIGHT,
+                                                                                      .ratios                = {{vk::DescriptorType::eStorageBuffer, 3.0f}},
+                                                                                  });
+        m_update_template      = std::make_unique<DescriptorUpdateTemplate>(m_context, set_layout);
+
+        m_object_buffer = m_context->allocate_gpu_buffer(m_settings.max_objects * sizeof(CullObject), nullptr, vk::BufferUsageFlagBits::eStorageBuffer);
+
+        m_frames.resize(DisplaySystem::MAX_FRAMES_IN_FLIGHT);
+        for (auto &frame : m_frames) {
+            frame.draw_buffer = m_context->allocate_gpu_buffer(m_settings.max_objects * sizeof(vk::DrawIndexedIndirectCommand), nullptr,
+                                                               vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer);
+            frame.count_buffer =
+                m_context->allocate_gpu_buffer(sizeof(uint32_t), nullptr, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer);
+            frame.descriptor_set = m_descriptor_allocator->allocate(set_layout);
+
+            CullDescriptorData data{
+                {m_object_buffer.resource, 0, VK_WHOLE_SIZE},
+                {frame.draw_buffer.resource, 0, VK_WHOLE_SIZE},
+                {frame.count_buffer.resource, 0, VK_WHOLE_SIZE},
+            };
+            m_update_template->update(frame.descriptor_set, data);
+        }
+    }
+
+    std::shared_ptr<GpuDrivenCuller> GpuDrivenCuller::create(const std::shared_ptr<Context> &context, const GpuCullingSettings &settings) {
+        return std::shared_ptr<GpuDrivenCuller>(new GpuDrivenCuller(context, settings));
+    }
+
+    GpuDrivenCuller::~GpuDrivenCuller() {
+        for (const auto &frame : m_frames) {
+            m_context->free_buffer(frame.draw_buffer);
+            m_context->free_buffer(frame.count_buffer);
+        }
+
+        m_context->free_buffer(m_object_buffer);
+    }
+
+    void GpuDrivenCuller::set_objects(std::span<const CullObject> objects) {
+        if (objects.size() > m_settings.max_objects) {
+            throw std::runtime_error("Too many objects for GPU culler");
+        }
+
+        m_object_count = static_cast<uint32_t>(objects.size());
+        if (objects.empty()) {
+            return;
+        }
+
+        auto stage = m_context->allocate_staging_buffer(objects.size_bytes(), objects.data(), {});
+        m_context->copy_buffer_to_buffer(stage, m_object_buffer, objects.size_bytes(), 0, 0);
+        m_context->free_buffer(stage);
+    }
+
+    void GpuDrivenCuller::record_cull(const vk::CommandBuffer &cmd, uint32_t frame_index, const std::array<glm::vec4, 6> &frustum_planes) const {
+        const FrameResources &frame = m_frames[frame_index];
+
+        if (m_compact) {
+            cmd.fillBuffer(frame.count_buffer.resource, 0, sizeof(uint32_t), 0);
+
+            vk::MemoryBarrier clear_barrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite};
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, clear_barrier, {}, {});
+        }
+
+        CullPushConstants push{frustum_planes, m_object_count, m_compact ? 1U : 0U};
+
+        m_pipeline->bind(cmd);
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_layout->pipeline_layout(), 0, frame.descriptor_set, {});
+        cmd.pushConstants(m_layout->pipeline_layout(), m_layout->push_constant_ranges().front().stageFlags, 0, sizeof(CullPushConstants), &push);
+        m_pipeline->dispatch_invocations(cmd, m_object_count);
+
+        vk::MemoryBarrier draw_barrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead};
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader, {}, draw_barrier,
+                            {}, {});
+    }
+
+    void GpuDrivenCuller::record_draw(const vk::CommandBuffer &cmd, uint32_t frame_index) const {
+        const FrameResources &frame = m_frames[frame_index];
+
+        if (m_compact) {
+            cmd.drawIndexedIndirectCount(frame.draw_buffer.resource, 0, frame.count_buffer.resource, 0, m_object_count, sizeof(vk::DrawIndexedIndirectCommand));
+        } else if (m_multi_draw) {
+            if (m_object_count > 0) {
+                cmd.drawIndexedIndirect(frame.draw_buffer.resource, 0, m_object_count, sizeof(vk::DrawIndexedIndirectCommand));
+            }
+        } else {
+            // without multiDrawIndirect the count must be 1; instances are addressed through firstInstance either way
+            for (uint32_t i = 0; i < m_object_count; i++) {
+                cmd.drawIndexedIndirect(frame.draw_buffer.resource, i * sizeof(vk::DrawIndexedIndirectCommand), 1, sizeof(vk::DrawIndexedIndirectCommand));
+            }
+        }
+    }
+
+    std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4 &view_projection) {
+        auto row = [&](int i) { return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]); };
+
+        std::array<glm::vec4, 6> planes = {
+            row(3) + row(0), // left
+            row(3) - row(0), // right
+            row(3) + row(1), // bottom
+            row(3) - row(1), // top
+            row(2),          // near
+            row(3) - row(2), // far
+        };
+
+        for (auto &plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return planes;
+    }
+} // namespace neuron::render
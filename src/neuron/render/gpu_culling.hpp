@@ -0,0 +1,86 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "compute_pipeline.hpp"
+#include "descriptors.hpp"
+
+#include <array>
+#include <memory>
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace neuron::render {
+
+    // Matches the std430 layout used by the culling shader.
+    struct CullObject {
+        glm::vec4 bounding_sphere; // xyz: world-space center, w: radius
+        uint32_t  index_count;
+        uint32_t  first_index;
+        int32_t   vertex_offset;
+        uint32_t  instance_index; // becomes firstInstance, so the vertex shader finds its data at gl_InstanceIndex
+    };
+
+    static_assert(sizeof(CullObject) == 32);
+
+    struct GpuCullingSettings {
+        uint32_t max_objects = 65536;
+    };
+
+    // Frustum-culls a fixed set of objects on the GPU and draws the survivors with one indirect call.
+    //
+    // Per frame: record_cull() (outside a render pass), then inside the pass bind the graphics pipeline and the shared
+    // vertex/index buffers and call record_draw(). CPU cost does not depend on the object count.
+    // When drawIndirectCount is unavailable, culled objects are written as zero-instance draws instead of being compacted.
+    // Without multiDrawIndirect every object becomes its own indirect draw call.
+    class NEURON_API GpuDrivenCuller {
+        GpuDrivenCuller(const std::shared_ptr<Context> &context, const GpuCullingSettings &settings);
+
+      public:
+        static std::shared_ptr<GpuDrivenCuller> create(const std::shared_ptr<Context> &context, const GpuCullingSettings &settings = {});
+
+        ~GpuDrivenCuller();
+
+        GpuDrivenCuller(const GpuDrivenCuller &other)            = delete;
+        GpuDrivenCuller &operator=(const GpuDrivenCuller &other) = delete;
+
+        // Blocking upload, must not be called while a frame using the culler is in flight.
+        void set_objects(std::span<const CullObject> objects);
+
+        void record_cull(const vk::CommandBuffer &cmd, uint32_t frame_index, const std::array<glm::vec4, 6> &frustum_planes) const;
+        void record_draw(const vk::CommandBuffer &cmd, uint32_t frame_index) const;
+
+        [[nodiscard]] inline uint32_t object_count() const { return m_object_count; }
+
+        [[nodiscard]] inline const VmaAllocated<vk::Buffer> &object_buffer() const { return m_object_buffer; }
+
+        [[nodiscard]] inline const VmaAllocated<vk::Buffer> &draw_buffer(uint32_t frame_index) const { return m_frames[frame_index].draw_buffer; }
+
+        [[nodiscard]] inline const VmaAllocated<vk::Buffer> &count_buffer(uint32_t frame_index) const { return m_frames[frame_index].count_buffer; }
+
+      private:
+        struct FrameResources {
+            VmaAllocated<vk::Buffer> draw_buffer;
+            VmaAllocated<vk::Buffer> count_buffer;
+            vk::DescriptorSet        descriptor_set;
+        };
+
+        std::shared_ptr<Context>                  m_context;
+        GpuCullingSettings                        m_settings;
+        bool                                      m_compact;
+        bool                                      m_multi_draw;
+        std::shared_ptr<ComputePipeline>          m_pipeline;
+        std::shared_ptr<PipelineLayout>           m_layout;
+        std::unique_ptr<DescriptorAllocator>      m_descriptor_allocator;
+        std::unique_ptr<DescriptorUpdateTemplate> m_update_template;
+
+        VmaAllocated<vk::Buffer>    m_object_buffer;
+        uint32_t                    m_object_count = 0;
+        std::vector<FrameResources> m_frames;
+    };
+
+    // Plane equations (xyz normal, w distance, normals pointing inwards) for a Vulkan-style [0, 1] depth projection.
+    [[nodiscard]] NEURON_API std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4 &view_projection);
+
+} // namespace neuron::render
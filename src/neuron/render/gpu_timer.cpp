@@ -0,0 +1,63 @@
+#include "gpu_timer.hpp"
+
+#include <array>
+
+namespace neuron::render {
+    GpuFrameTimer::GpuFrameTimer(const std::shared_ptr<Context> &context, uint32_t slots) : m_context(context), m_recorded(slots, false) {
+        const auto     properties = m_context->physical_device().getProperties();
+        const uint32_t valid_bits = m_context->physical_device().getQueueFamilyProperties()[m_context->main_queue_family()].timestampValidBits;
+
+        m_supported   = valid_bits > 0 && properties.limits.timestampPeriod > 0.0f;
+        m_ns_per_tick = properties.limits.timestampPeriod;
+        m_valid_mask  = valid_bits >= 64 ? ~0ULL : (1ULL << valid_bits) - 1;
+
+        if (m_supported) {
+            m_pool = m_context->device().createQueryPool(vk::QueryPoolCreateInfo{{}, vk::QueryType::eTimestamp, slots * 2});
+        }
+    }
+
+    std::shared_ptr<GpuFrameTimer> GpuFrameTimer::create(const std::shared_ptr<Context> &context, uint32_t slots) {
+        return std::shared_ptr<GpuFrameTimer>(new GpuFrameTimer(context, slots));
+    }
+
+    GpuFrameTimer::~GpuFrameTimer() {
+        if (m_pool) {
+            m_context->device().destroyQueryPool(m_pool);
+        }
+    }
+
+    void GpuFrameTimer::begin(const vk::CommandBuffer &cmd, uint32_t slot) {
+        if (!m_supported) {
+            return;
+        }
+
+        cmd.resetQueryPool(m_pool, slot * 2, 2);
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_pool, slot * 2);
+    }
+
+    void GpuFrameTimer::end(const vk::CommandBuffer &cmd, uint32_t slot) {
+        if (!m_supported) {
+            return;
+        }
+
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_pool, slot * 2 + 1);
+        m_recorded[slot] = true;
+    }
+
+    std::optional<double> GpuFrameTimer::take_ms(uint32_t slot) {
+        if (!m_supported || !m_recorded[slot]) {
+            return std::nullopt;
+        }
+
+        std::array<uint64_t, 2> ticks{};
+        const vk::Result        result = m_context->device().getQueryPoolResults(m_pool, slot * 2, 2, sizeof(ticks), ticks.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+        if (result != vk::Result::eSuccess) {
+            return std::nullopt;
+        }
+
+        m_recorded[slot] = false;
+
+        const uint64_t elapsed = ((ticks[1] & m_valid_mask) - (ticks[0] & m_valid_mask)) & m_valid_mask;
+        return static_cast<double>(elapsed) * m_ns_per_tick / 1e6;
+    }
+} // namespace neuron::render
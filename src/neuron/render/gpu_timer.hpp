@@ -0,0 +1,47 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "display_system.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace neuron::render {
+
+    // GPU time between two points of a command buffer, from timestamp queries on the main queue. One slot per frame in
+    // flight: a slot is read back when it comes around again, by which time the frame's fence has been waited on, so
+    // reading never stalls.
+    class NEURON_API GpuFrameTimer {
+        GpuFrameTimer(const std::shared_ptr<Context> &context, uint32_t slots);
+
+      public:
+        static std::shared_ptr<GpuFrameTimer> create(const std::shared_ptr<Context> &context, uint32_t slots = DisplaySystem::MAX_FRAMES_IN_FLIGHT);
+
+        ~GpuFrameTimer();
+
+        GpuFrameTimer(const GpuFrameTimer &other)            = delete;
+        GpuFrameTimer &operator=(const GpuFrameTimer &other) = delete;
+
+        // False when the main queue has no timestamps; begin() and end() then record nothing.
+        [[nodiscard]] inline bool supported() const { return m_supported; }
+
+        // Outside a render pass.
+        void begin(const vk::CommandBuffer &cmd, uint32_t slot);
+        void end(const vk::CommandBuffer &cmd, uint32_t slot);
+
+        // The slot's last measurement, once; empty if there is none or it is not available yet.
+        [[nodiscard]] std::optional<double> take_ms(uint32_t slot);
+
+      private:
+        std::shared_ptr<Context> m_context;
+        vk::QueryPool            m_pool;
+        bool                     m_supported;
+        double                   m_ns_per_tick;
+        uint64_t                 m_valid_mask;
+
+        std::vector<bool> m_recorded;
+    };
+
+} // namespace neuron::render
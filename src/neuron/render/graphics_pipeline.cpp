@@ -1,47 +1,44 @@
 #include "graphics_pipeline.hpp"
 
-#include <fstream>
+#include "dynamic_state.hpp"
+#include "neuron/jobs/job_system.hpp"
+#include "neuron/os/mapped_file.hpp"
+
+#include <algorithm>
+#include <bit>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
+#ifdef NEURON_HAS_SHADERC
 #include <shaderc/shaderc.hpp>
+#endif
 
 namespace neuron::render {
     static std::string read_file_text(const std::filesystem::path &path) {
-        std::ifstream file(path.string(), std::ios::ate | std::ios::in);
-
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file");
-        }
-
-        auto  file_size = static_cast<std::streamsize>(file.tellg());
-        auto *buffer    = new char[file_size + 1];
-        memset(buffer, 0, file_size + 1);
-        file.seekg(0);
-        file.read(buffer, file_size);
-        file.close();
-        std::string content(buffer, strlen(buffer));
-        delete[] buffer;
-        return content;
+        os::MappedFile file(path);
+        return {reinterpret_cast<const char *>(file.data().data()), file.size()};
     }
 
-    static std::vector<uint32_t> read_file_binary(const std::filesystem::path &path) {
-        std::ifstream file(path.string(), std::ios::ate | std::ios::in | std::ios::binary);
-
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file");
+    // A pipeline with dynamic topology only fixes the topology class.
+    static uint64_t topology_class(vk::PrimitiveTopology topology) {
+        switch (topology) {
+        case vk::PrimitiveTopology::ePointList:
+            return 0;
+        case vk::PrimitiveTopology::eLineList:
+        case vk::PrimitiveTopology::eLineStrip:
+        case vk::PrimitiveTopology::eLineListWithAdjacency:
+        case vk::PrimitiveTopology::eLineStripWithAdjacency:
+            return 1;
+        case vk::PrimitiveTopology::ePatchList:
+            return 3;
+        default:
+            return 2;
         }
-
-        auto                  file_size   = file.tellg();
-        size_t                buffer_size = file_size / sizeof(uint32_t);
-        std::vector<uint32_t> buffer(buffer_size);
-        file.seekg(0);
-        file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer_size * sizeof(uint32_t)));
-        file.close();
-        return buffer;
     }
 
+#ifdef NEURON_HAS_SHADERC
     std::vector<uint32_t> compile_glsl(std::string glsl, vk::ShaderStageFlagBits stage) {
         shaderc_shader_kind kind = shaderc_glsl_infer_from_source;
 
@@ -93,8 +90,12 @@ namespace neuron::render {
         }
 
 
+        // the Context targets Vulkan 1.2, which also lets shaders use buffer_reference pointers
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+
         shaderc::Compiler compiler;
-        auto              res = compiler.CompileGlslToSpv(glsl, kind, "shader.glsl");
+        auto              res = compiler.CompileGlslToSpv(glsl, kind, "shader.glsl", options);
 
         if (res.GetNumErrors() != 0) {
             std::cerr << "Shader Compilation Error: " << res.GetErrorMessage() << std::endl;
@@ -104,6 +105,11 @@ namespace neuron::render {
         std::vector<uint32_t> spirv(res.begin(), res.end());
         return spirv;
     }
+#else
+    std::vector<uint32_t> compile_glsl(std::string, vk::ShaderStageFlagBits) {
+        throw std::runtime_error("neuron was built without NEURON_ENABLE_SHADERC, embed SPIR-V with neuron_embed_shaders() instead of loading GLSL");
+    }
+#endif
 
     vk::ShaderStageFlagBits infer_stage_from_path(const std::filesystem::path &path) {
         auto ext = path.extension().string();
@@ -137,13 +143,20 @@ namespace neuron::render {
     }
 
     ShaderModule::ShaderModule(const std::shared_ptr<Context> &context, const ShaderModuleInfo &info) : m_context(context) {
-        std::vector<uint32_t> spirv_code;
+        // SPIR-V is used in place: from the source vector, the compiler output, or the file mapping
+        std::vector<uint32_t>         compiled;
+        std::optional<os::MappedFile> mapped;
+        std::span<const uint32_t>     spirv_code;
+
         if (info.source.index() == 1) {
-            auto code_ = std::get<ShaderCode>(info.source);
+            const auto &code_ = std::get<ShaderCode>(info.source);
             if (code_.code.index() == 0) {
-                spirv_code = compile_glsl(std::get<std::string>(code_.code), info.stage);
-            } else {
+                compiled   = compile_glsl(std::get<std::string>(code_.code), info.stage);
+                spirv_code = compiled;
+            } else if (code_.code.index() == 1) {
                 spirv_code = std::get<std::vector<uint32_t>>(code_.code);
+            } else {
+                spirv_code = std::get<std::span<const uint32_t>>(code_.code);
             }
         } else {
             auto path = std::get<std::filesystem::path>(info.source);
@@ -156,13 +169,17 @@ namespace neuron::render {
                     stage = infer_stage_from_path(path);
                 }
 
-                spirv_code = compile_glsl(glsl_source, stage);
+                compiled   = compile_glsl(std::move(glsl_source), stage);
+                spirv_code = compiled;
             } else { // assume spir-v
-                spirv_code = read_file_binary(path);
+                mapped.emplace(path);
+                spirv_code = {reinterpret_cast<const uint32_t *>(mapped->data().data()), mapped->size() / sizeof(uint32_t)};
             }
         }
 
-        m_module = m_context->device().createShaderModule({{}, spirv_code});
+        // reflection throws on SPIR-V it cannot handle, and nothing would destroy a module created before it
+        m_reflection = reflect_spirv(spirv_code);
+        m_module     = m_context->device().createShaderModule({{}, spirv_code.size_bytes(), spirv_code.data()});
     }
 
     std::shared_ptr<ShaderModule> ShaderModule::load(const std::shared_ptr<Context> &context, const ShaderModuleInfo &info) {
@@ -199,6 +216,12 @@ namespace neuron::render {
         return *this;
     }
 
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::add_spirv_shader(vk::ShaderStageFlagBits stage, std::span<const uint32_t> spirv) {
+        shader_stages.push_back(ShaderStageDefinition{.module = ShaderModuleInfo{.source = ShaderCode{.code = spirv}, .type = ShaderModuleSourceType::SPIRV, .stage = stage}, .stage = stage});
+
+        return *this;
+    }
+
     GraphicsPipelineBuilder &GraphicsPipelineBuilder::add_blend_attachment(const vk::PipelineColorBlendAttachmentState &blend_attachment) {
         color_blend_attachments.push_back(blend_attachment);
         return *this;
@@ -219,6 +242,13 @@ namespace neuron::render {
         return *this;
     }
 
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::set_vertex_pulling() {
+        vertex_bindings.clear();
+        vertex_attributes.clear();
+        derive_vertex_input = false;
+        return *this;
+    }
+
     GraphicsPipelineBuilder &GraphicsPipelineBuilder::add_standard_blend_attachment() {
         color_blend_attachments.emplace_back(true, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero,
                                              vk::BlendOp::eAdd,
@@ -290,26 +320,329 @@ namespace neuron::render {
         return *this;
     }
 
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::set_descriptor_set_layout(uint32_t set, const std::shared_ptr<DescriptorSetLayout> &set_layout) {
+        descriptor_set_layout_overrides[set] = set_layout;
+        return *this;
+    }
+
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::set_dynamic_pipeline_state(bool enable) {
+        dynamic_pipeline_state = enable;
+        return *this;
+    }
+
+    std::vector<vk::DynamicState> GraphicsPipelineBuilder::effective_dynamic_states(const Context &ctx) const {
+        std::vector<vk::DynamicState> states(dynamic_states.begin(), dynamic_states.end());
+        if (dynamic_pipeline_state) {
+            const auto supported = supported_dynamic_states(ctx);
+            states.insert(states.end(), supported.begin(), supported.end());
+        }
+
+        std::ranges::sort(states);
+        states.erase(std::ranges::unique(states).begin(), states.end());
+
+        auto has    = [&](vk::DynamicState state) { return std::ranges::binary_search(states, state); };
+        auto remove = [&](vk::DynamicState state) { std::erase(states, state); };
+
+        // mutually exclusive pairs: the with-count variants replace the plain ones, dynamic vertex input includes strides
+        if (has(vk::DynamicState::eViewportWithCountEXT)) {
+            remove(vk::DynamicState::eViewport);
+        }
+        if (has(vk::DynamicState::eScissorWithCountEXT)) {
+            remove(vk::DynamicState::eScissor);
+        }
+        if (has(vk::DynamicState::eVertexInputEXT)) {
+            remove(vk::DynamicState::eVertexInputBindingStrideEXT);
+        }
+
+        return states;
+    }
+
+    std::vector<uint64_t> GraphicsPipelineBuilder::state_key(const Context &ctx) const {
+        std::vector<uint64_t> key;
+        for (const auto part : {PipelineLibraryPart::VertexInput, PipelineLibraryPart::PreRasterization, PipelineLibraryPart::FragmentShader,
+                                PipelineLibraryPart::FragmentOutput}) {
+            const auto part_key = library_key(ctx, part);
+            key.insert(key.end(), part_key.begin(), part_key.end());
+        }
+        return key;
+    }
+
+    std::vector<uint64_t> GraphicsPipelineBuilder::library_key(const Context &ctx, PipelineLibraryPart part) const {
+        const auto states     = effective_dynamic_states(ctx);
+        auto       is_dynamic = [&](vk::DynamicState state) { return std::ranges::binary_search(states, state); };
+
+        std::vector<uint64_t> key;
+        auto                  push  = [&](auto value) { key.push_back(static_cast<uint64_t>(value)); };
+        auto                  pushf = [&](float value) { key.push_back(std::bit_cast<uint32_t>(value)); };
+
+        // the states of other parts are ignored by a library, so every part can get the whole list
+        push(part);
+        push(states.size());
+        for (const auto state : states) {
+            push(state);
+        }
+
+        auto push_stages = [&](bool fragment) {
+            for (const auto &sm : shader_stages) {
+                if ((sm.stage == vk::ShaderStageFlagBits::eFragment) != fragment) {
+                    continue;
+                }
+
+                push(static_cast<VkShaderStageFlags>(sm.stage));
+                switch (sm.module.index()) {
+                case 0:
+                    push(handle_bits(std::get<0>(sm.module)));
+                    break;
+                case 1:
+                    push(handle_bits(std::get<1>(sm.module)->module()));
+                    break;
+                default:
+                    throw std::runtime_error("state_key() needs loaded shader stages, call reflect() first");
+                }
+            }
+            push(layout ? handle_bits(layout->pipeline_layout()) : 0);
+        };
+
+        auto push_multisample = [&] {
+            push(static_cast<VkSampleCountFlags>(rasterization_samples));
+            push(enable_sample_shading);
+            pushf(min_sample_shading);
+            push(sample_mask.size());
+            for (const auto mask : sample_mask) {
+                push(mask);
+            }
+            push(enable_alpha_to_coverage);
+            push(enable_alpha_to_one);
+        };
+
+        switch (part) {
+        case PipelineLibraryPart::VertexInput: {
+            if (!is_dynamic(vk::DynamicState::eVertexInputEXT)) {
+                const bool dynamic_stride = is_dynamic(vk::DynamicState::eVertexInputBindingStrideEXT);
+
+                push(vertex_bindings.size());
+                for (const auto &b : vertex_bindings) {
+                    push(b.binding);
+                    push(dynamic_stride ? 0 : b.stride);
+                    push(b.inputRate);
+                }
+                push(vertex_attributes.size());
+                for (const auto &a : vertex_attributes) {
+                    push(a.location);
+                    push(a.binding);
+                    push(a.format);
+                    push(a.offset);
+                }
+            }
+
+            push(is_dynamic(vk::DynamicState::ePrimitiveTopologyEXT) ? topology_class(primitive_topology) : static_cast<uint64_t>(primitive_topology));
+            push(is_dynamic(vk::DynamicState::ePrimitiveRestartEnableEXT) ? 0 : enable_primitive_restart);
+        } break;
+
+        case PipelineLibraryPart::PreRasterization: {
+            push_stages(false);
+            push(patch_control_points);
+
+            // with-count states fix nothing, plain dynamic ones only the count
+            if (!is_dynamic(vk::DynamicState::eViewportWithCountEXT)) {
+                push(viewports.size());
+                if (!is_dynamic(vk::DynamicState::eViewport)) {
+                    for (const auto &v : viewports) {
+                        for (const float f : {v.x, v.y, v.width, v.height, v.minDepth, v.maxDepth}) {
+                            pushf(f);
+                        }
+                    }
+                }
+            }
+            if (!is_dynamic(vk::DynamicState::eScissorWithCountEXT)) {
+                push(scissors.size());
+                if (!is_dynamic(vk::DynamicState::eScissor)) {
+                    for (const auto &r : scissors) {
+                        push(static_cast<uint32_t>(r.offset.x));
+                        push(static_cast<uint32_t>(r.offset.y));
+                        push(r.extent.width);
+                        push(r.extent.height);
+                    }
+                }
+            }
+
+            push(is_dynamic(vk::DynamicState::eDepthClampEnableEXT) ? 0 : enable_depth_clamp);
+            push(is_dynamic(vk::DynamicState::eRasterizerDiscardEnableEXT) ? 0 : enable_rasterizer_discard);
+            push(is_dynamic(vk::DynamicState::ePolygonModeEXT) ? 0 : static_cast<uint64_t>(polygon_mode));
+            push(is_dynamic(vk::DynamicState::eCullModeEXT) ? 0 : static_cast<VkCullModeFlags>(cull_mode));
+            push(is_dynamic(vk::DynamicState::eFrontFaceEXT) ? 0 : static_cast<uint64_t>(front_face));
+            push(is_dynamic(vk::DynamicState::eDepthBiasEnableEXT) ? 0 : enable_depth_bias);
+            if (!is_dynamic(vk::DynamicState::eDepthBias)) {
+                pushf(depth_bias_constant_factor);
+                pushf(depth_bias_clamp);
+                pushf(depth_bias_slope_factor);
+            }
+            if (!is_dynamic(vk::DynamicState::eLineWidth)) {
+                pushf(line_width);
+            }
+        } break;
+
+        case PipelineLibraryPart::FragmentShader: {
+            push_stages(true);
+            push_multisample();
+
+            push(is_dynamic(vk::DynamicState::eDepthTestEnableEXT) ? 0 : enable_depth_test);
+            push(is_dynamic(vk::DynamicState::eDepthWriteEnableEXT) ? 0 : enable_depth_write);
+            push(is_dynamic(vk::DynamicState::eDepthCompareOpEXT) ? 0 : static_cast<uint64_t>(depth_compare_op));
+            push(is_dynamic(vk::DynamicState::eDepthBoundsTestEnableEXT) ? 0 : enable_depth_bounds_test);
+            push(is_dynamic(vk::DynamicState::eStencilTestEnableEXT) ? 0 : enable_stencil_test);
+            for (const auto &face : {stencil_front, stencil_back}) {
+                if (!is_dynamic(vk::DynamicState::eStencilOpEXT)) {
+                    push(face.failOp);
+                    push(face.passOp);
+                    push(face.depthFailOp);
+                    push(face.compareOp);
+                }
+                push(is_dynamic(vk::DynamicState::eStencilCompareMask) ? 0 : face.compareMask);
+                push(is_dynamic(vk::DynamicState::eStencilWriteMask) ? 0 : face.writeMask);
+                push(is_dynamic(vk::DynamicState::eStencilReference) ? 0 : face.reference);
+            }
+            if (!is_dynamic(vk::DynamicState::eDepthBounds)) {
+                pushf(min_depth_bounds);
+                pushf(max_depth_bounds);
+            }
+        } break;
+
+        case PipelineLibraryPart::FragmentOutput: {
+            push_multisample();
+
+            push(is_dynamic(vk::DynamicState::eLogicOpEnableEXT) ? 0 : enable_logic_op);
+            push(logic_op);
+            push(color_blend_attachments.size());
+            for (const auto &a : color_blend_attachments) {
+                push(is_dynamic(vk::DynamicState::eColorBlendEnableEXT) ? 0 : a.blendEnable);
+                if (!is_dynamic(vk::DynamicState::eColorBlendEquationEXT)) {
+                    push(a.srcColorBlendFactor);
+                    push(a.dstColorBlendFactor);
+                    push(a.colorBlendOp);
+                    push(a.srcAlphaBlendFactor);
+                    push(a.dstAlphaBlendFactor);
+                    push(a.alphaBlendOp);
+                }
+                push(is_dynamic(vk::DynamicState::eColorWriteMaskEXT) ? 0 : static_cast<VkColorComponentFlags>(a.colorWriteMask));
+            }
+            if (!is_dynamic(vk::DynamicState::eBlendConstants)) {
+                for (const float f : blend_constants) {
+                    pushf(f);
+                }
+            }
+
+            push(color_attachment_formats.size());
+            for (const auto format : color_attachment_formats) {
+                push(format);
+            }
+            push(depth_format);
+            push(stencil_format);
+        } break;
+        }
+
+        push(handle_bits(render_pass));
+        push(subpass);
+
+        return key;
+    }
+
+    size_t GraphicsPipelineBuilder::state_hash(const Context &ctx) const {
+        size_t seed = 0;
+        for (const uint64_t word : state_key(ctx)) {
+            hash_combine(seed, word);
+        }
+        return seed;
+    }
+
+    bool GraphicsPipelineBuilder::needs_reflection() const {
+        const bool unloaded = std::ranges::any_of(shader_stages, [](const ShaderStageDefinition &sm) { return sm.module.index() == 2; });
+        return !layout || unloaded || (derive_vertex_input && vertex_bindings.empty() && vertex_attributes.empty());
+    }
+
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::reflect(const std::shared_ptr<Context> &ctx) {
+        std::vector<const ShaderReflection *> reflections;
+        bool                                  reflectable = true;
+
+        // compiling GLSL dominates pipeline build time, so stages load in parallel
+        std::vector<size_t> to_load;
+        for (size_t i = 0; i < shader_stages.size(); i++) {
+            if (shader_stages[i].module.index() == 2) {
+                to_load.push_back(i);
+            }
+        }
+
+        jobs::JobSystem::global()->parallel_for(0, to_load.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto &sm  = shader_stages[to_load[i]];
+                sm.module = ShaderModule::load(ctx, std::get<2>(sm.module));
+            }
+        });
+
+        for (auto &sm : shader_stages) {
+            if (sm.module.index() == 1) {
+                reflections.push_back(&std::get<1>(sm.module)->reflection());
+            } else {
+                reflectable = false;
+            }
+        }
+
+        if (!layout) {
+            if (!reflectable) {
+                throw std::runtime_error("Cannot derive a pipeline layout from raw vk::ShaderModule stages");
+            }
+
+            layout = build_pipeline_layout(ctx, merge_reflections(reflections, canonicalize_layout), descriptor_set_layout_overrides);
+        }
+
+        if (derive_vertex_input && vertex_bindings.empty() && vertex_attributes.empty()) {
+            for (const ShaderReflection *r : reflections) {
+                if (r->stage != vk::ShaderStageFlagBits::eVertex) {
+                    continue;
+                }
+
+                uint32_t offset = 0;
+                for (const auto &input : r->vertex_inputs) {
+                    if (input.format == vk::Format::eUndefined) {
+                        throw std::runtime_error("Cannot derive vertex input format from shader");
+                    }
+
+                    add_vertex_attribute(0, input.location, input.format, offset);
+                    offset += input.size;
+                }
+
+                if (offset > 0) {
+                    add_vertex_binding(0, offset);
+                }
+            }
+        }
+
+        return *this;
+    }
+
     std::shared_ptr<GraphicsPipeline> GraphicsPipelineBuilder::build(const std::shared_ptr<Context> &ctx) {
+        if (needs_reflection()) {
+            reflect(ctx);
+        }
+
         return std::make_shared<GraphicsPipeline>(ctx, *this);
     }
 
-    GraphicsPipeline::GraphicsPipeline(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder) : m_context(context) {
-        std::vector<vk::PipelineShaderStageCreateInfo> stages;
-
+    GraphicsPipelineCreateInfo::GraphicsPipelineCreateInfo(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder)
+        : dynamic_states(builder.effective_dynamic_states(*context)) {
         for (const auto &sm : builder.shader_stages) {
             switch (sm.module.index()) {
             case 0: {
                 stages.push_back(vk::PipelineShaderStageCreateInfo({}, sm.stage, std::get<0>(sm.module), "main"));
             } break;
             case 1: {
-                m_shader_modules.push_back(std::get<1>(sm.module));
+                shader_modules.push_back(std::get<1>(sm.module));
                 stages.push_back(vk::PipelineShaderStageCreateInfo({}, sm.stage, std::get<1>(sm.module)->module(), "main"));
             } break;
 
             case 2: {
-                auto mod = ShaderModule::load(m_context, std::get<2>(sm.module));
-                m_shader_modules.push_back(mod);
+                auto mod = ShaderModule::load(context, std::get<2>(sm.module));
+                shader_modules.push_back(mod);
                 stages.push_back(vk::PipelineShaderStageCreateInfo({}, sm.stage, mod->module(), "main"));
             } break;
             default:
@@ -317,32 +650,39 @@ namespace neuron::render {
             }
         }
 
-        std::vector<vk::DynamicState> dynamic_states(builder.dynamic_states.begin(), builder.dynamic_states.end());
+        auto is_dynamic = [&](vk::DynamicState state) { return std::ranges::binary_search(dynamic_states, state); };
 
-        vk::PipelineDynamicStateCreateInfo dynamic_state{};
         dynamic_state.setDynamicStates(dynamic_states);
 
 
-        vk::PipelineVertexInputStateCreateInfo vertex_input_state{};
         vertex_input_state.setVertexAttributeDescriptions(builder.vertex_attributes);
         vertex_input_state.setVertexBindingDescriptions(builder.vertex_bindings);
 
 
-        vk::PipelineInputAssemblyStateCreateInfo input_assembly_state{};
         input_assembly_state.setTopology(builder.primitive_topology);
         input_assembly_state.setPrimitiveRestartEnable(builder.enable_primitive_restart);
 
 
-        vk::PipelineTessellationStateCreateInfo tessellation_state{};
         tessellation_state.setPatchControlPoints(builder.patch_control_points);
 
 
-        vk::PipelineViewportStateCreateInfo viewport_state{};
-        viewport_state.setViewports(builder.viewports);
-        viewport_state.setScissors(builder.scissors); // TODO: adders for these two in the builder struct
+        // with-count dynamic states need a count of zero, plain dynamic ones at least one
+        if (is_dynamic(vk::DynamicState::eViewportWithCountEXT)) {
+            viewport_state.setViewportCount(0);
+        } else if (is_dynamic(vk::DynamicState::eViewport)) {
+            viewport_state.setViewportCount(std::max<uint32_t>(1, static_cast<uint32_t>(builder.viewports.size())));
+        } else {
+            viewport_state.setViewports(builder.viewports);
+        }
+        if (is_dynamic(vk::DynamicState::eScissorWithCountEXT)) {
+            viewport_state.setScissorCount(0);
+        } else if (is_dynamic(vk::DynamicState::eScissor)) {
+            viewport_state.setScissorCount(std::max<uint32_t>(1, static_cast<uint32_t>(builder.scissors.size())));
+        } else {
+            viewport_state.setScissors(builder.scissors);
+        }
 
 
-        vk::PipelineRasterizationStateCreateInfo rasterization_state{};
         rasterization_state.setDepthClampEnable(builder.enable_depth_clamp);
         rasterization_state.setRasterizerDiscardEnable(builder.enable_rasterizer_discard);
         rasterization_state.setPolygonMode(builder.polygon_mode);
@@ -355,7 +695,6 @@ namespace neuron::render {
         rasterization_state.setLineWidth(builder.line_width);
 
 
-        vk::PipelineMultisampleStateCreateInfo multisample_state{};
         multisample_state.setRasterizationSamples(builder.rasterization_samples);
         multisample_state.setSampleShadingEnable(builder.enable_sample_shading);
         multisample_state.setMinSampleShading(builder.min_sample_shading);
@@ -364,7 +703,6 @@ namespace neuron::render {
         multisample_state.setAlphaToOneEnable(builder.enable_alpha_to_one);
 
 
-        vk::PipelineDepthStencilStateCreateInfo depth_stencil_state{};
         depth_stencil_state.setDepthTestEnable(builder.enable_depth_test);
         depth_stencil_state.setDepthWriteEnable(builder.enable_depth_write);
         depth_stencil_state.setDepthCompareOp(builder.depth_compare_op);
@@ -375,44 +713,92 @@ namespace neuron::render {
         depth_stencil_state.setMinDepthBounds(builder.min_depth_bounds);
         depth_stencil_state.setMaxDepthBounds(builder.max_depth_bounds);
 
-        vk::PipelineColorBlendStateCreateInfo color_blend_state{};
         color_blend_state.setLogicOpEnable(builder.enable_logic_op);
         color_blend_state.setLogicOp(builder.logic_op);
         color_blend_state.setAttachments(builder.color_blend_attachments);
         color_blend_state.setBlendConstants(builder.blend_constants);
 
-        vk::PipelineRenderingCreateInfo pipeline_rendering{};
-        pipeline_rendering.setColorAttachmentFormats(builder.color_attachment_formats);
-        pipeline_rendering.setDepthAttachmentFormat(builder.depth_format);
-        pipeline_rendering.setStencilAttachmentFormat(builder.stencil_format);
+        rendering.setColorAttachmentFormats(builder.color_attachment_formats);
+        rendering.setDepthAttachmentFormat(builder.depth_format);
+        rendering.setStencilAttachmentFormat(builder.stencil_format);
+
+
+        create_info.setStages(stages);
+        create_info.setPVertexInputState(is_dynamic(vk::DynamicState::eVertexInputEXT) ? nullptr : &vertex_input_state);
+        create_info.setPInputAssemblyState(&input_assembly_state);
+        create_info.setPTessellationState(&tessellation_state);
+        create_info.setPViewportState(&viewport_state);
+        create_info.setPRasterizationState(&rasterization_state);
+        create_info.setPMultisampleState(&multisample_state);
+        create_info.setPDepthStencilState(&depth_stencil_state);
+        create_info.setPColorBlendState(&color_blend_state);
+        create_info.setPDynamicState(&dynamic_state);
+        create_info.setLayout(builder.layout->pipeline_layout());
+        create_info.setRenderPass(builder.render_pass);
+        create_info.setSubpass(builder.subpass);
+        create_info.setBasePipelineHandle(builder.base_pipeline);
+        create_info.setBasePipelineIndex(builder.base_pipeline_index);
+
+        create_info.pNext = &rendering;
+
+        pipeline_cache = builder.pipeline_cache ? builder.pipeline_cache : context->pipeline_cache();
+    }
+
+    GraphicsPipeline::GraphicsPipeline(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder) : m_context(context), m_layout(builder.layout) {
+        const GraphicsPipelineCreateInfo info(context, builder);
 
+        m_shader_modules = info.shader_modules;
+        m_dynamic_states = info.dynamic_states;
 
-        vk::GraphicsPipelineCreateInfo pipeline_create_info = {};
-        pipeline_create_info.setStages(stages);
-        pipeline_create_info.setPVertexInputState(&vertex_input_state);
-        pipeline_create_info.setPInputAssemblyState(&input_assembly_state);
-        pipeline_create_info.setPTessellationState(&tessellation_state);
-        pipeline_create_info.setPViewportState(&viewport_state);
-        pipeline_create_info.setPRasterizationState(&rasterization_state);
-        pipeline_create_info.setPMultisampleState(&multisample_state);
-        pipeline_create_info.setPDepthStencilState(&depth_stencil_state);
-        pipeline_create_info.setPColorBlendState(&color_blend_state);
-        pipeline_create_info.setPDynamicState(&dynamic_state);
-        pipeline_create_info.setLayout(builder.layout->pipeline_layout());
-        pipeline_create_info.setRenderPass(builder.render_pass);
-        pipeline_create_info.setSubpass(builder.subpass);
-        pipeline_create_info.setBasePipelineHandle(builder.base_pipeline);
-        pipeline_create_info.setBasePipelineIndex(builder.base_pipeline_index);
+        // TODO: do something sort of checking on the actual result.
+        m_pipeline = static_cast<VkPipeline>(m_context->device().createGraphicsPipeline(info.pipeline_cache, info.create_info).value);
+    }
 
-        pipeline_create_info.pNext = &pipeline_rendering;
-        GraphicsPipelineBuilder &add_scissor(const vk::Offset2D &offset, const vk::Extent2D &extent);
+    GraphicsPipeline::GraphicsPipeline(const std::shared_ptr<Context> &context, const std::shared_ptr<PipelineLayout> &layout, std::vector<vk::DynamicState> dynamic_states,
+                                       vk::Pipeline pipeline, std::vector<std::shared_ptr<PipelineLibrary>> libraries)
+        : m_context(context), m_layout(layout), m_dynamic_states(std::move(dynamic_states)), m_libraries(std::move(libraries)), m_pipeline(static_cast<VkPipeline>(pipeline)) {}
 
+    GraphicsPipeline::~GraphicsPipeline() {
+        m_context->device().destroyPipeline(pipeline());
+        if (m_replaced) {
+            m_context->device().destroyPipeline(m_replaced);
+        }
+    }
 
-        m_pipeline =
-            m_context->device().createGraphicsPipeline(m_context->pipeline_cache(), pipeline_create_info).value; // TODO: do something sort of checking on the actual result.
+    void GraphicsPipeline::replace(vk::Pipeline pipeline) {
+        // command buffers recorded with the old pipeline may still be pending, so it lives as long as this
+        m_replaced = vk::Pipeline(m_pipeline.exchange(static_cast<VkPipeline>(pipeline), std::memory_order_acq_rel));
     }
 
-    GraphicsPipeline::~GraphicsPipeline() {
-        m_context->device().destroyPipeline(m_pipeline);
+    std::shared_ptr<GraphicsPipeline> GraphicsPipelineCache::get_or_create(const std::shared_ptr<Context> &context, GraphicsPipelineBuilder &builder) {
+        if (builder.needs_reflection()) {
+            builder.reflect(context);
+        }
+
+        auto         key  = builder.state_key(*context);
+        const size_t hash = builder.state_hash(*context);
+
+        std::lock_guard lock(m_mutex);
+
+        auto [begin, end] = m_pipelines.equal_range(hash);
+        for (auto it = begin; it != end;) {
+            if (auto pipeline = it->second.second.lock()) {
+                if (it->second.first == key) {
+                    return pipeline;
+                }
+                ++it;
+            } else {
+                it = m_pipelines.erase(it);
+            }
+        }
+
+        auto pipeline = std::make_shared<GraphicsPipeline>(context, builder);
+        m_pipelines.emplace(hash, std::make_pair(std::move(key), pipeline));
+        return pipeline;
+    }
+
+    size_t GraphicsPipelineCache::size() const {
+        std::lock_guard lock(m_mutex);
+        return m_pipelines.size();
     }
 } // namespace neuron::render
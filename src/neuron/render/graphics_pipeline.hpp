@@ -3,8 +3,14 @@
 #include "neuron/base.hpp"
 #include "neuron/neuron.hpp"
 #include "pipeline_layout.hpp"
+#include "shader_reflection.hpp"
 
+#include <atomic>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 
 #include <glm/glm.hpp>
 
@@ -12,8 +18,10 @@ namespace neuron::render {
 
     enum class ShaderModuleSourceType { SPIRV, GLSL };
 
+    // GLSL source, or SPIR-V; the span form refers to SPIR-V that outlives the ShaderModule, such as the arrays
+    // neuron_embed_shaders() generates.
     struct ShaderCode {
-        std::variant<std::string, std::vector<uint32_t>> code;
+        std::variant<std::string, std::vector<uint32_t>, std::span<const uint32_t>> code;
     };
 
     using ShaderModuleCodeSource = std::variant<std::filesystem::path, ShaderCode>;
@@ -40,9 +48,12 @@ namespace neuron::render {
 
         [[nodiscard]] inline vk::ShaderModule module() const { return m_module; }
 
+        [[nodiscard]] inline const ShaderReflection &reflection() const { return m_reflection; }
+
       private:
         std::shared_ptr<Context> m_context;
         vk::ShaderModule         m_module;
+        ShaderReflection         m_reflection;
     };
 
     using ShaderModuleSource = std::variant<vk::ShaderModule, std::shared_ptr<ShaderModule>, ShaderModuleInfo>;
@@ -55,6 +66,9 @@ namespace neuron::render {
 
     class GraphicsPipeline;
 
+    // The four independently compiled parts of a graphics pipeline (VK_EXT_graphics_pipeline_library).
+    enum class PipelineLibraryPart { VertexInput, PreRasterization, FragmentShader, FragmentOutput };
+
     struct NEURON_API GraphicsPipelineBuilder {
         std::vector<ShaderStageDefinition>               shader_stages;
         std::unordered_set<vk::DynamicState>             dynamic_states;
@@ -103,13 +117,28 @@ namespace neuron::render {
         std::vector<vk::PipelineColorBlendAttachmentState> color_blend_attachments;
         std::array<float, 4>                               blend_constants = {0.0f, 0.0f, 0.0f, 0.0f};
 
-        std::shared_ptr<PipelineLayout> layout;
+        // When null the layout is derived from the shaders' SPIR-V, see reflect().
+        std::shared_ptr<PipelineLayout>                          layout;
+        std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> descriptor_set_layout_overrides;
+        bool                                                     canonicalize_layout = true;
+
+        // Fill vertex bindings/attributes from the vertex shader inputs (one tightly packed binding 0) when none were added.
+        bool derive_vertex_input = true;
+
+        // Leave every state supported_dynamic_states() lists dynamic, to be set with a DynamicStateTracker. Those states
+        // are not part of state_key(), so builders that only differ in them map to one pipeline in a GraphicsPipelineCache.
+        // The fields here still give the topology class and the attachment count.
+        bool dynamic_pipeline_state = false;
+
         vk::RenderPass                  render_pass = nullptr;
         uint32_t                        subpass     = 0;
 
         vk::Pipeline base_pipeline       = VK_NULL_HANDLE;
         int32_t      base_pipeline_index = -1;
 
+        // When null the Context's pipeline cache is used.
+        vk::PipelineCache pipeline_cache = VK_NULL_HANDLE;
+
         std::vector<vk::Format> color_attachment_formats;
         vk::Format              depth_format;
         vk::Format              stencil_format;
@@ -119,10 +148,14 @@ namespace neuron::render {
         GraphicsPipelineBuilder &add_shader(vk::ShaderStageFlagBits stage, const ShaderModuleInfo &module);
         GraphicsPipelineBuilder &add_shader(ShaderModuleSourceType source_type, vk::ShaderStageFlagBits stage, const ShaderModuleCodeSource &source);
         GraphicsPipelineBuilder &add_glsl_shader(const std::filesystem::path &path);
+        // The SPIR-V is not copied and must outlive the pipeline's shader module.
+        GraphicsPipelineBuilder &add_spirv_shader(vk::ShaderStageFlagBits stage, std::span<const uint32_t> spirv);
         GraphicsPipelineBuilder &add_blend_attachment(const vk::PipelineColorBlendAttachmentState &blend_attachment);
         GraphicsPipelineBuilder &add_dynamic_state(vk::DynamicState state);
         GraphicsPipelineBuilder &add_vertex_binding(uint32_t binding, uint32_t stride, vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex);
         GraphicsPipelineBuilder &add_vertex_attribute(uint32_t binding, uint32_t location, vk::Format format, uint32_t offset);
+        // Empty vertex input state; the vertex shader fetches its vertices through a buffer address, see vertex_pulling.hpp.
+        GraphicsPipelineBuilder &set_vertex_pulling();
         GraphicsPipelineBuilder &add_standard_blend_attachment();
         GraphicsPipelineBuilder &add_viewport(const glm::fvec2& pos, const vk::Extent2D& extent, float min_depth, float max_depth);
         GraphicsPipelineBuilder &add_viewport(const glm::fvec2& pos, const glm::fvec2& extent, float min_depth, float max_depth);
@@ -134,26 +167,109 @@ namespace neuron::render {
         GraphicsPipelineBuilder &set_stencil_attachment_format(vk::Format format);
         GraphicsPipelineBuilder &set_blend_attachment(size_t index, const vk::PipelineColorBlendAttachmentState& blend_attachment);
         GraphicsPipelineBuilder &set_standard_blend_attachment(size_t index);
+        GraphicsPipelineBuilder &set_descriptor_set_layout(uint32_t set, const std::shared_ptr<DescriptorSetLayout> &set_layout);
+        GraphicsPipelineBuilder &set_dynamic_pipeline_state(bool enable = true);
+
+        // dynamic_states plus, with dynamic_pipeline_state, the supported ones; sorted
+        [[nodiscard]] std::vector<vk::DynamicState> effective_dynamic_states(const Context &ctx) const;
+
+        // Everything baked into the pipeline, for deduplication. Needs loaded shader stages (see reflect()).
+        [[nodiscard]] std::vector<uint64_t> state_key(const Context &ctx) const;
+        [[nodiscard]] size_t                state_hash(const Context &ctx) const;
+
+        // The part of state_key() that one pipeline library is built from; state_key() is the four of them.
+        [[nodiscard]] std::vector<uint64_t> library_key(const Context &ctx, PipelineLibraryPart part) const;
+
+        [[nodiscard]] bool needs_reflection() const;
+
+        // Loads the shader modules and derives whatever was left unspecified (layout, vertex input) from their SPIR-V.
+        // Called by build() when needed.
+        GraphicsPipelineBuilder &reflect(const std::shared_ptr<Context> &ctx);
 
         std::shared_ptr<GraphicsPipeline> build(const std::shared_ptr<Context> &ctx);
 
+        inline GraphicsPipelineBuilder() = default;
         explicit inline GraphicsPipelineBuilder(const std::shared_ptr<PipelineLayout> &layout_) : layout(layout_) {}
     };
 
+    // The create info a builder describes, together with the state it points to. Shared by monolithic pipelines and
+    // pipeline libraries; not copyable since create_info points into it.
+    struct NEURON_API GraphicsPipelineCreateInfo {
+        GraphicsPipelineCreateInfo(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder);
+
+        GraphicsPipelineCreateInfo(const GraphicsPipelineCreateInfo &other)            = delete;
+        GraphicsPipelineCreateInfo &operator=(const GraphicsPipelineCreateInfo &other) = delete;
+
+        std::vector<std::shared_ptr<ShaderModule>>     shader_modules;
+        std::vector<vk::PipelineShaderStageCreateInfo> stages;
+        std::vector<vk::DynamicState>                  dynamic_states;
+
+        vk::PipelineDynamicStateCreateInfo       dynamic_state;
+        vk::PipelineVertexInputStateCreateInfo   vertex_input_state;
+        vk::PipelineInputAssemblyStateCreateInfo input_assembly_state;
+        vk::PipelineTessellationStateCreateInfo  tessellation_state;
+        vk::PipelineViewportStateCreateInfo      viewport_state;
+        vk::PipelineRasterizationStateCreateInfo rasterization_state;
+        vk::PipelineMultisampleStateCreateInfo   multisample_state;
+        vk::PipelineDepthStencilStateCreateInfo  depth_stencil_state;
+        vk::PipelineColorBlendStateCreateInfo    color_blend_state;
+        vk::PipelineRenderingCreateInfo          rendering;
+
+        vk::GraphicsPipelineCreateInfo create_info;
+        vk::PipelineCache              pipeline_cache;
+    };
+
+    class PipelineLibrary;
+
     class NEURON_API GraphicsPipeline {
       public:
         GraphicsPipeline(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder);
 
+        // Takes ownership of a pipeline linked from libraries, see PipelineLibraryCache.
+        GraphicsPipeline(const std::shared_ptr<Context> &context, const std::shared_ptr<PipelineLayout> &layout, std::vector<vk::DynamicState> dynamic_states,
+                         vk::Pipeline pipeline, std::vector<std::shared_ptr<PipelineLibrary>> libraries);
+
         ~GraphicsPipeline();
 
-        [[nodiscard]] inline vk::Pipeline pipeline() const { return m_pipeline; }
+        GraphicsPipeline(const GraphicsPipeline &other)            = delete;
+        GraphicsPipeline &operator=(const GraphicsPipeline &other) = delete;
+
+        // May change once, when a background link-time optimized pipeline replaces a fast-linked one.
+        [[nodiscard]] inline vk::Pipeline pipeline() const { return vk::Pipeline(m_pipeline.load(std::memory_order_acquire)); }
+
+        [[nodiscard]] inline const std::shared_ptr<PipelineLayout> &layout() const { return m_layout; }
+
+        // sorted
+        [[nodiscard]] inline const std::vector<vk::DynamicState> &dynamic_states() const { return m_dynamic_states; }
 
       private:
-        std::shared_ptr<Context>                   m_context;
-        std::vector<std::shared_ptr<ShaderModule>> m_shader_modules;
+        friend class PipelineLibraryCache;
+
+        void replace(vk::Pipeline pipeline);
+
+        std::shared_ptr<Context>                      m_context;
+        std::shared_ptr<PipelineLayout>               m_layout;
+        std::vector<std::shared_ptr<ShaderModule>>    m_shader_modules;
+        std::vector<vk::DynamicState>                 m_dynamic_states;
+        std::vector<std::shared_ptr<PipelineLibrary>> m_libraries;
 
+        std::atomic<VkPipeline> m_pipeline;
+        vk::Pipeline            m_replaced;
+    };
+
+    // Dedupes pipelines by GraphicsPipelineBuilder::state_key(). Entries are held weakly, a pipeline lives as long as
+    // something uses it.
+    class NEURON_API GraphicsPipelineCache {
+      public:
+        // Reflects the builder first when build() would.
+        std::shared_ptr<GraphicsPipeline> get_or_create(const std::shared_ptr<Context> &context, GraphicsPipelineBuilder &builder);
+
+        [[nodiscard]] size_t size() const;
+
+      private:
+        mutable std::mutex m_mutex;
 
-        vk::Pipeline m_pipeline;
+        std::unordered_multimap<size_t, std::pair<std::vector<uint64_t>, std::weak_ptr<GraphicsPipeline>>> m_pipelines;
     };
 
 } // namespace neuron::render
@@ -0,0 +1,358 @@
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+namespace neuron::render {
+    namespace {
+        struct VertexBitsHash {
+            size_t operator()(const MeshVertex &v) const { return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(&v), sizeof(MeshVertex))); }
+        };
+
+        struct VertexBitsEqual {
+            bool operator()(const MeshVertex &a, const MeshVertex &b) const { return std::memcmp(&a, &b, sizeof(MeshVertex)) == 0; }
+        };
+
+        // Tuning constants from Forsyth, "Linear-Speed Vertex Cache Optimisation".
+        constexpr uint32_t CACHE_SIZE          = 32;
+        constexpr float    CACHE_DECAY_POWER   = 1.5f;
+        constexpr float    LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float    VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float    VALENCE_BOOST_POWER = 0.5f;
+
+        float vertex_score(int32_t cache_position, uint32_t remaining_triangles) {
+            if (remaining_triangles == 0) {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+            if (cache_position >= 0) {
+                if (cache_position < 3) {
+                    score = LAST_TRIANGLE_SCORE;
+                } else {
+                    const float scaler = 1.0f / static_cast<float>(CACHE_SIZE - 3);
+                    score              = std::pow(1.0f - static_cast<float>(cache_position - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+
+            score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining_triangles), -VALENCE_BOOST_POWER);
+            return score;
+        }
+
+        int16_t to_snorm16(float v) { return static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f)); }
+
+        uint8_t to_unorm8(float v) { return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); }
+
+        glm::vec2 octahedral_encode(glm::vec3 n) {
+            const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+            if (l1 == 0.0f) {
+                return {0.0f, 0.0f};
+            }
+            n /= l1;
+
+            if (n.z >= 0.0f) {
+                return {n.x, n.y};
+            }
+
+            auto sign_not_zero = [](float f) { return f >= 0.0f ? 1.0f : -1.0f; };
+            return {(1.0f - std::abs(n.y)) * sign_not_zero(n.x), (1.0f - std::abs(n.x)) * sign_not_zero(n.y)};
+        }
+
+        template <typename T>
+        void write_bytes(std::byte *dst, const T &value) {
+            std::memcpy(dst, &value, sizeof(T));
+        }
+    } // namespace
+
+    MeshData build_indexed_mesh(std::span<const MeshVertex> triangle_soup) {
+        if (triangle_soup.size() % 3 != 0) {
+            throw std::runtime_error("Triangle soup vertex count must be a multiple of 3");
+        }
+
+        MeshData mesh;
+        mesh.indices.reserve(triangle_soup.size());
+
+        std::unordered_map<MeshVertex, uint32_t, VertexBitsHash, VertexBitsEqual> unique;
+        unique.reserve(triangle_soup.size());
+
+        for (const auto &vertex : triangle_soup) {
+            auto [it, inserted] = unique.try_emplace(vertex, static_cast<uint32_t>(mesh.vertices.size()));
+            if (inserted) {
+                mesh.vertices.push_back(vertex);
+            }
+            mesh.indices.push_back(it->second);
+        }
+
+        return mesh;
+    }
+
+    void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count) {
+        const size_t triangle_count = indices.size() / 3;
+        if (triangle_count < 2) {
+            return;
+        }
+
+        // per-vertex list of triangles not yet emitted; remaining[v] is the live length of v's list
+        std::vector<uint32_t> remaining(vertex_count, 0);
+        for (size_t i = 0; i < triangle_count * 3; i++) {
+            if (indices[i] >= vertex_count) {
+                throw std::runtime_error("Index out of range in optimize_vertex_cache");
+            }
+            remaining[indices[i]]++;
+        }
+
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; v++) {
+            offsets[v + 1] = offsets[v] + remaining[v];
+        }
+
+        std::vector<uint32_t> adjacency(triangle_count * 3);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangle_count; t++) {
+            for (size_t k = 0; k < 3; k++) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<int32_t> cache_position(vertex_count, -1);
+        std::vector<float>   score(vertex_count);
+        for (size_t v = 0; v < vertex_count; v++) {
+            score[v] = vertex_score(-1, remaining[v]);
+        }
+
+        auto triangle_score = [&](size_t t) { return score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]]; };
+
+        std::vector<float> tri_score(triangle_count);
+        std::vector<bool>  emitted(triangle_count, false);
+        for (size_t t = 0; t < triangle_count; t++) {
+            tri_score[t] = triangle_score(t);
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(triangle_count * 3);
+
+        std::array<uint32_t, CACHE_SIZE + 3> cache{};
+        std::array<uint32_t, CACHE_SIZE + 3> next_cache{};
+        size_t                               cache_count = 0;
+
+        size_t scan_cursor = 0;
+        auto   best        = static_cast<int64_t>(std::max_element(tri_score.begin(), tri_score.end()) - tri_score.begin());
+
+        while (best >= 0) {
+            const auto t = static_cast<size_t>(best);
+            emitted[t]   = true;
+
+            size_t next_count = 0;
+            for (size_t k = 0; k < 3; k++) {
+                const uint32_t v = indices[t * 3 + k];
+                output.push_back(v);
+
+                auto       begin = adjacency.begin() + offsets[v];
+                const auto end   = begin + remaining[v];
+                std::iter_swap(std::find(begin, end, static_cast<uint32_t>(t)), end - 1);
+                remaining[v]--;
+
+                if (std::find(next_cache.begin(), next_cache.begin() + next_count, v) == next_cache.begin() + next_count) {
+                    next_cache[next_count++] = v;
+                }
+            }
+
+            const size_t triangle_vertices = next_count;
+            for (size_t i = 0; i < cache_count; i++) {
+                const uint32_t v = cache[i];
+                if (std::find(next_cache.begin(), next_cache.begin() + triangle_vertices, v) == next_cache.begin() + triangle_vertices) {
+                    next_cache[next_count++] = v;
+                }
+            }
+
+            // vertices past CACHE_SIZE just fell out of the cache
+            for (size_t i = 0; i < next_count; i++) {
+                const uint32_t v  = next_cache[i];
+                cache_position[v] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+                score[v]          = vertex_score(cache_position[v], remaining[v]);
+            }
+
+            best             = -1;
+            float best_score = -std::numeric_limits<float>::infinity();
+            for (size_t i = 0; i < next_count; i++) {
+                const uint32_t v = next_cache[i];
+                for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                    const uint32_t adjacent = adjacency[a];
+                    tri_score[adjacent]     = triangle_score(adjacent);
+                    if (tri_score[adjacent] > best_score) {
+                        best_score = tri_score[adjacent];
+                        best       = adjacent;
+                    }
+                }
+            }
+
+            cache_count = std::min<size_t>(next_count, CACHE_SIZE);
+            std::copy_n(next_cache.begin(), cache_count, cache.begin());
+
+            if (best < 0) {
+                while (scan_cursor < triangle_count && emitted[scan_cursor]) {
+                    scan_cursor++;
+                }
+                if (scan_cursor < triangle_count) {
+                    best = static_cast<int64_t>(scan_cursor);
+                }
+            }
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void optimize_vertex_fetch(MeshData &mesh) {
+        constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+        std::vector<MeshVertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        for (auto &index : mesh.indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        mesh.vertices = std::move(vertices);
+    }
+
+    GraphicsPipelineBuilder &MeshVertexLayout::apply(GraphicsPipelineBuilder &builder, uint32_t binding) const {
+        builder.add_vertex_binding(binding, stride);
+        for (const auto &attribute : attributes) {
+            builder.add_vertex_attribute(binding, attribute.location, attribute.format, attribute.offset);
+        }
+        return builder;
+    }
+
+    QuantizedMesh quantize_mesh(const MeshData &mesh, const MeshQuantizeSettings &settings) {
+        QuantizedMesh result;
+        result.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+        result.index_count  = static_cast<uint32_t>(mesh.indices.size());
+
+        uint32_t location = 0;
+        uint32_t offset   = 0;
+
+        result.layout.attributes.push_back({location++, vk::Format::eR16G16B16A16Snorm, offset});
+        offset += 4 * sizeof(int16_t);
+
+        const uint32_t normal_offset = offset;
+        if (settings.include_normals) {
+            result.layout.attributes.push_back({location++, vk::Format::eR16G16Snorm, offset});
+            offset += 2 * sizeof(int16_t);
+        }
+
+        const uint32_t color_offset = offset;
+        if (settings.include_colors) {
+            result.layout.attributes.push_back({location++, vk::Format::eR8G8B8A8Unorm, offset});
+            offset += 4 * sizeof(uint8_t);
+        }
+
+        result.layout.stride = offset;
+
+        if (!mesh.vertices.empty()) {
+            glm::vec3 min = mesh.vertices.front().position;
+            glm::vec3 max = min;
+            for (const auto &vertex : mesh.vertices) {
+                min = glm::min(min, vertex.position);
+                max = glm::max(max, vertex.position);
+            }
+
+            result.position_offset = (min + max) * 0.5f;
+            result.position_scale  = glm::max((max - min) * 0.5f, glm::vec3(std::numeric_limits<float>::min()));
+        }
+
+        result.vertex_data.resize(static_cast<size_t>(result.vertex_count) * result.layout.stride);
+        std::byte *dst = result.vertex_data.data();
+        for (const auto &vertex : mesh.vertices) {
+            const glm::vec3 p = (vertex.position - result.position_offset) / result.position_scale;
+            write_bytes(dst, std::array<int16_t, 4>{to_snorm16(p.x), to_snorm16(p.y), to_snorm16(p.z), 32767});
+
+            if (settings.include_normals) {
+                const glm::vec2 e = octahedral_encode(vertex.normal);
+                write_bytes(dst + normal_offset, std::array<int16_t, 2>{to_snorm16(e.x), to_snorm16(e.y)});
+            }
+
+            if (settings.include_colors) {
+                const glm::vec4 &c = vertex.color;
+                write_bytes(dst + color_offset, std::array<uint8_t, 4>{to_unorm8(c.r), to_unorm8(c.g), to_unorm8(c.b), to_unorm8(c.a)});
+            }
+
+            dst += result.layout.stride;
+        }
+
+        // 0xFFFF stays free so primitive restart can be enabled on the pipeline
+        if (settings.allow_16bit_indices && result.vertex_count <= 0xFFFF) {
+            result.index_type = vk::IndexType::eUint16;
+            result.index_data.resize(mesh.indices.size() * sizeof(uint16_t));
+            for (size_t i = 0; i < mesh.indices.size(); i++) {
+                write_bytes(result.index_data.data() + i * sizeof(uint16_t), static_cast<uint16_t>(mesh.indices[i]));
+            }
+        } else {
+            result.index_type = vk::IndexType::eUint32;
+            result.index_data.resize(mesh.indices.size() * sizeof(uint32_t));
+            std::memcpy(result.index_data.data(), mesh.indices.data(), result.index_data.size());
+        }
+
+        return result;
+    }
+
+    QuantizedMesh prepare_mesh(std::span<const MeshVertex> triangle_soup, const MeshQuantizeSettings &settings) {
+        MeshData mesh = build_indexed_mesh(triangle_soup);
+        optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+        optimize_vertex_fetch(mesh);
+        return quantize_mesh(mesh, settings);
+    }
+
+    Mesh::Mesh(const std::shared_ptr<Context> &context, const QuantizedMesh &mesh)
+        : m_context(context), m_index_count(mesh.index_count), m_index_type(mesh.index_type), m_position_scale(mesh.position_scale),
+          m_position_offset(mesh.position_offset), m_layout(mesh.layout) {
+        if (mesh.vertex_data.empty() || mesh.index_data.empty()) {
+            throw std::runtime_error("Cannot create an empty mesh");
+        }
+
+        // readable through a buffer address as well, for pipelines built with set_vertex_pulling()
+        const bool           pullable     = m_context->enabled_features().buffer_device_address;
+        vk::BufferUsageFlags vertex_usage = vk::BufferUsageFlagBits::eVertexBuffer;
+        if (pullable) {
+            vertex_usage |= vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+        }
+
+        m_vertex_buffer = m_context->allocate_gpu_buffer(mesh.vertex_data.size(), mesh.vertex_data.data(), vertex_usage);
+        m_index_buffer  = m_context->allocate_gpu_buffer(mesh.index_data.size(), mesh.index_data.data(), vk::BufferUsageFlagBits::eIndexBuffer);
+
+        if (pullable) {
+            m_vertex_address = m_context->buffer_device_address(m_vertex_buffer);
+        }
+    }
+
+    std::shared_ptr<Mesh> Mesh::create(const std::shared_ptr<Context> &context, const QuantizedMesh &mesh) {
+        return std::shared_ptr<Mesh>(new Mesh(context, mesh));
+    }
+
+    Mesh::~Mesh() {
+        m_context->free_buffer(m_vertex_buffer);
+        m_context->free_buffer(m_index_buffer);
+    }
+
+    void Mesh::bind(const vk::CommandBuffer &cmd, uint32_t binding) const {
+        cmd.bindVertexBuffers(binding, m_vertex_buffer.resource, {0});
+        cmd.bindIndexBuffer(m_index_buffer.resource, 0, m_index_type);
+    }
+
+    void Mesh::bind_indices(const vk::CommandBuffer &cmd) const {
+        cmd.bindIndexBuffer(m_index_buffer.resource, 0, m_index_type);
+    }
+
+    void Mesh::draw(const vk::CommandBuffer &cmd, uint32_t instance_count, uint32_t first_instance) const {
+        cmd.drawIndexed(m_index_count, instance_count, 0, 0, first_instance);
+    }
+} // namespace neuron::render
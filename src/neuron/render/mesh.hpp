@@ -0,0 +1,126 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "graphics_pipeline.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace neuron::render {
+
+    struct MeshVertex {
+        glm::vec3 position{0.0f};
+        glm::vec3 normal{0.0f, 0.0f, 1.0f};
+        glm::vec4 color{1.0f};
+    };
+
+    struct MeshData {
+        std::vector<MeshVertex> vertices;
+        std::vector<uint32_t>   indices;
+    };
+
+    // Deduplicates bitwise-identical vertices of a triangle soup (every 3 vertices form a triangle).
+    [[nodiscard]] NEURON_API MeshData build_indexed_mesh(std::span<const MeshVertex> triangle_soup);
+
+    // Reorders triangles for post-transform vertex cache hits (Forsyth's linear-speed algorithm).
+    NEURON_API void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count);
+
+    // Reorders vertices into first-use order of the index buffer and drops unreferenced vertices.
+    NEURON_API void optimize_vertex_fetch(MeshData &mesh);
+
+    struct MeshQuantizeSettings {
+        bool include_normals = true;
+        bool include_colors  = true;
+        // Use 16-bit indices when every index fits.
+        bool allow_16bit_indices = true;
+    };
+
+    struct MeshVertexAttribute {
+        uint32_t   location;
+        vk::Format format;
+        uint32_t   offset;
+    };
+
+    // Locations are assigned in order: position, then normal and color when present.
+    struct NEURON_API MeshVertexLayout {
+        uint32_t                         stride = 0;
+        std::vector<MeshVertexAttribute> attributes;
+
+        GraphicsPipelineBuilder &apply(GraphicsPipelineBuilder &builder, uint32_t binding = 0) const;
+    };
+
+    // Vertex streams in compact formats:
+    //   position  R16G16B16A16Snorm  decode as in.xyz * position_scale + position_offset (w reads as 1.0)
+    //   normal    R16G16Snorm        octahedral, decode n = vec3(e, 1 - |e.x| - |e.y|); if (n.z < 0) n.xy = (1 - |n.yx|) * sign(n.xy); normalize(n)
+    //   color     R8G8B8A8Unorm
+    struct QuantizedMesh {
+        std::vector<std::byte> vertex_data;
+        uint32_t               vertex_count = 0;
+
+        std::vector<std::byte> index_data;
+        uint32_t               index_count = 0;
+        vk::IndexType          index_type  = vk::IndexType::eUint32;
+
+        glm::vec3 position_scale{1.0f};
+        glm::vec3 position_offset{0.0f};
+
+        MeshVertexLayout layout;
+    };
+
+    [[nodiscard]] NEURON_API QuantizedMesh quantize_mesh(const MeshData &mesh, const MeshQuantizeSettings &settings = {});
+
+    // build_indexed_mesh -> optimize_vertex_cache -> optimize_vertex_fetch -> quantize_mesh
+    [[nodiscard]] NEURON_API QuantizedMesh prepare_mesh(std::span<const MeshVertex> triangle_soup, const MeshQuantizeSettings &settings = {});
+
+    // GPU-resident copy of a QuantizedMesh.
+    class NEURON_API Mesh {
+        Mesh(const std::shared_ptr<Context> &context, const QuantizedMesh &mesh);
+
+      public:
+        static std::shared_ptr<Mesh> create(const std::shared_ptr<Context> &context, const QuantizedMesh &mesh);
+
+        ~Mesh();
+
+        Mesh(const Mesh &other)            = delete;
+        Mesh &operator=(const Mesh &other) = delete;
+
+        void bind(const vk::CommandBuffer &cmd, uint32_t binding = 0) const;
+        // Index buffer only, for vertex pulling pipelines.
+        void bind_indices(const vk::CommandBuffer &cmd) const;
+        void draw(const vk::CommandBuffer &cmd, uint32_t instance_count = 1, uint32_t first_instance = 0) const;
+
+        [[nodiscard]] inline const VmaAllocated<vk::Buffer> &vertex_buffer() const { return m_vertex_buffer; }
+
+        [[nodiscard]] inline const VmaAllocated<vk::Buffer> &index_buffer() const { return m_index_buffer; }
+
+        // 0 unless the device has buffer device address enabled.
+        [[nodiscard]] inline vk::DeviceAddress vertex_address() const { return m_vertex_address; }
+
+        [[nodiscard]] inline uint32_t index_count() const { return m_index_count; }
+
+        [[nodiscard]] inline vk::IndexType index_type() const { return m_index_type; }
+
+        [[nodiscard]] inline const glm::vec3 &position_scale() const { return m_position_scale; }
+
+        [[nodiscard]] inline const glm::vec3 &position_offset() const { return m_position_offset; }
+
+        [[nodiscard]] inline const MeshVertexLayout &layout() const { return m_layout; }
+
+      private:
+        std::shared_ptr<Context> m_context;
+        VmaAllocated<vk::Buffer> m_vertex_buffer;
+        VmaAllocated<vk::Buffer> m_index_buffer;
+        vk::DeviceAddress        m_vertex_address = 0;
+        uint32_t                 m_index_count;
+        vk::IndexType            m_index_type;
+        glm::vec3                m_position_scale;
+        glm::vec3                m_position_offset;
+        MeshVertexLayout         m_layout;
+    };
+
+} // namespace neuron::render
@@ -4,8 +4,139 @@
 
 #include "pipeline_layout.hpp"
 
+#include "bindless.hpp"
+
+#include <algorithm>
+#include <numeric>
+
 
 namespace neuron::render {
+    DescriptorSetLayoutBuilder &DescriptorSetLayoutBuilder::add_binding(uint32_t binding, vk::DescriptorType type, vk::ShaderStageFlags stages, uint32_t count,
+                                                                      vk::DescriptorBindingFlags flags_) {
+        bindings.emplace_back(binding, type, count, stages);
+        binding_flags.push_back(flags_);
+        return *this;
+    }
+
+    DescriptorSetLayoutBuilder &DescriptorSetLayoutBuilder::set_flags(vk::DescriptorSetLayoutCreateFlags flags_) {
+        flags = flags_;
+        return *this;
+    }
+
+    DescriptorSetLayoutBuilder &DescriptorSetLayoutBuilder::canonicalize() {
+        binding_flags.resize(bindings.size());
+
+        std::vector<size_t> order(bindings.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, [&](size_t a, size_t b) { return bindings[a].binding < bindings[b].binding; });
+
+        std::vector<vk::DescriptorSetLayoutBinding> sorted_bindings;
+        std::vector<vk::DescriptorBindingFlags>     sorted_flags;
+        sorted_bindings.reserve(order.size());
+        sorted_flags.reserve(order.size());
+        for (size_t i : order) {
+            sorted_bindings.push_back(bindings[i]);
+            sorted_flags.push_back(binding_flags[i]);
+        }
+
+        bindings      = std::move(sorted_bindings);
+        binding_flags = std::move(sorted_flags);
+        return *this;
+    }
+
+    size_t DescriptorSetLayoutBuilder::hash() const {
+        size_t seed = 0;
+        hash_combine(seed, static_cast<VkDescriptorSetLayoutCreateFlags>(flags));
+        for (size_t i = 0; i < bindings.size(); i++) {
+            hash_combine(seed, bindings[i].binding);
+            hash_combine(seed, static_cast<VkDescriptorType>(bindings[i].descriptorType));
+            hash_combine(seed, bindings[i].descriptorCount);
+            hash_combine(seed, static_cast<VkShaderStageFlags>(bindings[i].stageFlags));
+            hash_combine(seed, i < binding_flags.size() ? static_cast<VkDescriptorBindingFlags>(binding_flags[i]) : 0U);
+        }
+        return seed;
+    }
+
+    bool DescriptorSetLayoutBuilder::operator==(const DescriptorSetLayoutBuilder &other) const {
+        if (flags != other.flags || bindings.size() != other.bindings.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < bindings.size(); i++) {
+            const auto &a = bindings[i];
+            const auto &b = other.bindings[i];
+            if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags) {
+                return false;
+            }
+
+            vk::DescriptorBindingFlags fa = i < binding_flags.size() ? binding_flags[i] : vk::DescriptorBindingFlags{};
+            vk::DescriptorBindingFlags fb = i < other.binding_flags.size() ? other.binding_flags[i] : vk::DescriptorBindingFlags{};
+            if (fa != fb) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::shared_ptr<DescriptorSetLayout> DescriptorSetLayoutBuilder::build(const std::shared_ptr<Context> &ctx) const {
+        return ctx->descriptor_set_layout_cache()->get_or_create(ctx, *this);
+    }
+
+    DescriptorSetLayout::DescriptorSetLayout(const std::shared_ptr<Context> &context, const DescriptorSetLayoutBuilder &builder)
+        : m_context(context), m_bindings(builder.bindings), m_flags(builder.flags) {
+        std::vector<vk::DescriptorBindingFlags> binding_flags = builder.binding_flags;
+        binding_flags.resize(builder.bindings.size());
+
+        bool has_binding_flags = std::ranges::any_of(binding_flags, [](const vk::DescriptorBindingFlags &f) { return static_cast<bool>(f); });
+
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{};
+        binding_flags_info.setBindingFlags(binding_flags);
+
+        vk::DescriptorSetLayoutCreateInfo create_info{};
+        create_info.setFlags(builder.flags);
+        create_info.setBindings(builder.bindings);
+        if (has_binding_flags) {
+            create_info.setPNext(&binding_flags_info);
+        }
+
+        m_set_layout = m_context->device().createDescriptorSetLayout(create_info);
+    }
+
+    DescriptorSetLayout::~DescriptorSetLayout() {
+        m_context->device().destroy(m_set_layout);
+    }
+
+    std::shared_ptr<DescriptorSetLayout> DescriptorSetLayoutCache::get_or_create(const std::shared_ptr<Context> &context, const DescriptorSetLayoutBuilder &builder) {
+        DescriptorSetLayoutBuilder key = builder;
+        key.canonicalize();
+
+        const size_t hash = key.hash();
+
+        std::lock_guard lock(m_mutex);
+
+        auto [begin, end] = m_layouts.equal_range(hash);
+        for (auto it = begin; it != end;) {
+            if (auto layout = it->second.second.lock()) {
+                if (it->second.first == key) {
+                    return layout;
+                }
+                ++it;
+            } else {
+                it = m_layouts.erase(it);
+            }
+        }
+
+        auto layout = std::make_shared<DescriptorSetLayout>(context, key);
+        m_layouts.emplace(hash, std::make_pair(std::move(key), layout));
+        return layout;
+    }
+
+    size_t DescriptorSetLayoutCache::size() const {
+        std::lock_guard lock(m_mutex);
+        return m_layouts.size();
+    }
+
     PipelineLayoutBuilder &PipelineLayoutBuilder::add_push_constant_range(const vk::PushConstantRange &range) {
         push_constant_ranges.push_back(range);
         return *this;
@@ -21,6 +152,11 @@ namespace neuron::render {
         return *this;
     }
 
+    PipelineLayoutBuilder &PipelineLayoutBuilder::add_bindless_table(const std::shared_ptr<BindlessResourceTable> &table) {
+        descriptor_set_layouts.push_back(table->set_layout());
+        return *this;
+    }
+
     std::shared_ptr<PipelineLayout> PipelineLayoutBuilder::build(const std::shared_ptr<Context> &ctx) {
         return std::make_shared<PipelineLayout>(ctx, *this);
     }
@@ -29,7 +165,29 @@ namespace neuron::render {
         m_pipeline_layout = m_context->device().createPipelineLayout({});
     }
 
-    PipelineLayout::PipelineLayout(const std::shared_ptr<Context> &context, const PipelineLayoutBuilder &builder) : m_context(context) {
+    std::shared_ptr<PipelineLayout> PipelineLayoutBuilder::build_cached(const std::shared_ptr<Context> &ctx) {
+        return ctx->pipeline_layout_cache()->get_or_create(ctx, *this);
+    }
+
+    size_t PipelineLayoutBuilder::hash() const {
+        size_t seed = 0;
+        for (const auto &dsl : descriptor_set_layouts) {
+            hash_combine(seed, static_cast<VkDescriptorSetLayout>(dsl->set_layout()));
+        }
+        for (const auto &range : push_constant_ranges) {
+            hash_combine(seed, static_cast<VkShaderStageFlags>(range.stageFlags));
+            hash_combine(seed, range.offset);
+            hash_combine(seed, range.size);
+        }
+        return seed;
+    }
+
+    bool PipelineLayoutBuilder::operator==(const PipelineLayoutBuilder &other) const {
+        return descriptor_set_layouts == other.descriptor_set_layouts && push_constant_ranges == other.push_constant_ranges;
+    }
+
+    PipelineLayout::PipelineLayout(const std::shared_ptr<Context> &context, const PipelineLayoutBuilder &builder)
+        : m_context(context), m_descriptor_set_layouts(builder.descriptor_set_layouts), m_push_constant_ranges(builder.push_constant_ranges) {
         std::vector<vk::DescriptorSetLayout> dsls;
         dsls.reserve(builder.descriptor_set_layouts.size());
         for (const auto& dsl : builder.descriptor_set_layouts) {
@@ -41,4 +199,42 @@ namespace neuron::render {
     PipelineLayout::~PipelineLayout() {
         m_context->device().destroy(m_pipeline_layout);
     }
+
+    std::shared_ptr<PipelineLayout> PipelineLayoutCache::get_or_create(const std::shared_ptr<Context> &context, const PipelineLayoutBuilder &builder) {
+        const size_t hash = builder.hash();
+
+        Key key{.push_constant_ranges = builder.push_constant_ranges};
+        key.set_layouts.reserve(builder.descriptor_set_layouts.size());
+        for (const auto &dsl : builder.descriptor_set_layouts) {
+            key.set_layouts.push_back(dsl->set_layout());
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        auto [begin, end] = m_layouts.equal_range(hash);
+        for (auto it = begin; it != end;) {
+            if (auto layout = it->second.second.lock()) {
+                if (it->second.first == key) {
+                    return layout;
+                }
+                ++it;
+            } else {
+                it = m_layouts.erase(it);
+            }
+        }
+
+        if (m_layouts.size() >= m_sweep_at) {
+            std::erase_if(m_layouts, [](const auto &entry) { return entry.second.second.expired(); });
+            m_sweep_at = std::max<size_t>(64, m_layouts.size() * 2);
+        }
+
+        auto layout = std::make_shared<PipelineLayout>(context, builder);
+        m_layouts.emplace(hash, std::make_pair(std::move(key), layout));
+        return layout;
+    }
+
+    size_t PipelineLayoutCache::size() const {
+        std::lock_guard lock(m_mutex);
+        return static_cast<size_t>(std::ranges::count_if(m_layouts, [](const auto &entry) { return !entry.second.second.expired(); }));
+    }
 } // namespace neuron::render
@@ -8,20 +8,69 @@
 #include "neuron/neuron.hpp"
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace neuron::render {
 
+    class DescriptorSetLayout;
+
+    // Immutable samplers are not supported, pImmutableSamplers must stay null.
+    struct NEURON_API DescriptorSetLayoutBuilder {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        std::vector<vk::DescriptorBindingFlags>     binding_flags;
+        vk::DescriptorSetLayoutCreateFlags          flags;
+
+        DescriptorSetLayoutBuilder &add_binding(uint32_t binding, vk::DescriptorType type, vk::ShaderStageFlags stages, uint32_t count = 1, vk::DescriptorBindingFlags flags = {});
+        DescriptorSetLayoutBuilder &set_flags(vk::DescriptorSetLayoutCreateFlags flags);
+
+        // Sorts bindings by index so equivalent builders produce identical keys.
+        DescriptorSetLayoutBuilder &canonicalize();
+
+        [[nodiscard]] size_t hash() const;
+        [[nodiscard]] bool   operator==(const DescriptorSetLayoutBuilder &other) const;
+
+        // Goes through the context's layout cache, identical layouts are shared.
+        std::shared_ptr<DescriptorSetLayout> build(const std::shared_ptr<Context> &ctx) const;
+    };
+
     class NEURON_API DescriptorSetLayout {
     public:
+        DescriptorSetLayout(const std::shared_ptr<Context> &context, const DescriptorSetLayoutBuilder &builder);
+
+        ~DescriptorSetLayout();
 
+        DescriptorSetLayout(const DescriptorSetLayout &other)            = delete;
+        DescriptorSetLayout &operator=(const DescriptorSetLayout &other) = delete;
 
         [[nodiscard]] vk::DescriptorSetLayout set_layout() const { return m_set_layout; }
+
+        [[nodiscard]] const std::vector<vk::DescriptorSetLayoutBinding> &bindings() const { return m_bindings; }
+
+        [[nodiscard]] bool update_after_bind() const { return static_cast<bool>(m_flags & vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool); }
     private:
         std::shared_ptr<Context> m_context;
         vk::DescriptorSetLayout m_set_layout;
+
+        std::vector<vk::DescriptorSetLayoutBinding> m_bindings;
+        vk::DescriptorSetLayoutCreateFlags          m_flags;
+    };
+
+    // Dedupes descriptor set layouts by content. Entries are held weakly, a layout lives as long as something uses it.
+    class NEURON_API DescriptorSetLayoutCache {
+      public:
+        std::shared_ptr<DescriptorSetLayout> get_or_create(const std::shared_ptr<Context> &context, const DescriptorSetLayoutBuilder &builder);
+
+        [[nodiscard]] size_t size() const;
+
+      private:
+        mutable std::mutex m_mutex;
+
+        std::unordered_multimap<size_t, std::pair<DescriptorSetLayoutBuilder, std::weak_ptr<DescriptorSetLayout>>> m_layouts;
     };
 
     class PipelineLayout;
+    class BindlessResourceTable;
 
     struct NEURON_API PipelineLayoutBuilder {
         std::vector<std::shared_ptr<DescriptorSetLayout>> descriptor_set_layouts;
@@ -32,9 +81,15 @@ namespace neuron::render {
         PipelineLayoutBuilder &add_push_constant_range(vk::ShaderStageFlags stage_flags, uint32_t offset, uint32_t size);
 
         PipelineLayoutBuilder &add_descriptor_set_layout(const std::shared_ptr<DescriptorSetLayout>& descriptor_set_layout);
+        PipelineLayoutBuilder &add_bindless_table(const std::shared_ptr<BindlessResourceTable>& table);
 
         std::shared_ptr<PipelineLayout> build(const std::shared_ptr<Context>& ctx);
 
+        // Goes through the context's layout cache, pipelines built from equal builders share one layout (and stay descriptor-set compatible).
+        std::shared_ptr<PipelineLayout> build_cached(const std::shared_ptr<Context>& ctx);
+
+        [[nodiscard]] size_t hash() const;
+        [[nodiscard]] bool   operator==(const PipelineLayoutBuilder &other) const;
     };
 
     class NEURON_API PipelineLayout {
@@ -46,10 +101,41 @@ namespace neuron::render {
 
         [[nodiscard]] vk::PipelineLayout pipeline_layout() const { return m_pipeline_layout; }
 
+        [[nodiscard]] const std::vector<std::shared_ptr<DescriptorSetLayout>> &descriptor_set_layouts() const { return m_descriptor_set_layouts; }
+
+        [[nodiscard]] const std::vector<vk::PushConstantRange> &push_constant_ranges() const { return m_push_constant_ranges; }
+
       private:
 
         std::shared_ptr<Context> m_context;
         vk::PipelineLayout m_pipeline_layout;
+
+        std::vector<std::shared_ptr<DescriptorSetLayout>> m_descriptor_set_layouts;
+        std::vector<vk::PushConstantRange>                m_push_constant_ranges;
+    };
+
+    // Dedupes pipeline layouts by their set layout handles and push constant ranges. Entries are held weakly and do not
+    // keep the descriptor set layouts alive; a handle can only be reused once the layout holding it is gone.
+    class NEURON_API PipelineLayoutCache {
+      public:
+        std::shared_ptr<PipelineLayout> get_or_create(const std::shared_ptr<Context> &context, const PipelineLayoutBuilder &builder);
+
+        // Live layouts only.
+        [[nodiscard]] size_t size() const;
+
+      private:
+        struct Key {
+            std::vector<vk::DescriptorSetLayout> set_layouts;
+            std::vector<vk::PushConstantRange>   push_constant_ranges;
+
+            [[nodiscard]] bool operator==(const Key &other) const = default;
+        };
+
+        mutable std::mutex m_mutex;
+
+        std::unordered_multimap<size_t, std::pair<Key, std::weak_ptr<PipelineLayout>>> m_layouts;
+        // expired entries in other buckets are only erased by a sweep over the whole map, once it reaches this size
+        size_t m_sweep_at = 64;
     };
 
 } // namespace neuron::render
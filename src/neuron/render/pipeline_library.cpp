@@ -0,0 +1,218 @@
+#include "pipeline_library.hpp"
+
+#include <array>
+
+namespace neuron::render {
+    static vk::GraphicsPipelineLibraryFlagsEXT library_flags(PipelineLibraryPart part) {
+        switch (part) {
+        case PipelineLibraryPart::VertexInput:
+            return vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface;
+        case PipelineLibraryPart::PreRasterization:
+            return vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders;
+        case PipelineLibraryPart::FragmentShader:
+            return vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+        case PipelineLibraryPart::FragmentOutput:
+            return vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface;
+        }
+        return {};
+    }
+
+    static bool part_has_stage(PipelineLibraryPart part, vk::ShaderStageFlagBits stage) {
+        switch (part) {
+        case PipelineLibraryPart::PreRasterization:
+            return stage != vk::ShaderStageFlagBits::eFragment;
+        case PipelineLibraryPart::FragmentShader:
+            return stage == vk::ShaderStageFlagBits::eFragment;
+        default:
+            return false;
+        }
+    }
+
+    // The mutex guarding entries must be held. Drops expired entries on the way.
+    template <typename Entries>
+    static auto find_entry(Entries &entries, size_t hash, const std::vector<uint64_t> &key) -> decltype(entries.begin()->second.second.lock()) {
+        auto [begin, end] = entries.equal_range(hash);
+        for (auto it = begin; it != end;) {
+            if (auto existing = it->second.second.lock()) {
+                if (it->second.first == key) {
+                    return existing;
+                }
+                ++it;
+            } else {
+                it = entries.erase(it);
+            }
+        }
+        return nullptr;
+    }
+
+    static vk::Pipeline link(const Context &ctx, vk::PipelineCache cache, const std::shared_ptr<PipelineLayout> &layout,
+                             const std::vector<std::shared_ptr<PipelineLibrary>> &libraries, vk::PipelineCreateFlags flags) {
+        std::array<vk::Pipeline, 4> handles;
+        for (size_t i = 0; i < libraries.size(); i++) {
+            handles[i] = libraries[i]->pipeline();
+        }
+
+        vk::PipelineLibraryCreateInfoKHR library_info;
+        library_info.setLibraries(handles);
+
+        vk::GraphicsPipelineCreateInfo create_info;
+        create_info.setFlags(flags);
+        create_info.setLayout(layout->pipeline_layout());
+        create_info.pNext = &library_info;
+
+        return ctx.device().createGraphicsPipeline(cache, create_info).value;
+    }
+
+    PipelineLibrary::PipelineLibrary(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder, PipelineLibraryPart part, bool retain_link_time_info)
+        : m_context(context), m_layout(builder.layout), m_part(part) {
+        GraphicsPipelineCreateInfo info(context, builder);
+
+        std::erase_if(info.stages, [part](const vk::PipelineShaderStageCreateInfo &stage) { return !part_has_stage(part, stage.stage); });
+        if (!info.stages.empty()) {
+            m_shader_modules = info.shader_modules;
+        }
+        info.create_info.setStages(info.stages);
+
+        vk::GraphicsPipelineLibraryCreateInfoEXT library_info(library_flags(part));
+        library_info.pNext = info.create_info.pNext;
+
+        vk::PipelineCreateFlags flags = vk::PipelineCreateFlagBits::eLibraryKHR;
+        if (retain_link_time_info) {
+            flags |= vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+        }
+
+        info.create_info.setFlags(flags);
+        info.create_info.setBasePipelineHandle(VK_NULL_HANDLE);
+        info.create_info.setBasePipelineIndex(-1);
+        info.create_info.pNext = &library_info;
+
+        m_pipeline = m_context->device().createGraphicsPipeline(info.pipeline_cache, info.create_info).value;
+    }
+
+    PipelineLibrary::~PipelineLibrary() {
+        m_context->device().destroyPipeline(m_pipeline);
+    }
+
+    PipelineLibraryCache::PipelineLibraryCache(const std::shared_ptr<Context> &context, const PipelineLibraryCacheSettings &settings)
+        : m_context(context), m_settings(settings),
+          m_use_libraries(context->enabled_features().graphics_pipeline_library && context->enabled_features().graphics_pipeline_fast_linking) {}
+
+    std::shared_ptr<PipelineLibraryCache> PipelineLibraryCache::create(const std::shared_ptr<Context> &context, const PipelineLibraryCacheSettings &settings) {
+        return std::shared_ptr<PipelineLibraryCache>(new PipelineLibraryCache(context, settings));
+    }
+
+    PipelineLibraryCache::~PipelineLibraryCache() {
+        wait_for_optimization();
+    }
+
+    std::shared_ptr<GraphicsPipeline> PipelineLibraryCache::get_or_create(GraphicsPipelineBuilder &builder) {
+        if (!m_use_libraries) {
+            return m_monolithic.get_or_create(m_context, builder);
+        }
+
+        if (builder.needs_reflection()) {
+            builder.reflect(m_context);
+        }
+
+        auto         key  = builder.state_key(*m_context);
+        const size_t hash = builder.state_hash(*m_context);
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (auto existing = find_entry(m_pipelines, hash, key)) {
+                return existing;
+            }
+        }
+
+        // compiles and links run unlocked, so callers building different pipelines do not wait on each other's driver work
+        std::vector<std::shared_ptr<PipelineLibrary>> libraries;
+        for (const auto part :
+             {PipelineLibraryPart::VertexInput, PipelineLibraryPart::PreRasterization, PipelineLibraryPart::FragmentShader, PipelineLibraryPart::FragmentOutput}) {
+            libraries.push_back(library(builder, part));
+        }
+
+        const vk::PipelineCache cache = builder.pipeline_cache ? builder.pipeline_cache : m_context->pipeline_cache();
+
+        // fast link: no link-time optimization, so this costs little next to compiling the libraries
+        const vk::Pipeline linked   = link(*m_context, cache, builder.layout, libraries, {});
+        auto               pipeline = std::make_shared<GraphicsPipeline>(m_context, builder.layout, builder.effective_dynamic_states(*m_context), linked, libraries);
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            // another caller linked the same pipeline meanwhile; keep the one already handed out
+            if (auto existing = find_entry(m_pipelines, hash, key)) {
+                return existing;
+            }
+            m_pipelines.emplace(hash, std::make_pair(std::move(key), pipeline));
+        }
+
+        if (m_settings.optimize_in_background) {
+            optimize(pipeline, cache, std::move(libraries));
+        }
+
+        return pipeline;
+    }
+
+    std::shared_ptr<PipelineLibrary> PipelineLibraryCache::library(const GraphicsPipelineBuilder &builder, PipelineLibraryPart part) {
+        auto   key  = builder.library_key(*m_context, part);
+        size_t hash = 0;
+        for (const uint64_t word : key) {
+            hash_combine(hash, word);
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (auto existing = find_entry(m_libraries, hash, key)) {
+                return existing;
+            }
+        }
+
+        auto library = std::make_shared<PipelineLibrary>(m_context, builder, part, m_settings.optimize_in_background);
+
+        std::lock_guard lock(m_mutex);
+        if (auto existing = find_entry(m_libraries, hash, key)) {
+            return existing;
+        }
+        m_libraries.emplace(hash, std::make_pair(std::move(key), library));
+        return library;
+    }
+
+    void PipelineLibraryCache::optimize(const std::shared_ptr<GraphicsPipeline> &pipeline, vk::PipelineCache cache, std::vector<std::shared_ptr<PipelineLibrary>> libraries) {
+        jobs::JobSystem::global()->run(
+            [this, weak = std::weak_ptr(pipeline), cache, layout = pipeline->layout(), libraries = std::move(libraries)] {
+                vk::Pipeline optimized;
+                try {
+                    optimized = link(*m_context, cache, layout, libraries, vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT);
+                } catch (const vk::SystemError &) {
+                    // the fast-linked pipeline stays in use
+                    return;
+                }
+
+                if (auto target = weak.lock()) {
+                    target->replace(optimized);
+                } else {
+                    m_context->device().destroyPipeline(optimized);
+                }
+            },
+            &m_optimizing);
+    }
+
+    void PipelineLibraryCache::wait_for_optimization() {
+        jobs::JobSystem::global()->wait(m_optimizing);
+    }
+
+    size_t PipelineLibraryCache::library_count() const {
+        std::lock_guard lock(m_mutex);
+        return m_libraries.size();
+    }
+
+    size_t PipelineLibraryCache::pipeline_count() const {
+        if (!m_use_libraries) {
+            return m_monolithic.size();
+        }
+
+        std::lock_guard lock(m_mutex);
+        return m_pipelines.size();
+    }
+} // namespace neuron::render
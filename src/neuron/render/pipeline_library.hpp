@@ -0,0 +1,93 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/jobs/job_system.hpp"
+#include "neuron/neuron.hpp"
+
+#include "graphics_pipeline.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace neuron::render {
+
+    // One compiled part of a graphics pipeline, linkable with the other three.
+    class NEURON_API PipelineLibrary {
+      public:
+        PipelineLibrary(const std::shared_ptr<Context> &context, const GraphicsPipelineBuilder &builder, PipelineLibraryPart part, bool retain_link_time_info);
+
+        ~PipelineLibrary();
+
+        PipelineLibrary(const PipelineLibrary &other)            = delete;
+        PipelineLibrary &operator=(const PipelineLibrary &other) = delete;
+
+        [[nodiscard]] inline vk::Pipeline        pipeline() const { return m_pipeline; }
+        [[nodiscard]] inline PipelineLibraryPart part() const { return m_part; }
+
+      private:
+        std::shared_ptr<Context>                   m_context;
+        std::shared_ptr<PipelineLayout>            m_layout;
+        std::vector<std::shared_ptr<ShaderModule>> m_shader_modules;
+        PipelineLibraryPart                        m_part;
+
+        vk::Pipeline m_pipeline;
+    };
+
+    struct PipelineLibraryCacheSettings {
+        // Link each new pipeline again with link-time optimization on the job system, and swap it in when done.
+        bool optimize_in_background = true;
+    };
+
+    // Compiles the vertex input, pre-rasterization, fragment shader and fragment output parts of pipelines separately and
+    // dedupes each by its GraphicsPipelineBuilder::library_key(), so a new material combination only compiles the parts
+    // not seen before and fast-links the rest. Without graphics_pipeline_library and fast linking on the context every
+    // pipeline is built monolithically instead.
+    //
+    // Entries are held weakly; a linked pipeline keeps its libraries alive.
+    class NEURON_API PipelineLibraryCache {
+        PipelineLibraryCache(const std::shared_ptr<Context> &context, const PipelineLibraryCacheSettings &settings);
+
+      public:
+        static std::shared_ptr<PipelineLibraryCache> create(const std::shared_ptr<Context> &context, const PipelineLibraryCacheSettings &settings = {});
+
+        // Waits for the background links.
+        ~PipelineLibraryCache();
+
+        PipelineLibraryCache(const PipelineLibraryCache &other)            = delete;
+        PipelineLibraryCache &operator=(const PipelineLibraryCache &other) = delete;
+
+        // Reflects the builder first when build() would.
+        std::shared_ptr<GraphicsPipeline> get_or_create(GraphicsPipelineBuilder &builder);
+
+        void wait_for_optimization();
+
+        [[nodiscard]] inline bool uses_libraries() const { return m_use_libraries; }
+
+        [[nodiscard]] size_t library_count() const;
+        [[nodiscard]] size_t pipeline_count() const;
+
+      private:
+        template <typename T>
+        using WeakEntries = std::unordered_multimap<size_t, std::pair<std::vector<uint64_t>, std::weak_ptr<T>>>;
+
+        // Compiles without holding m_mutex; when two callers race on one part, both compile and the first inserted wins.
+        std::shared_ptr<PipelineLibrary> library(const GraphicsPipelineBuilder &builder, PipelineLibraryPart part);
+
+        void optimize(const std::shared_ptr<GraphicsPipeline> &pipeline, vk::PipelineCache cache, std::vector<std::shared_ptr<PipelineLibrary>> libraries);
+
+        std::shared_ptr<Context>     m_context;
+        PipelineLibraryCacheSettings m_settings;
+        bool                         m_use_libraries;
+
+        mutable std::mutex            m_mutex;
+        WeakEntries<PipelineLibrary>  m_libraries;
+        WeakEntries<GraphicsPipeline> m_pipelines;
+
+        GraphicsPipelineCache m_monolithic;
+
+        jobs::Counter m_optimizing;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,153 @@
+#include "readback.hpp"
+
+#include "submission_scheduler.hpp"
+#include "texture_uploader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace neuron::render {
+    ReadbackRing::ReadbackRing(const std::shared_ptr<Context> &context, const ReadbackSettings &settings) : m_context(context), m_settings(settings) {
+        if (m_settings.slots == 0) {
+            throw std::runtime_error("Readback ring needs at least one slot");
+        }
+
+        m_slots.resize(m_settings.slots);
+        m_queue.resize(std::max(m_settings.queue_capacity, 1U));
+    }
+
+    std::shared_ptr<ReadbackRing> ReadbackRing::create(const std::shared_ptr<Context> &context, const ReadbackSettings &settings) {
+        return std::shared_ptr<ReadbackRing>(new ReadbackRing(context, settings));
+    }
+
+    ReadbackRing::~ReadbackRing() {
+        for (auto &slot : m_slots) {
+            if (slot.state == SlotState::InFlight) {
+                slot.scheduler->wait(slot.value);
+            }
+            if (slot.buffer.resource) {
+                m_context->free_buffer(slot.buffer);
+            }
+        }
+    }
+
+    bool ReadbackRing::record_capture(const vk::CommandBuffer &cmd, const ReadbackImage &image, uint64_t tag) {
+        Slot &slot = m_slots[m_next_record];
+        if (slot.state != SlotState::Free) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const vk::DeviceSize size = texture_level_size(image.format, image.extent, 0);
+
+        // the slot is idle, so a buffer that is too small can go right away
+        if (size > slot.capacity) {
+            if (slot.buffer.resource) {
+                m_context->free_buffer(slot.buffer);
+            }
+
+            slot.buffer = m_context->allocate_buffer(vk::BufferCreateInfo{{}, size, vk::BufferUsageFlagBits::eTransferDst},
+                                                     VmaAllocationCreateInfo{VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                                                                             VMA_MEMORY_USAGE_AUTO_PREFER_HOST});
+            slot.capacity = size;
+        }
+
+        const vk::ImageSubresourceRange range{image.aspect, 0, 1, 0, 1};
+
+        vk::ImageMemoryBarrier to_transfer{vk::AccessFlagBits::eMemoryWrite,
+                                           vk::AccessFlagBits::eTransferRead,
+                                           image.layout,
+                                           vk::ImageLayout::eTransferSrcOptimal,
+                                           VK_QUEUE_FAMILY_IGNORED,
+                                           VK_QUEUE_FAMILY_IGNORED,
+                                           image.image,
+                                           range};
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, to_transfer);
+
+        vk::BufferImageCopy copy{0, 0, 0, {image.aspect, 0, 0, 1}, {0, 0, 0}, {image.extent.width, image.extent.height, 1}};
+        cmd.copyImageToBuffer(image.image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer.resource, copy);
+
+        vk::ImageMemoryBarrier back{vk::AccessFlagBits::eTransferRead,
+                                    vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+                                    vk::ImageLayout::eTransferSrcOptimal,
+                                    image.layout,
+                                    VK_QUEUE_FAMILY_IGNORED,
+                                    VK_QUEUE_FAMILY_IGNORED,
+                                    image.image,
+                                    range};
+        vk::BufferMemoryBarrier to_host{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                                        slot.buffer.resource, 0, size};
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eHost, {}, {}, to_host, back);
+
+        slot.state  = SlotState::Recorded;
+        slot.tag    = tag;
+        slot.extent = image.extent;
+        slot.format = image.format;
+        slot.size   = size;
+
+        m_next_record = (m_next_record + 1) % static_cast<uint32_t>(m_slots.size());
+        return true;
+    }
+
+    void ReadbackRing::mark_submitted(const std::shared_ptr<SubmissionScheduler> &scheduler, uint64_t value) {
+        for (auto &slot : m_slots) {
+            if (slot.state == SlotState::Recorded) {
+                slot.state     = SlotState::InFlight;
+                slot.scheduler = scheduler;
+                slot.value     = value;
+            }
+        }
+    }
+
+    void ReadbackRing::poll() {
+        while (true) {
+            Slot &slot = m_slots[m_next_deliver];
+            if (slot.state != SlotState::InFlight || slot.scheduler->completed() < slot.value) {
+                return;
+            }
+
+            deliver(slot);
+
+            slot.state     = SlotState::Free;
+            slot.scheduler = nullptr;
+            m_next_deliver = (m_next_deliver + 1) % static_cast<uint32_t>(m_slots.size());
+        }
+    }
+
+    void ReadbackRing::deliver(Slot &slot) {
+        vmaInvalidateAllocation(m_context->allocator(), slot.buffer.allocation, 0, slot.size);
+        const auto *pixels = static_cast<const std::byte *>(slot.buffer.allocation_info.pMappedData);
+
+        if (m_settings.callback) {
+            m_settings.callback(ReadbackFrame{slot.tag, slot.extent, slot.format, std::span(pixels, slot.size)});
+            return;
+        }
+
+        const size_t tail = m_queue_tail.load(std::memory_order_relaxed);
+        if (tail - m_queue_head.load(std::memory_order_acquire) == m_queue.size()) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        CapturedFrame &frame = m_queue[tail % m_queue.size()];
+        frame.tag            = slot.tag;
+        frame.extent         = slot.extent;
+        frame.format         = slot.format;
+        frame.pixels.assign(pixels, pixels + slot.size);
+
+        m_queue_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    bool ReadbackRing::try_pop(CapturedFrame &frame) {
+        const size_t head = m_queue_head.load(std::memory_order_relaxed);
+        if (head == m_queue_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        // the caller's old pixel storage goes back into the ring
+        std::swap(frame, m_queue[head % m_queue.size()]);
+
+        m_queue_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+} // namespace neuron::render
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+#include "display_system.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace neuron::render {
+    class SubmissionScheduler;
+
+    // The whole of mip 0, layer 0 is copied. The image must be in `layout` and have eTransferSrc usage; it is left in
+    // `layout` again.
+    struct ReadbackImage {
+        vk::Image            image;
+        vk::ImageLayout      layout;
+        vk::Extent2D         extent;
+        vk::Format           format;
+        vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+    };
+
+    // Pixels are tightly packed rows, valid only during the callback.
+    struct ReadbackFrame {
+        uint64_t                   tag;
+        vk::Extent2D               extent;
+        vk::Format                 format;
+        std::span<const std::byte> pixels;
+    };
+
+    struct CapturedFrame {
+        uint64_t               tag = 0;
+        vk::Extent2D           extent;
+        vk::Format             format = vk::Format::eUndefined;
+        std::vector<std::byte> pixels;
+    };
+
+    using ReadbackCallback = std::function<void(const ReadbackFrame &)>;
+
+    struct ReadbackSettings {
+        uint32_t slots          = DisplaySystem::MAX_FRAMES_IN_FLIGHT + 1;
+        uint32_t queue_capacity = 4; // captures waiting for try_pop(), unused with a callback
+
+        // Called from poll() straight from mapped memory. Without one, captures are copied into the queue.
+        ReadbackCallback callback;
+    };
+
+    // Copies rendered images into a ring of persistently mapped, host-cached buffers and hands the pixels out once the
+    // submission that wrote them has completed. Capturing never waits for the GPU: when every slot is still in flight
+    // the capture is dropped and counted instead.
+    //
+    // Per frame, on the render thread: record_capture() into the frame's command buffer, mark_submitted() with the
+    // timeline value its submission returned, and poll(). try_pop() may run on one other thread.
+    class NEURON_API ReadbackRing {
+        ReadbackRing(const std::shared_ptr<Context> &context, const ReadbackSettings &settings);
+
+      public:
+        static std::shared_ptr<ReadbackRing> create(const std::shared_ptr<Context> &context, const ReadbackSettings &settings = {});
+
+        // Waits for captures still in flight.
+        ~ReadbackRing();
+
+        ReadbackRing(const ReadbackRing &other)            = delete;
+        ReadbackRing &operator=(const ReadbackRing &other) = delete;
+
+        // Outside a render pass. Returns false when the capture was dropped.
+        bool record_capture(const vk::CommandBuffer &cmd, const ReadbackImage &image, uint64_t tag);
+
+        // Applies to every capture recorded since the last call.
+        void mark_submitted(const std::shared_ptr<SubmissionScheduler> &scheduler, uint64_t value);
+
+        // Delivers completed captures in recording order.
+        void poll();
+
+        bool try_pop(CapturedFrame &frame);
+
+        [[nodiscard]] inline uint64_t dropped_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+      private:
+        enum class SlotState { Free, Recorded, InFlight };
+
+        struct Slot {
+            VmaAllocated<vk::Buffer> buffer{};
+            vk::DeviceSize           capacity = 0;
+            SlotState                state    = SlotState::Free;
+
+            std::shared_ptr<SubmissionScheduler> scheduler;
+            uint64_t                             value = 0;
+
+            uint64_t       tag = 0;
+            vk::Extent2D   extent;
+            vk::Format     format = vk::Format::eUndefined;
+            vk::DeviceSize size   = 0;
+        };
+
+        void deliver(Slot &slot);
+
+        std::shared_ptr<Context> m_context;
+        ReadbackSettings         m_settings;
+
+        std::vector<Slot> m_slots;
+        uint32_t          m_next_record  = 0;
+        uint32_t          m_next_deliver = 0;
+
+        // single-producer single-consumer ring; try_pop() swaps frames out so pixel storage is reused
+        std::vector<CapturedFrame> m_queue;
+        std::atomic<size_t>        m_queue_head{0};
+        std::atomic<size_t>        m_queue_tail{0};
+
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+} // namespace neuron::render
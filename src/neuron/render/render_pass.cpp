@@ -0,0 +1,335 @@
+#include "render_pass.hpp"
+
+#include <array>
+#include <stdexcept>
+
+namespace neuron::render {
+    namespace {
+        struct LayoutUsage {
+            vk::PipelineStageFlags stage;
+            vk::AccessFlags        access;
+        };
+
+        constexpr vk::PipelineStageFlags DEPTH_STAGES = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+
+        // How an image in this layout is used before or after a pass.
+        LayoutUsage layout_usage(vk::ImageLayout layout) {
+            switch (layout) {
+            case vk::ImageLayout::eUndefined:
+                return {vk::PipelineStageFlagBits::eTopOfPipe, {}};
+            case vk::ImageLayout::eColorAttachmentOptimal:
+                return {vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite};
+            case vk::ImageLayout::eDepthStencilAttachmentOptimal:
+                return {DEPTH_STAGES, vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite};
+            case vk::ImageLayout::eDepthStencilReadOnlyOptimal:
+                return {DEPTH_STAGES | vk::PipelineStageFlagBits::eFragmentShader,
+                        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eShaderRead};
+            case vk::ImageLayout::eShaderReadOnlyOptimal:
+                return {vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead};
+            case vk::ImageLayout::eTransferSrcOptimal:
+                return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead};
+            case vk::ImageLayout::eTransferDstOptimal:
+                return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite};
+            case vk::ImageLayout::ePresentSrcKHR:
+                return {vk::PipelineStageFlagBits::eBottomOfPipe, {}};
+            default:
+                return {vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+            }
+        }
+
+        // Barriers for one pass: at most every color attachment and its resolve target, plus depth and stencil with theirs.
+        struct BarrierBatch {
+            std::array<vk::ImageMemoryBarrier, (RenderPassDescription::MAX_COLOR_ATTACHMENTS + 2) * 2> barriers;
+
+            uint32_t               count = 0;
+            vk::PipelineStageFlags src_stages;
+            vk::PipelineStageFlags dst_stages;
+
+            void add(vk::Image image, const vk::ImageSubresourceRange &isr, vk::ImageLayout old_layout, const LayoutUsage &src, vk::ImageLayout new_layout,
+                     const LayoutUsage &dst) {
+                vk::ImageMemoryBarrier &b = barriers[count++];
+
+                b                  = vk::ImageMemoryBarrier{};
+                b.image            = image;
+                b.srcAccessMask    = src.access;
+                b.dstAccessMask    = dst.access;
+                b.oldLayout        = old_layout;
+                b.newLayout        = new_layout;
+                b.subresourceRange = isr;
+
+                src_stages |= src.stage;
+                dst_stages |= dst.stage;
+            }
+
+            void record(const vk::CommandBuffer &cmd) const {
+                if (count > 0) {
+                    cmd.pipelineBarrier(src_stages, dst_stages, {}, {}, {}, vk::ArrayProxy<const vk::ImageMemoryBarrier>(count, barriers.data()));
+                }
+            }
+        };
+
+        vk::ImageSubresourceRange slot_range(const RenderAttachment &attachment, vk::ImageAspectFlags slot_aspect) {
+            vk::ImageSubresourceRange isr = attachment.isr;
+            if (!isr.aspectMask) {
+                isr.aspectMask = slot_aspect;
+            }
+            return isr;
+        }
+
+        void add_begin_barriers(BarrierBatch &batch, const RenderAttachment &attachment, const vk::ImageSubresourceRange &isr, vk::ImageLayout layout) {
+            const LayoutUsage in_pass = layout_usage(layout);
+
+            // Discarded contents still need the previous pass's writes to be done before the transition.
+            const LayoutUsage before = attachment.initial_layout == vk::ImageLayout::eUndefined ? in_pass : layout_usage(attachment.initial_layout);
+            batch.add(attachment.image, isr, attachment.initial_layout, before, layout, in_pass);
+
+            if (attachment.resolve_mode != vk::ResolveModeFlagBits::eNone) {
+                vk::ImageSubresourceRange resolve_isr = isr;
+                resolve_isr.levelCount                = 1;
+                batch.add(attachment.resolve_image, resolve_isr, vk::ImageLayout::eUndefined, in_pass, layout, in_pass);
+            }
+        }
+
+        void add_end_barriers(BarrierBatch &batch, const RenderAttachment &attachment, const vk::ImageSubresourceRange &isr, vk::ImageLayout layout) {
+            const LayoutUsage in_pass = layout_usage(layout);
+
+            if (attachment.final_layout != vk::ImageLayout::eUndefined && attachment.final_layout != layout) {
+                batch.add(attachment.image, isr, layout, in_pass, attachment.final_layout, layout_usage(attachment.final_layout));
+            }
+
+            if (attachment.resolve_mode != vk::ResolveModeFlagBits::eNone && attachment.resolve_final_layout != vk::ImageLayout::eUndefined &&
+                attachment.resolve_final_layout != layout) {
+                vk::ImageSubresourceRange resolve_isr = isr;
+                resolve_isr.levelCount                = 1;
+                batch.add(attachment.resolve_image, resolve_isr, layout, in_pass, attachment.resolve_final_layout, layout_usage(attachment.resolve_final_layout));
+            }
+        }
+
+        vk::RenderingAttachmentInfo rendering_attachment(const RenderAttachment &attachment, vk::ImageLayout layout, bool load_op_none) {
+            if ((attachment.load_op == vk::AttachmentLoadOp::eLoad || attachment.load_op == vk::AttachmentLoadOp::eNoneEXT) &&
+                attachment.initial_layout == vk::ImageLayout::eUndefined) {
+                throw std::runtime_error("Render pass attachment loads its contents but has an undefined initial layout");
+            }
+
+            vk::AttachmentLoadOp load_op = attachment.load_op;
+            if (load_op == vk::AttachmentLoadOp::eNoneEXT && !load_op_none) {
+                load_op = vk::AttachmentLoadOp::eLoad;
+            }
+
+            vk::RenderingAttachmentInfo info{};
+            info.setImageView(attachment.image_view);
+            info.setImageLayout(layout);
+            info.setLoadOp(load_op);
+            info.setStoreOp(attachment.transient ? vk::AttachmentStoreOp::eDontCare : attachment.store_op);
+            info.setClearValue(attachment.clear_value);
+
+            if (attachment.resolve_mode != vk::ResolveModeFlagBits::eNone) {
+                info.setResolveMode(attachment.resolve_mode);
+                info.setResolveImageView(attachment.resolve_image_view);
+                info.setResolveImageLayout(layout);
+            }
+
+            return info;
+        }
+
+        // The depth barrier covers the stencil aspect too when both use one image, which combined formats require.
+        bool shares_depth_image(const RenderPassDescription &description) {
+            return description.depth_attachment && description.stencil_attachment && description.depth_attachment->image == description.stencil_attachment->image;
+        }
+
+        vk::ImageSubresourceRange depth_range(const RenderPassDescription &description) {
+            vk::ImageSubresourceRange isr = slot_range(*description.depth_attachment, vk::ImageAspectFlagBits::eDepth);
+            if (shares_depth_image(description)) {
+                isr.aspectMask |= vk::ImageAspectFlagBits::eStencil;
+            }
+            return isr;
+        }
+    } // namespace
+
+    RenderPassDescription &RenderPassDescription::set_render_area(const vk::Rect2D &area) {
+        render_area = area;
+        return *this;
+    }
+
+    RenderPassDescription &RenderPassDescription::add_color_attachment(const RenderAttachment &attachment) {
+        if (color_attachments.size() >= MAX_COLOR_ATTACHMENTS) {
+            throw std::runtime_error("Too many color attachments in render pass");
+        }
+
+        color_attachments.push_back(attachment);
+        return *this;
+    }
+
+    RenderPassDescription &RenderPassDescription::set_depth_attachment(const RenderAttachment &attachment) {
+        depth_attachment = attachment;
+        return *this;
+    }
+
+    RenderPassDescription &RenderPassDescription::set_stencil_attachment(const RenderAttachment &attachment) {
+        stencil_attachment = attachment;
+        return *this;
+    }
+
+    RenderPassDescription &RenderPassDescription::set_depth_stencil_attachment(const RenderAttachment &attachment, vk::AttachmentLoadOp stencil_load_op,
+                                                                               vk::AttachmentStoreOp stencil_store_op) {
+        depth_attachment = attachment;
+
+        stencil_attachment           = attachment;
+        stencil_attachment->load_op  = stencil_load_op;
+        stencil_attachment->store_op = stencil_store_op;
+        return *this;
+    }
+
+    void begin_render_pass(const Context &ctx, const vk::CommandBuffer &cmd, const RenderPassDescription &description) {
+        if (description.color_attachments.size() > RenderPassDescription::MAX_COLOR_ATTACHMENTS) {
+            throw std::runtime_error("Too many color attachments in render pass");
+        }
+
+        const bool load_op_none = ctx.enabled_features().load_store_op_none;
+
+        BarrierBatch                                                                          barriers;
+        std::array<vk::RenderingAttachmentInfo, RenderPassDescription::MAX_COLOR_ATTACHMENTS> colors;
+        vk::RenderingAttachmentInfo                                                           depth;
+        vk::RenderingAttachmentInfo                                                           stencil;
+
+        const auto color_count = static_cast<uint32_t>(description.color_attachments.size());
+        for (uint32_t i = 0; i < color_count; i++) {
+            const auto &attachment = description.color_attachments[i];
+            add_begin_barriers(barriers, attachment, slot_range(attachment, vk::ImageAspectFlagBits::eColor), vk::ImageLayout::eColorAttachmentOptimal);
+            colors[i] = rendering_attachment(attachment, vk::ImageLayout::eColorAttachmentOptimal, load_op_none);
+        }
+
+        if (description.depth_attachment) {
+            add_begin_barriers(barriers, *description.depth_attachment, depth_range(description), vk::ImageLayout::eDepthStencilAttachmentOptimal);
+            depth = rendering_attachment(*description.depth_attachment, vk::ImageLayout::eDepthStencilAttachmentOptimal, load_op_none);
+        }
+        if (description.stencil_attachment) {
+            if (!shares_depth_image(description)) {
+                add_begin_barriers(barriers, *description.stencil_attachment, slot_range(*description.stencil_attachment, vk::ImageAspectFlagBits::eStencil),
+                                   vk::ImageLayout::eDepthStencilAttachmentOptimal);
+            }
+            stencil = rendering_attachment(*description.stencil_attachment, vk::ImageLayout::eDepthStencilAttachmentOptimal, load_op_none);
+        }
+
+        barriers.record(cmd);
+
+        vk::RenderingInfo info{};
+        info.setRenderArea(description.render_area);
+        info.setLayerCount(description.layer_count);
+        info.setViewMask(description.view_mask);
+        info.setColorAttachmentCount(color_count);
+        info.setPColorAttachments(colors.data());
+        info.setPDepthAttachment(description.depth_attachment ? &depth : nullptr);
+        info.setPStencilAttachment(description.stencil_attachment ? &stencil : nullptr);
+
+        cmd.beginRendering(info);
+    }
+
+    void end_render_pass(const vk::CommandBuffer &cmd, const RenderPassDescription &description) {
+        cmd.endRendering();
+
+        BarrierBatch barriers;
+        for (const auto &attachment : description.color_attachments) {
+            add_end_barriers(barriers, attachment, slot_range(attachment, vk::ImageAspectFlagBits::eColor), vk::ImageLayout::eColorAttachmentOptimal);
+        }
+        if (description.depth_attachment) {
+            add_end_barriers(barriers, *description.depth_attachment, depth_range(description), vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        }
+        if (description.stencil_attachment && !shares_depth_image(description)) {
+            add_end_barriers(barriers, *description.stencil_attachment, slot_range(*description.stencil_attachment, vk::ImageAspectFlagBits::eStencil),
+                             vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        }
+
+        barriers.record(cmd);
+    }
+
+    namespace {
+        vk::ImageAspectFlags format_aspect(vk::Format format) {
+            switch (format) {
+            case vk::Format::eD16Unorm:
+            case vk::Format::eX8D24UnormPack32:
+            case vk::Format::eD32Sfloat:
+                return vk::ImageAspectFlagBits::eDepth;
+            case vk::Format::eS8Uint:
+                return vk::ImageAspectFlagBits::eStencil;
+            case vk::Format::eD16UnormS8Uint:
+            case vk::Format::eD24UnormS8Uint:
+            case vk::Format::eD32SfloatS8Uint:
+                return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+            default:
+                return vk::ImageAspectFlagBits::eColor;
+            }
+        }
+
+        bool has_lazily_allocated_memory(vk::PhysicalDevice physical_device) {
+            const auto properties = physical_device.getMemoryProperties();
+            for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+                if (properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    } // namespace
+
+    AttachmentImage::AttachmentImage(const std::shared_ptr<Context> &context, const AttachmentImageInfo &info)
+        : m_context(context), m_info(info), m_aspect(format_aspect(info.format)) {
+        const bool          color = m_aspect == vk::ImageAspectFlagBits::eColor;
+        vk::ImageUsageFlags usage = info.usage | (color ? vk::ImageUsageFlagBits::eColorAttachment : vk::ImageUsageFlagBits::eDepthStencilAttachment);
+
+        VmaAllocationCreateInfo allocation_info{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE};
+        if (info.transient) {
+            const vk::ImageUsageFlags attachment_usages =
+                vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eInputAttachment;
+            if (usage & ~attachment_usages) {
+                throw std::runtime_error("Transient attachment images can only have attachment usages");
+            }
+
+            usage |= vk::ImageUsageFlagBits::eTransientAttachment;
+
+            // desktop GPUs have no lazily allocated memory, there it is an ordinary device local image
+            m_lazy = has_lazily_allocated_memory(m_context->physical_device());
+            if (m_lazy) {
+                allocation_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            }
+        }
+
+        m_image = m_context->allocate_image(vk::ImageCreateInfo{{},
+                                                                vk::ImageType::e2D,
+                                                                info.format,
+                                                                vk::Extent3D{info.extent.width, info.extent.height, 1},
+                                                                1,
+                                                                1,
+                                                                info.samples,
+                                                                vk::ImageTiling::eOptimal,
+                                                                usage,
+                                                                vk::SharingMode::eExclusive,
+                                                                {},
+                                                                vk::ImageLayout::eUndefined},
+                                            allocation_info);
+
+        m_view = m_context->device().createImageView(
+            vk::ImageViewCreateInfo{{}, m_image.resource, vk::ImageViewType::e2D, info.format, {}, vk::ImageSubresourceRange{m_aspect, 0, 1, 0, 1}});
+    }
+
+    std::shared_ptr<AttachmentImage> AttachmentImage::create(const std::shared_ptr<Context> &context, const AttachmentImageInfo &info) {
+        return std::shared_ptr<AttachmentImage>(new AttachmentImage(context, info));
+    }
+
+    AttachmentImage::~AttachmentImage() {
+        m_context->device().destroyImageView(m_view);
+        m_context->free_image(m_image);
+    }
+
+    RenderAttachment AttachmentImage::attachment(vk::AttachmentLoadOp load_op, vk::AttachmentStoreOp store_op, const vk::ClearValue &clear_value) const {
+        RenderAttachment attachment{};
+        attachment.image          = m_image.resource;
+        attachment.image_view     = m_view;
+        attachment.load_op        = load_op;
+        attachment.store_op       = store_op;
+        attachment.clear_value    = clear_value;
+        attachment.isr.aspectMask = m_aspect;
+        attachment.transient      = m_info.transient;
+        return attachment;
+    }
+} // namespace neuron::render
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace neuron::render {
+
+    // One attachment of a RenderPassDescription. Loads and stores are what a pass costs in memory bandwidth, so only
+    // load what the pass reads back and only store what a later pass or the display uses.
+    struct RenderAttachment {
+        vk::Image     image;
+        vk::ImageView image_view;
+
+        // eLoad and eNone keep the contents, so they need a defined initial_layout. eNone falls back to eLoad without
+        // EnabledFeatureSet::load_store_op_none.
+        vk::AttachmentLoadOp  load_op  = vk::AttachmentLoadOp::eClear;
+        vk::AttachmentStoreOp store_op = vk::AttachmentStoreOp::eStore;
+        vk::ClearValue        clear_value;
+
+        // Layout before the pass; eUndefined discards the contents.
+        vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined;
+        // Layout after the pass; eUndefined leaves it in the attachment layout.
+        vk::ImageLayout final_layout = vk::ImageLayout::eUndefined;
+
+        // An empty aspect mask means the slot's aspect: color, depth or stencil.
+        vk::ImageSubresourceRange isr = {{}, 0, 1, 0, 1};
+
+        // Multisample resolve into a single-sample image at the end of the pass.
+        vk::Image               resolve_image;
+        vk::ImageView           resolve_image_view;
+        vk::ResolveModeFlagBits resolve_mode         = vk::ResolveModeFlagBits::eNone;
+        vk::ImageLayout         resolve_final_layout = vk::ImageLayout::eUndefined;
+
+        // Only used inside the pass, e.g. a multisampled target that is resolved or a depth buffer nothing reads later:
+        // never stored, whatever store_op says. See AttachmentImageInfo::transient for the memory side.
+        bool transient = false;
+    };
+
+    // A dynamic rendering pass: any number of color attachments up to MAX_COLOR_ATTACHMENTS, plus depth and stencil,
+    // each with its own load/store ops, layouts and resolve target. Build it once and update the images per frame;
+    // beginning a pass does not allocate.
+    struct NEURON_API RenderPassDescription {
+        static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+
+        vk::Rect2D render_area;
+        uint32_t   layer_count = 1;
+        uint32_t   view_mask   = 0;
+
+        std::vector<RenderAttachment>   color_attachments;
+        std::optional<RenderAttachment> depth_attachment;
+        std::optional<RenderAttachment> stencil_attachment;
+
+        RenderPassDescription &set_render_area(const vk::Rect2D &area);
+        RenderPassDescription &add_color_attachment(const RenderAttachment &attachment);
+        RenderPassDescription &set_depth_attachment(const RenderAttachment &attachment);
+        RenderPassDescription &set_stencil_attachment(const RenderAttachment &attachment);
+        // One image for both; the stencil aspect only takes the given ops.
+        RenderPassDescription &set_depth_stencil_attachment(const RenderAttachment &attachment, vk::AttachmentLoadOp stencil_load_op = vk::AttachmentLoadOp::eDontCare,
+                                                            vk::AttachmentStoreOp stencil_store_op = vk::AttachmentStoreOp::eDontCare);
+    };
+
+    // Transitions the attachments from their initial layouts and begins rendering.
+    void NEURON_API begin_render_pass(const Context &ctx, const vk::CommandBuffer &cmd, const RenderPassDescription &description);
+    // Ends rendering and transitions the attachments (and resolve targets) that have a final layout.
+    void NEURON_API end_render_pass(const vk::CommandBuffer &cmd, const RenderPassDescription &description);
+
+    template <typename F>
+        requires std::invocable<F &, const vk::CommandBuffer &>
+    inline void render_pass(const Context &ctx, const vk::CommandBuffer &cmd, const RenderPassDescription &description, F &&f) {
+        begin_render_pass(ctx, cmd, description);
+        f(cmd);
+        end_render_pass(cmd, description);
+    }
+
+    struct AttachmentImageInfo {
+        vk::Format              format;
+        vk::Extent2D            extent;
+        vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+        vk::ImageUsageFlags     usage   = {}; // on top of the color or depth/stencil attachment usage
+
+        // Never stored (RenderAttachment::transient): lazily allocated memory where the device has it, which tiled GPUs
+        // may never back at all. Only attachment usages are allowed then.
+        bool transient = false;
+    };
+
+    // An image and view to render into, sized for one pass setup; recreate it when the extent changes.
+    class NEURON_API AttachmentImage {
+        AttachmentImage(const std::shared_ptr<Context> &context, const AttachmentImageInfo &info);
+
+      public:
+        static std::shared_ptr<AttachmentImage> create(const std::shared_ptr<Context> &context, const AttachmentImageInfo &info);
+
+        ~AttachmentImage();
+
+        AttachmentImage(const AttachmentImage &other)            = delete;
+        AttachmentImage &operator=(const AttachmentImage &other) = delete;
+
+        [[nodiscard]] inline vk::Image                  image() const { return m_image.resource; }
+        [[nodiscard]] inline vk::ImageView              image_view() const { return m_view; }
+        [[nodiscard]] inline const AttachmentImageInfo &info() const { return m_info; }
+        [[nodiscard]] inline vk::ImageAspectFlags       aspect() const { return m_aspect; }
+        [[nodiscard]] inline bool                       lazily_allocated() const { return m_lazy; }
+
+        // A RenderAttachment for this image with the given ops; transient images are marked transient.
+        [[nodiscard]] RenderAttachment attachment(vk::AttachmentLoadOp load_op, vk::AttachmentStoreOp store_op, const vk::ClearValue &clear_value = {}) const;
+
+      private:
+        std::shared_ptr<Context> m_context;
+        AttachmentImageInfo      m_info;
+        VmaAllocated<vk::Image>  m_image;
+        vk::ImageView            m_view;
+        vk::ImageAspectFlags     m_aspect;
+        bool                     m_lazy = false;
+    };
+
+} // namespace neuron::render
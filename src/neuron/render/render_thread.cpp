@@ -0,0 +1,59 @@
+#include "render_thread.hpp"
+
+#include <utility>
+
+namespace neuron::render {
+    RenderThread::RenderThread(RenderThreadCallbacks callbacks) : m_callbacks(std::move(callbacks)) {
+        // last, the thread reads the members above
+        m_thread = std::thread(&RenderThread::thread_main, this);
+    }
+
+    std::shared_ptr<RenderThread> RenderThread::create(RenderThreadCallbacks callbacks) {
+        return std::shared_ptr<RenderThread>(new RenderThread(std::move(callbacks)));
+    }
+
+    RenderThread::~RenderThread() {
+        try {
+            stop();
+        } catch (...) {}
+    }
+
+    void RenderThread::stop() {
+        m_stop_requested.store(true, std::memory_order_release);
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        if (m_exception) {
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+        }
+    }
+
+    void RenderThread::thread_main() {
+        try {
+            if (m_callbacks.start) {
+                m_callbacks.start();
+            }
+
+            while (!m_stop_requested.load(std::memory_order_acquire)) {
+                m_callbacks.frame();
+                m_frame_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        } catch (...) {
+            m_exception = std::current_exception();
+        }
+
+        // even after a failed frame, so the device is idle before the owner tears down what the frames used
+        try {
+            if (m_callbacks.finish) {
+                m_callbacks.finish();
+            }
+        } catch (...) {
+            if (!m_exception) {
+                m_exception = std::current_exception();
+            }
+        }
+
+        m_running.store(false, std::memory_order_release);
+    }
+} // namespace neuron::render
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "neuron/base.hpp"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace neuron::render {
+
+    // All run on the render thread.
+    struct RenderThreadCallbacks {
+        std::function<void()> start;  // before the first frame
+        std::function<void()> frame;  // acquire, record, submit and present one frame
+        std::function<void()> finish; // after the last frame, e.g. wait for the device and release per-thread resources
+    };
+
+    // Runs the frame loop on a dedicated thread, so frames keep coming while the main thread blocks in the OS event loop
+    // (window drags and resizes) and slow events no longer delay them. Whatever the callbacks render with, the
+    // DisplaySystem in particular, belongs to the render thread while it runs; the main thread talks to it through a
+    // WindowEventQueue and the window's CachedExtentProvider.
+    class NEURON_API RenderThread {
+        explicit RenderThread(RenderThreadCallbacks callbacks);
+
+      public:
+        static std::shared_ptr<RenderThread> create(RenderThreadCallbacks callbacks);
+
+        // Stops the thread; an exception from a callback is dropped here, call stop() to see it.
+        ~RenderThread();
+
+        RenderThread(const RenderThread &other)            = delete;
+        RenderThread &operator=(const RenderThread &other) = delete;
+
+        // Lets the current frame finish, runs finish and joins. Rethrows the first exception thrown by a callback.
+        void stop();
+
+        // False once the loop has ended, including because a callback threw.
+        [[nodiscard]] inline bool is_running() const { return m_running.load(std::memory_order_acquire); }
+
+        [[nodiscard]] inline uint64_t frame_count() const { return m_frame_count.load(std::memory_order_relaxed); }
+
+      private:
+        void thread_main();
+
+        RenderThreadCallbacks m_callbacks;
+
+        std::atomic<bool>     m_stop_requested{false};
+        std::atomic<bool>     m_running{true};
+        std::atomic<uint64_t> m_frame_count{0};
+        std::exception_ptr    m_exception;
+
+        std::thread m_thread;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,605 @@
+#include "shader_reflection.hpp"
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace neuron::render {
+    namespace {
+        constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+        namespace op {
+            constexpr uint32_t EntryPoint                   = 15;
+            constexpr uint32_t ExecutionMode                = 16;
+            constexpr uint32_t TypeBool                     = 20;
+            constexpr uint32_t TypeInt                      = 21;
+            constexpr uint32_t TypeFloat                    = 22;
+            constexpr uint32_t TypeVector                   = 23;
+            constexpr uint32_t TypeMatrix                   = 24;
+            constexpr uint32_t TypeImage                    = 25;
+            constexpr uint32_t TypeSampler                  = 26;
+            constexpr uint32_t TypeSampledImage             = 27;
+            constexpr uint32_t TypeArray                    = 28;
+            constexpr uint32_t TypeRuntimeArray             = 29;
+            constexpr uint32_t TypeStruct                   = 30;
+            constexpr uint32_t TypePointer                  = 32;
+            constexpr uint32_t Constant                     = 43;
+            constexpr uint32_t SpecConstant                 = 50;
+            constexpr uint32_t Variable                     = 59;
+            constexpr uint32_t Decorate                     = 71;
+            constexpr uint32_t MemberDecorate               = 72;
+            constexpr uint32_t TypeAccelerationStructureKHR = 5341;
+        } // namespace op
+
+        namespace decoration {
+            constexpr uint32_t Block         = 2;
+            constexpr uint32_t BufferBlock   = 3;
+            constexpr uint32_t RowMajor      = 4;
+            constexpr uint32_t ArrayStride   = 6;
+            constexpr uint32_t MatrixStride  = 7;
+            constexpr uint32_t BuiltIn       = 11;
+            constexpr uint32_t Location      = 30;
+            constexpr uint32_t Binding       = 33;
+            constexpr uint32_t DescriptorSet = 34;
+            constexpr uint32_t Offset        = 35;
+        } // namespace decoration
+
+        namespace storage {
+            constexpr uint32_t UniformConstant = 0;
+            constexpr uint32_t Input           = 1;
+            constexpr uint32_t Uniform         = 2;
+            constexpr uint32_t PushConstant    = 9;
+            constexpr uint32_t StorageBuffer   = 12;
+        } // namespace storage
+
+        constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+        constexpr uint32_t IMAGE_DIM_BUFFER          = 5;
+        constexpr uint32_t IMAGE_DIM_SUBPASS_DATA    = 6;
+
+        struct SpirvType {
+            uint32_t              op;
+            std::vector<uint32_t> operands; // everything after the result id
+        };
+
+        struct Decorations {
+            std::optional<uint32_t> location;
+            std::optional<uint32_t> binding;
+            std::optional<uint32_t> set;
+            std::optional<uint32_t> array_stride;
+            std::optional<uint32_t> matrix_stride;
+            std::optional<uint32_t> offset;
+
+            bool block        = false;
+            bool buffer_block = false;
+            bool builtin      = false;
+            bool row_major    = false;
+        };
+
+        struct SpirvVariable {
+            uint32_t id;
+            uint32_t pointer_type;
+            uint32_t storage_class;
+        };
+
+        struct SpirvModule {
+            std::unordered_map<uint32_t, SpirvType>   types;
+            std::unordered_map<uint32_t, uint32_t>    constants;
+            std::unordered_map<uint32_t, Decorations> decorations;
+            std::unordered_map<uint64_t, Decorations> member_decorations;
+            std::vector<SpirvVariable>                variables;
+
+            std::optional<uint32_t> entry_point;
+            uint32_t                execution_model = 0;
+            std::vector<uint32_t>   interface_ids;
+            std::array<uint32_t, 3> local_size = {1, 1, 1};
+
+            [[nodiscard]] const SpirvType &type(uint32_t id) const {
+                auto it = types.find(id);
+                if (it == types.end()) {
+                    throw std::runtime_error("SPIR-V reflection: reference to unknown type");
+                }
+                return it->second;
+            }
+
+            [[nodiscard]] const Decorations *decoration(uint32_t id) const {
+                auto it = decorations.find(id);
+                return it == decorations.end() ? nullptr : &it->second;
+            }
+
+            [[nodiscard]] const Decorations *member_decoration(uint32_t id, uint32_t member) const {
+                auto it = member_decorations.find((static_cast<uint64_t>(id) << 32) | member);
+                return it == member_decorations.end() ? nullptr : &it->second;
+            }
+
+            [[nodiscard]] uint32_t constant(uint32_t id) const {
+                auto it = constants.find(id);
+                if (it == constants.end()) {
+                    throw std::runtime_error("SPIR-V reflection: array length is not a constant");
+                }
+                return it->second;
+            }
+        };
+
+        void apply_decoration(Decorations &d, uint32_t dec, const uint32_t *literals, uint32_t literal_count) {
+            const uint32_t value = literal_count > 0 ? literals[0] : 0;
+            switch (dec) {
+            case decoration::Block:
+                d.block = true;
+                break;
+            case decoration::BufferBlock:
+                d.buffer_block = true;
+                break;
+            case decoration::RowMajor:
+                d.row_major = true;
+                break;
+            case decoration::ArrayStride:
+                d.array_stride = value;
+                break;
+            case decoration::MatrixStride:
+                d.matrix_stride = value;
+                break;
+            case decoration::BuiltIn:
+                d.builtin = true;
+                break;
+            case decoration::Location:
+                d.location = value;
+                break;
+            case decoration::Binding:
+                d.binding = value;
+                break;
+            case decoration::DescriptorSet:
+                d.set = value;
+                break;
+            case decoration::Offset:
+                d.offset = value;
+                break;
+            default:
+                break;
+            }
+        }
+
+        SpirvModule parse(std::span<const uint32_t> spirv) {
+            if (spirv.size() < 5 || spirv[0] != SPIRV_MAGIC) {
+                throw std::runtime_error("SPIR-V reflection: invalid module header");
+            }
+
+            SpirvModule m;
+
+            size_t i = 5;
+            while (i < spirv.size()) {
+                const uint32_t word_count = spirv[i] >> 16;
+                const uint32_t opcode     = spirv[i] & 0xFFFFU;
+
+                if (word_count == 0 || i + word_count > spirv.size()) {
+                    throw std::runtime_error("SPIR-V reflection: truncated instruction");
+                }
+
+                const uint32_t *w = &spirv[i];
+
+                switch (opcode) {
+                case op::EntryPoint:
+                    if (!m.entry_point.has_value()) {
+                        m.execution_model = w[1];
+                        m.entry_point     = w[2];
+
+                        // skip the null terminated, word padded name
+                        uint32_t k = 3;
+                        while (k < word_count) {
+                            const uint32_t word = w[k++];
+                            if ((word & 0xFF000000U) == 0 || (word & 0x00FF0000U) == 0 || (word & 0x0000FF00U) == 0 || (word & 0x000000FFU) == 0) {
+                                break;
+                            }
+                        }
+                        m.interface_ids.assign(w + k, w + word_count);
+                    }
+                    break;
+                case op::ExecutionMode:
+                    if (m.entry_point == w[1] && w[2] == EXECUTION_MODE_LOCAL_SIZE && word_count >= 6) {
+                        m.local_size = {w[3], w[4], w[5]};
+                    }
+                    break;
+                case op::TypeBool:
+                case op::TypeInt:
+                case op::TypeFloat:
+                case op::TypeVector:
+                case op::TypeMatrix:
+                case op::TypeImage:
+                case op::TypeSampler:
+                case op::TypeSampledImage:
+                case op::TypeArray:
+                case op::TypeRuntimeArray:
+                case op::TypeStruct:
+                case op::TypePointer:
+                case op::TypeAccelerationStructureKHR:
+                    m.types[w[1]] = SpirvType{opcode, std::vector<uint32_t>(w + 2, w + word_count)};
+                    break;
+                case op::Constant:
+                case op::SpecConstant:
+                    if (word_count >= 4) {
+                        m.constants[w[2]] = w[3];
+                    }
+                    break;
+                case op::Variable:
+                    m.variables.push_back(SpirvVariable{w[2], w[1], w[3]});
+                    break;
+                case op::Decorate:
+                    apply_decoration(m.decorations[w[1]], w[2], w + 3, word_count - 3);
+                    break;
+                case op::MemberDecorate:
+                    apply_decoration(m.member_decorations[(static_cast<uint64_t>(w[1]) << 32) | w[2]], w[3], w + 4, word_count - 4);
+                    break;
+                default:
+                    break;
+                }
+
+                i += word_count;
+            }
+
+            return m;
+        }
+
+        vk::ShaderStageFlagBits stage_from_execution_model(uint32_t model) {
+            switch (model) {
+            case 0:
+                return vk::ShaderStageFlagBits::eVertex;
+            case 1:
+                return vk::ShaderStageFlagBits::eTessellationControl;
+            case 2:
+                return vk::ShaderStageFlagBits::eTessellationEvaluation;
+            case 3:
+                return vk::ShaderStageFlagBits::eGeometry;
+            case 4:
+                return vk::ShaderStageFlagBits::eFragment;
+            case 5:
+                return vk::ShaderStageFlagBits::eCompute;
+            case 5313:
+                return vk::ShaderStageFlagBits::eRaygenKHR;
+            case 5314:
+                return vk::ShaderStageFlagBits::eIntersectionKHR;
+            case 5315:
+                return vk::ShaderStageFlagBits::eAnyHitKHR;
+            case 5316:
+                return vk::ShaderStageFlagBits::eClosestHitKHR;
+            case 5317:
+                return vk::ShaderStageFlagBits::eMissKHR;
+            case 5318:
+                return vk::ShaderStageFlagBits::eCallableKHR;
+            case 5364:
+                return vk::ShaderStageFlagBits::eTaskEXT;
+            case 5365:
+                return vk::ShaderStageFlagBits::eMeshEXT;
+            default:
+                return vk::ShaderStageFlagBits::eAll;
+            }
+        }
+
+        uint32_t type_size(const SpirvModule &m, uint32_t type_id, const Decorations *member_decoration) {
+            const SpirvType &t = m.type(type_id);
+
+            switch (t.op) {
+            case op::TypeBool:
+                return 4;
+            case op::TypeInt:
+            case op::TypeFloat:
+                return t.operands[0] / 8;
+            case op::TypeVector:
+                return t.operands[1] * type_size(m, t.operands[0], nullptr);
+            case op::TypeMatrix: {
+                const uint32_t columns = t.operands[1];
+                if (member_decoration && member_decoration->matrix_stride.has_value()) {
+                    if (member_decoration->row_major) {
+                        const uint32_t rows = m.type(t.operands[0]).operands[1];
+                        return rows * member_decoration->matrix_stride.value();
+                    }
+                    return columns * member_decoration->matrix_stride.value();
+                }
+                return columns * type_size(m, t.operands[0], nullptr);
+            }
+            case op::TypeArray: {
+                const uint32_t     length = m.constant(t.operands[1]);
+                const Decorations *d      = m.decoration(type_id);
+                const uint32_t     stride = d && d->array_stride.has_value() ? d->array_stride.value() : type_size(m, t.operands[0], member_decoration);
+                return length * stride;
+            }
+            case op::TypeRuntimeArray:
+                return 0;
+            case op::TypeStruct: {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member < t.operands.size(); member++) {
+                    const Decorations *md     = m.member_decoration(type_id, member);
+                    const uint32_t     offset = md && md->offset.has_value() ? md->offset.value() : size;
+                    size                      = std::max(size, offset + type_size(m, t.operands[member], md));
+                }
+                return size;
+            }
+            case op::TypePointer:
+                return 8; // physical storage buffer pointers
+            default:
+                return 0;
+            }
+        }
+
+        vk::Format vertex_format(const SpirvModule &m, uint32_t type_id, uint32_t &size) {
+            const SpirvType &t          = m.type(type_id);
+            uint32_t         components = 1;
+            const SpirvType *scalar     = &t;
+
+            if (t.op == op::TypeVector) {
+                components = t.operands[1];
+                scalar     = &m.type(t.operands[0]);
+            }
+
+            if (components < 1 || components > 4) {
+                return vk::Format::eUndefined;
+            }
+
+            static constexpr vk::Format float32[] = {vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat};
+            static constexpr vk::Format sint32[]  = {vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint};
+            static constexpr vk::Format uint32[]  = {vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint};
+            static constexpr vk::Format float64[] = {vk::Format::eR64Sfloat, vk::Format::eR64G64Sfloat, vk::Format::eR64G64B64Sfloat, vk::Format::eR64G64B64A64Sfloat};
+            static constexpr vk::Format float16[] = {vk::Format::eR16Sfloat, vk::Format::eR16G16Sfloat, vk::Format::eR16G16B16Sfloat, vk::Format::eR16G16B16A16Sfloat};
+            static constexpr vk::Format sint16[]  = {vk::Format::eR16Sint, vk::Format::eR16G16Sint, vk::Format::eR16G16B16Sint, vk::Format::eR16G16B16A16Sint};
+            static constexpr vk::Format uint16[]  = {vk::Format::eR16Uint, vk::Format::eR16G16Uint, vk::Format::eR16G16B16Uint, vk::Format::eR16G16B16A16Uint};
+
+            if (scalar->operands.empty()) {
+                return vk::Format::eUndefined;
+            }
+
+            const uint32_t width = scalar->operands[0];
+            size                 = components * width / 8;
+
+            if (scalar->op == op::TypeFloat) {
+                if (width == 32)
+                    return float32[components - 1];
+                if (width == 64)
+                    return float64[components - 1];
+                if (width == 16)
+                    return float16[components - 1];
+            } else if (scalar->op == op::TypeInt) {
+                const bool is_signed = scalar->operands[1] != 0;
+                if (width == 32)
+                    return is_signed ? sint32[components - 1] : uint32[components - 1];
+                if (width == 16)
+                    return is_signed ? sint16[components - 1] : uint16[components - 1];
+            }
+
+            return vk::Format::eUndefined;
+        }
+
+        std::optional<vk::DescriptorType> descriptor_type(const SpirvModule &m, uint32_t type_id, uint32_t storage_class) {
+            const SpirvType &t = m.type(type_id);
+
+            if (storage_class == storage::StorageBuffer) {
+                return vk::DescriptorType::eStorageBuffer;
+            }
+
+            if (storage_class == storage::Uniform) {
+                const Decorations *d = m.decoration(type_id);
+                if (d && d->buffer_block) {
+                    return vk::DescriptorType::eStorageBuffer;
+                }
+                return vk::DescriptorType::eUniformBuffer;
+            }
+
+            switch (t.op) {
+            case op::TypeSampler:
+                return vk::DescriptorType::eSampler;
+            case op::TypeSampledImage:
+                return vk::DescriptorType::eCombinedImageSampler;
+            case op::TypeImage: {
+                const uint32_t dim     = t.operands[1];
+                const uint32_t sampled = t.operands[5];
+                if (dim == IMAGE_DIM_BUFFER) {
+                    return sampled == 2 ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+                }
+                if (dim == IMAGE_DIM_SUBPASS_DATA) {
+                    return vk::DescriptorType::eInputAttachment;
+                }
+                return sampled == 2 ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+            }
+            case op::TypeAccelerationStructureKHR:
+                return vk::DescriptorType::eAccelerationStructureKHR;
+            default:
+                return std::nullopt;
+            }
+        }
+    } // namespace
+
+    ShaderReflection reflect_spirv(std::span<const uint32_t> spirv) {
+        const SpirvModule m = parse(spirv);
+
+        ShaderReflection reflection{};
+        reflection.stage      = stage_from_execution_model(m.execution_model);
+        reflection.local_size = m.local_size;
+
+        std::set<uint32_t> interface_ids(m.interface_ids.begin(), m.interface_ids.end());
+
+        for (const auto &var : m.variables) {
+            const SpirvType &pointer = m.type(var.pointer_type);
+            if (pointer.op != op::TypePointer) {
+                continue;
+            }
+
+            uint32_t           pointee = pointer.operands[1];
+            const Decorations *d       = m.decoration(var.id);
+
+            switch (var.storage_class) {
+            case storage::UniformConstant:
+            case storage::Uniform:
+            case storage::StorageBuffer: {
+                if (!d || !d->binding.has_value()) {
+                    continue;
+                }
+
+                ReflectedDescriptorBinding binding{d->set.value_or(0), d->binding.value(), vk::DescriptorType::eSampler, 1};
+
+                while (true) {
+                    const SpirvType &t = m.type(pointee);
+                    if (t.op == op::TypeArray) {
+                        binding.count *= m.constant(t.operands[1]);
+                        pointee = t.operands[0];
+                    } else if (t.op == op::TypeRuntimeArray) {
+                        binding.count         = 0;
+                        binding.runtime_array = true;
+                        pointee               = t.operands[0];
+                    } else {
+                        break;
+                    }
+                }
+
+                auto type = descriptor_type(m, pointee, var.storage_class);
+                if (!type.has_value()) {
+                    continue;
+                }
+
+                binding.type = type.value();
+                reflection.descriptor_bindings.push_back(binding);
+            } break;
+            case storage::PushConstant: {
+                const SpirvType &block = m.type(pointee);
+                if (block.op != op::TypeStruct || block.operands.empty()) {
+                    continue;
+                }
+
+                uint32_t begin = UINT32_MAX;
+                for (uint32_t member = 0; member < block.operands.size(); member++) {
+                    const Decorations *md = m.member_decoration(pointee, member);
+                    begin                 = std::min(begin, md && md->offset.has_value() ? md->offset.value() : 0U);
+                }
+
+                const uint32_t end             = type_size(m, pointee, nullptr);
+                reflection.push_constant_range = vk::PushConstantRange{reflection.stage, begin, end - begin};
+            } break;
+            case storage::Input: {
+                if (reflection.stage != vk::ShaderStageFlagBits::eVertex || !interface_ids.contains(var.id)) {
+                    continue;
+                }
+
+                if (!d || d->builtin || !d->location.has_value()) {
+                    continue;
+                }
+
+                const SpirvType &t = m.type(pointee);
+                if (t.op == op::TypeMatrix) {
+                    // matrices take one location per column
+                    for (uint32_t column = 0; column < t.operands[1]; column++) {
+                        ReflectedVertexInput input{d->location.value() + column, vk::Format::eUndefined, 0};
+                        input.format = vertex_format(m, t.operands[0], input.size);
+                        reflection.vertex_inputs.push_back(input);
+                    }
+                } else {
+                    ReflectedVertexInput input{d->location.value(), vk::Format::eUndefined, 0};
+                    input.format = vertex_format(m, pointee, input.size);
+                    reflection.vertex_inputs.push_back(input);
+                }
+            } break;
+            default:
+                break;
+            }
+        }
+
+        std::ranges::sort(reflection.vertex_inputs, {}, &ReflectedVertexInput::location);
+        std::ranges::sort(reflection.descriptor_bindings, [](const ReflectedDescriptorBinding &a, const ReflectedDescriptorBinding &b) {
+            return std::tie(a.set, a.binding) < std::tie(b.set, b.binding);
+        });
+
+        return reflection;
+    }
+
+    ShaderInterface merge_reflections(std::span<const ShaderReflection *const> reflections, bool canonicalize) {
+        ShaderInterface result{};
+
+        struct MergedBinding {
+            vk::DescriptorType   type;
+            uint32_t             count;
+            vk::ShaderStageFlags stages;
+        };
+
+        std::map<std::pair<uint32_t, uint32_t>, MergedBinding> bindings;
+
+        std::optional<uint32_t> pc_begin;
+        uint32_t                pc_end = 0;
+        vk::ShaderStageFlags    pc_stages;
+
+        for (const ShaderReflection *r : reflections) {
+            result.stages |= r->stage;
+
+            if (r->push_constant_range.has_value()) {
+                const auto &range = r->push_constant_range.value();
+                pc_begin          = std::min(pc_begin.value_or(range.offset), range.offset);
+                pc_end            = std::max(pc_end, range.offset + range.size);
+                pc_stages |= r->stage;
+            }
+
+            for (const auto &b : r->descriptor_bindings) {
+                auto [it, inserted] = bindings.try_emplace({b.set, b.binding}, MergedBinding{b.type, b.count, r->stage});
+                if (!inserted) {
+                    if (it->second.type != b.type) {
+                        throw std::runtime_error("SPIR-V reflection: stages disagree on the descriptor type of a binding");
+                    }
+                    it->second.count = std::max(it->second.count, b.count);
+                    it->second.stages |= r->stage;
+                }
+
+                if (b.runtime_array) {
+                    result.runtime_array_sets.insert(b.set);
+                }
+            }
+        }
+
+        vk::ShaderStageFlags canonical_stages = vk::ShaderStageFlagBits::eAllGraphics;
+        if (result.stages & vk::ShaderStageFlagBits::eCompute) {
+            canonical_stages = vk::ShaderStageFlagBits::eCompute;
+        } else if (result.stages & (vk::ShaderStageFlagBits::eTaskEXT | vk::ShaderStageFlagBits::eMeshEXT)) {
+            canonical_stages = vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eTaskEXT | vk::ShaderStageFlagBits::eMeshEXT;
+        }
+
+        if (pc_begin.has_value()) {
+            if (canonicalize) {
+                result.push_constant_ranges.emplace_back(canonical_stages, 0, (pc_end + 15U) & ~15U);
+            } else {
+                result.push_constant_ranges.emplace_back(pc_stages, pc_begin.value(), pc_end - pc_begin.value());
+            }
+        }
+
+        for (const auto &[key, b] : bindings) {
+            result.descriptor_sets[key.first].add_binding(key.second, b.type, canonicalize ? canonical_stages : b.stages, b.count);
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<PipelineLayout> build_pipeline_layout(const std::shared_ptr<Context> &context, const ShaderInterface &shader_interface,
+                                                          const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &overrides) {
+        uint32_t set_count = 0;
+        if (!shader_interface.descriptor_sets.empty()) {
+            set_count = shader_interface.descriptor_sets.rbegin()->first + 1;
+        }
+        if (!overrides.empty()) {
+            set_count = std::max(set_count, overrides.rbegin()->first + 1);
+        }
+
+        PipelineLayoutBuilder builder;
+        for (uint32_t set = 0; set < set_count; set++) {
+            if (auto it = overrides.find(set); it != overrides.end()) {
+                builder.add_descriptor_set_layout(it->second);
+                continue;
+            }
+
+            if (shader_interface.runtime_array_sets.contains(set)) {
+                throw std::runtime_error("Descriptor set with runtime-sized arrays needs an explicit layout (set_descriptor_set_layout)");
+            }
+
+            if (auto it = shader_interface.descriptor_sets.find(set); it != shader_interface.descriptor_sets.end()) {
+                builder.add_descriptor_set_layout(it->second.build(context));
+            } else {
+                builder.add_descriptor_set_layout(DescriptorSetLayoutBuilder{}.build(context));
+            }
+        }
+
+        builder.push_constant_ranges = shader_interface.push_constant_ranges;
+        return builder.build_cached(context);
+    }
+} // namespace neuron::render
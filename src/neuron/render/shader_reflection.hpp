@@ -0,0 +1,60 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "pipeline_layout.hpp"
+
+#include <array>
+#include <map>
+#include <optional>
+#include <set>
+#include <span>
+#include <vector>
+
+namespace neuron::render {
+
+    struct ReflectedDescriptorBinding {
+        uint32_t           set;
+        uint32_t           binding;
+        vk::DescriptorType type;
+        uint32_t           count;         // 0 for runtime-sized arrays
+        bool               runtime_array = false;
+    };
+
+    struct ReflectedVertexInput {
+        uint32_t   location;
+        vk::Format format;
+        uint32_t   size;
+    };
+
+    // Interface of a single SPIR-V entry point, as far as pipeline creation cares about it.
+    struct ShaderReflection {
+        vk::ShaderStageFlagBits                 stage = vk::ShaderStageFlagBits::eAll;
+        std::optional<vk::PushConstantRange>    push_constant_range;
+        std::vector<ReflectedDescriptorBinding> descriptor_bindings;
+        std::vector<ReflectedVertexInput>       vertex_inputs; // vertex stage only, sorted by location
+        std::array<uint32_t, 3>                 local_size = {1, 1, 1}; // compute stage only
+    };
+
+    // Merged interface of every stage of a pipeline.
+    struct ShaderInterface {
+        vk::ShaderStageFlags                           stages;
+        std::vector<vk::PushConstantRange>             push_constant_ranges;
+        std::map<uint32_t, DescriptorSetLayoutBuilder> descriptor_sets;
+        std::set<uint32_t>                             runtime_array_sets;
+    };
+
+    // Throws std::runtime_error on malformed modules.
+    [[nodiscard]] NEURON_API ShaderReflection reflect_spirv(std::span<const uint32_t> spirv);
+
+    // Merges per-stage reflections. When canonicalize is set, stage masks are widened to every stage of the pipeline kind
+    // (all graphics or compute) and push constants collapse to a single range starting at 0, so pipelines with compatible
+    // interfaces end up with identical layouts.
+    [[nodiscard]] NEURON_API ShaderInterface merge_reflections(std::span<const ShaderReflection *const> reflections, bool canonicalize = true);
+
+    // Builds (through the context caches) the layout described by an interface. Sets in `overrides` replace the reflected
+    // ones, which is required for runtime-sized arrays such as the bindless table.
+    [[nodiscard]] NEURON_API std::shared_ptr<PipelineLayout> build_pipeline_layout(const std::shared_ptr<Context>                                    &context,
+                                                                                   const ShaderInterface                                             &shader_interface,
+                                                                                   const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &overrides = {});
+
+} // namespace neuron::render
@@ -40,10 +40,4 @@ namespace neuron::render {
             cmd.pipelineBarrier(info.target_stage, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, b);
         }
     }
-
-    void simple_render_pass(const vk::CommandBuffer &commandBuffer, const SimpleRenderPassInfo &info, const std::function<void(const vk::CommandBuffer &)> &f) {
-        start_simple_render_pass(commandBuffer, info);
-        f(commandBuffer);
-        end_simple_render_pass(commandBuffer, info);
-    }
 } // namespace neuron::render
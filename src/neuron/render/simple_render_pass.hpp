@@ -3,6 +3,8 @@
 #include "neuron/base.hpp"
 #include "neuron/neuron.hpp"
 
+#include <concepts>
+
 namespace neuron::render {
 
     struct SimpleRenderPassInfo {
@@ -22,6 +24,14 @@ namespace neuron::render {
     void NEURON_API start_simple_render_pass(const vk::CommandBuffer &commandBuffer, const SimpleRenderPassInfo &info);
     void NEURON_API end_simple_render_pass(const vk::CommandBuffer &commandBuffer, const SimpleRenderPassInfo &info);
 
-    void NEURON_API simple_render_pass(const vk::CommandBuffer &commandBuffer, const SimpleRenderPassInfo &info, const std::function<void(const vk::CommandBuffer&)> &f);
+    // f(commandBuffer) records the pass contents. A template rather than a std::function, which would heap-allocate for
+    // lambdas capturing more than a couple of references every time it is called.
+    template <typename F>
+        requires std::invocable<F &, const vk::CommandBuffer &>
+    inline void simple_render_pass(const vk::CommandBuffer &commandBuffer, const SimpleRenderPassInfo &info, F &&f) {
+        start_simple_render_pass(commandBuffer, info);
+        f(commandBuffer);
+        end_simple_render_pass(commandBuffer, info);
+    }
 
 } // namespace neuron::render
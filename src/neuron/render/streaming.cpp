@@ -0,0 +1,648 @@
+#include "streaming.hpp"
+
+#include "async_compute.hpp"
+#include "display_system.hpp"
+#include "submission_scheduler.hpp"
+#include "texture_uploader.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace neuron::render {
+    ResidencyManager::ResidencyManager(const std::shared_ptr<Context> &context, const StreamingSettings &settings)
+        : m_context(context), m_settings(settings), m_transfer_family(context->transfer_queue_family()), m_graphics_family(context->main_queue_family()) {
+        m_transfer_pool = std::make_shared<CommandPool>(m_context, m_transfer_family, true);
+        m_worker        = std::thread([this] { worker(); });
+    }
+
+    std::shared_ptr<ResidencyManager> ResidencyManager::create(const std::shared_ptr<Context> &context, const StreamingSettings &settings) {
+        return std::shared_ptr<ResidencyManager>(new ResidencyManager(context, settings));
+    }
+
+    ResidencyManager::~ResidencyManager() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_worker.join();
+
+        retire_batches(true);
+
+        for (auto &resource : m_resources) {
+            for (auto &state : resource.levels) {
+                free_level_now(state);
+            }
+        }
+
+        for (const auto &pending : m_pending_frees) {
+            if (pending.view) {
+                m_context->device().destroyImageView(pending.view);
+            }
+            if (pending.buffer.resource) {
+                m_context->free_buffer(pending.buffer);
+            }
+            if (pending.image.resource) {
+                m_context->free_image(pending.image);
+            }
+        }
+    }
+
+    StreamingHandle ResidencyManager::register_resource(StreamingResourceInfo info) {
+        if (info.levels.empty()) {
+            throw std::runtime_error("Streamed resource needs at least one level");
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        StreamingHandle handle;
+        if (!m_free_handles.empty()) {
+            handle = m_free_handles.back();
+            m_free_handles.pop_back();
+        } else {
+            handle = static_cast<StreamingHandle>(m_resources.size());
+            m_resources.emplace_back();
+        }
+
+        Resource &resource       = m_resources[handle];
+        resource.levels          = std::vector<LevelState>(info.levels.size());
+        resource.info            = std::move(info);
+        resource.requested_level = 0;
+        resource.last_used_frame = m_frame;
+        resource.alive           = true;
+
+        m_cv.notify_one();
+        return handle;
+    }
+
+    void ResidencyManager::unregister_resource(StreamingHandle handle) {
+        std::lock_guard lock(m_mutex);
+
+        Resource &resource = m_resources.at(handle);
+        if (!resource.alive) {
+            return;
+        }
+
+        // uploads of this resource may still be running on the transfer queue
+        if (std::ranges::any_of(resource.levels, [](const LevelState &s) { return s.status == LevelStatus::Uploading; })) {
+            m_context->transfer_scheduler()->wait(m_batches.back().value);
+        }
+
+        for (auto &state : resource.levels) {
+            // loads still in the worker are dropped there once it sees the new generation
+            if (state.status == LevelStatus::Loading) {
+                continue;
+            }
+
+            if (state.staging.resource) {
+                m_context->free_buffer(state.staging);
+                state.staging = {};
+            }
+            evict_level(state);
+        }
+
+        std::erase_if(m_pending_acquires, [&](const LevelRef &ref) { return ref.handle == handle; });
+
+        resource.alive = false;
+        resource.generation++;
+        resource.info = {};
+        resource.levels.clear();
+        m_free_handles.push_back(handle);
+    }
+
+    void ResidencyManager::request(StreamingHandle handle, uint32_t level) {
+        std::lock_guard lock(m_mutex);
+
+        Resource &resource = m_resources.at(handle);
+        if (!resource.alive) {
+            return;
+        }
+
+        const uint32_t clamped = std::min<uint32_t>(level, static_cast<uint32_t>(resource.levels.size()) - 1);
+        if (clamped != resource.requested_level) {
+            resource.requested_level = clamped;
+            m_cv.notify_one();
+        }
+        resource.last_used_frame = m_frame;
+    }
+
+    std::optional<StreamingView> ResidencyManager::get(StreamingHandle handle) const {
+        std::lock_guard lock(m_mutex);
+
+        const Resource &resource = m_resources.at(handle);
+        const int32_t   level    = resident_level(resource);
+        if (!resource.alive || level < 0) {
+            return std::nullopt;
+        }
+
+        const LevelState &state = resource.levels[level];
+        return StreamingView{static_cast<uint32_t>(level), state.buffer.resource, state.image.resource, state.view};
+    }
+
+    void ResidencyManager::update() {
+        std::lock_guard lock(m_mutex);
+
+        m_frame++;
+        m_uploaded_bytes = 0;
+
+        std::erase_if(m_pending_frees, [&](const PendingFree &pending) {
+            if (m_frame - pending.frame < DisplaySystem::MAX_FRAMES_IN_FLIGHT) {
+                return false;
+            }
+
+            if (pending.view) {
+                m_context->device().destroyImageView(pending.view);
+            }
+            if (pending.buffer.resource) {
+                m_context->free_buffer(pending.buffer);
+            }
+            if (pending.image.resource) {
+                m_context->free_image(pending.image);
+            }
+            m_pending_free_bytes -= pending.size;
+            return true;
+        });
+
+        retire_batches(false);
+
+        // staged levels in priority order, fallbacks first, up to the per-frame upload cap
+        std::vector<LevelRef> staged;
+        for (StreamingHandle handle = 0; handle < m_resources.size(); handle++) {
+            const Resource &resource = m_resources[handle];
+            for (uint32_t level = 0; level < resource.levels.size(); level++) {
+                if (resource.alive && resource.levels[level].status == LevelStatus::Staged) {
+                    staged.push_back({handle, level, resource.generation});
+                }
+            }
+        }
+
+        if (!staged.empty()) {
+            std::ranges::sort(staged, [this](const LevelRef &a, const LevelRef &b) { return loads_before(a, b); });
+
+            UploadBatch batch{m_transfer_pool->allocate_command_buffer(), 0, {}};
+            batch.cmd.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+            for (const auto &ref : staged) {
+                const StreamingLevel &level = m_resources[ref.handle].info.levels[ref.level];
+
+                // always make progress, even with a level larger than the cap
+                if (!batch.levels.empty() && m_uploaded_bytes + level.size > m_settings.max_upload_bytes_per_frame) {
+                    break;
+                }
+
+                LevelState &state = m_resources[ref.handle].levels[ref.level];
+                record_upload(batch.cmd, level, state);
+                state.status = LevelStatus::Uploading;
+
+                batch.levels.push_back(ref);
+                m_uploaded_bytes += level.size;
+            }
+
+            batch.cmd.end();
+
+            batch.value = m_context->transfer_scheduler()->submit({.command_buffers = std::span(&batch.cmd, 1)});
+
+            m_batches.push_back(std::move(batch));
+        }
+
+        // the worker re-evaluates requests, budget and freed staging slots once per frame
+        m_cv.notify_one();
+    }
+
+    void ResidencyManager::record_acquires(const vk::CommandBuffer &graphics_cmd) {
+        std::lock_guard lock(m_mutex);
+
+        if (m_pending_acquires.empty()) {
+            return;
+        }
+
+        std::vector<BufferOwnershipTransfer> buffers;
+        std::vector<ImageOwnershipTransfer>  images;
+
+        for (const auto &ref : m_pending_acquires) {
+            const Resource   &resource = m_resources[ref.handle];
+            const LevelState &state    = resource.levels[ref.level];
+            if (state.buffer.resource) {
+                buffers.push_back({.buffer     = state.buffer.resource,
+                                   .src_stage  = vk::PipelineStageFlagBits::eTransfer,
+                                   .src_access = vk::AccessFlagBits::eTransferWrite,
+                                   .dst_stage  = vk::PipelineStageFlagBits::eAllCommands,
+                                   .dst_access = vk::AccessFlagBits::eMemoryRead});
+            } else {
+                const auto &desc = std::get<StreamingImageDesc>(resource.info.levels[ref.level].desc);
+                images.push_back({.image      = state.image.resource,
+                                  .range      = {vk::ImageAspectFlagBits::eColor, 0, desc.mip_levels, 0, desc.array_layers},
+                                  .old_layout = vk::ImageLayout::eTransferDstOptimal,
+                                  .new_layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                                  .src_stage  = vk::PipelineStageFlagBits::eTransfer,
+                                  .src_access = vk::AccessFlagBits::eTransferWrite,
+                                  .dst_stage  = vk::PipelineStageFlagBits::eAllCommands,
+                                  .dst_access = vk::AccessFlagBits::eShaderRead});
+            }
+        }
+
+        record_ownership_acquire(graphics_cmd, m_transfer_family, m_graphics_family, buffers, images);
+
+        for (const auto &ref : m_pending_acquires) {
+            make_resident(m_resources[ref.handle], ref.level);
+        }
+        m_pending_acquires.clear();
+    }
+
+    StreamingStats ResidencyManager::stats() const {
+        std::lock_guard lock(m_mutex);
+
+        StreamingStats stats{};
+
+        VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(m_context->allocator(), budgets);
+
+        const VkPhysicalDeviceMemoryProperties *properties;
+        vmaGetMemoryProperties(m_context->allocator(), &properties);
+
+        for (uint32_t heap = 0; heap < properties->memoryHeapCount; heap++) {
+            if (properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                stats.device_budget += budgets[heap].budget;
+                stats.device_usage += budgets[heap].usage;
+            }
+        }
+
+        stats.resident_bytes = m_resident_bytes;
+        stats.uploaded_bytes = m_uploaded_bytes;
+        stats.evictions      = m_evictions;
+
+        for (const auto &resource : m_resources) {
+            for (const auto &state : resource.levels) {
+                if (state.status == LevelStatus::Resident) {
+                    stats.resident_levels++;
+                } else if (state.status == LevelStatus::Loading || state.status == LevelStatus::Staged || state.status == LevelStatus::Uploading) {
+                    stats.pending_loads++;
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    void ResidencyManager::worker() {
+        std::unique_lock lock(m_mutex);
+
+        while (!m_stop) {
+            std::optional<LevelRef> job;
+            for (const auto &candidate : load_candidates()) {
+                const StreamingLevel &level = m_resources[candidate.handle].info.levels[candidate.level];
+
+                // fallbacks are pinned and always load, anything else has to fit the budget
+                if (candidate.level == 0 || evict_for(level.size, candidate)) {
+                    job = candidate;
+                    break;
+                }
+            }
+
+            if (!job) {
+                m_cv.wait(lock);
+                continue;
+            }
+
+            // the level description is copied so registrations may reallocate m_resources while loading
+            const StreamingLevel level = m_resources[job->handle].info.levels[job->level];
+            m_resources[job->handle].levels[job->level].status = LevelStatus::Loading;
+
+            lock.unlock();
+
+            LevelState loaded{};
+            bool       failed = false;
+            try {
+                load_level(level, loaded);
+            } catch (const std::exception &e) {
+                std::cerr << "Failed to stream resource " << job->handle << " level " << job->level << ": " << e.what() << std::endl;
+                free_level_now(loaded);
+                failed = true;
+            }
+
+            lock.lock();
+
+            Resource &resource = m_resources[job->handle];
+            if (!resource.alive || resource.generation != job->generation) {
+                free_level_now(loaded);
+                continue;
+            }
+
+            LevelState &state = resource.levels[job->level];
+            if (failed) {
+                state.status = LevelStatus::Failed;
+                continue;
+            }
+
+            state        = loaded;
+            state.status = LevelStatus::Staged;
+        }
+    }
+
+    std::vector<ResidencyManager::LevelRef> ResidencyManager::load_candidates() const {
+        std::vector<LevelRef> candidates;
+        uint32_t              in_flight = 0;
+
+        for (StreamingHandle handle = 0; handle < m_resources.size(); handle++) {
+            const Resource &resource = m_resources[handle];
+            if (!resource.alive) {
+                continue;
+            }
+
+            const bool busy = std::ranges::any_of(resource.levels, [](const LevelState &s) {
+                return s.status == LevelStatus::Loading || s.status == LevelStatus::Staged || s.status == LevelStatus::Uploading || s.status == LevelStatus::Acquiring;
+            });
+            if (busy) {
+                in_flight++;
+                continue;
+            }
+
+            // the fallback first, then straight to the requested level without streaming the ones in between
+            if (resource.levels[0].status == LevelStatus::Unloaded) {
+                candidates.push_back({handle, 0, resource.generation});
+            } else if (static_cast<int32_t>(resource.requested_level) > resident_level(resource) &&
+                       resource.levels[resource.requested_level].status == LevelStatus::Unloaded) {
+                candidates.push_back({handle, resource.requested_level, resource.generation});
+            }
+        }
+
+        if (in_flight >= m_settings.max_staged_loads) {
+            return {};
+        }
+
+        std::ranges::sort(candidates, [this](const LevelRef &a, const LevelRef &b) { return loads_before(a, b); });
+
+        return candidates;
+    }
+
+    bool ResidencyManager::loads_before(const LevelRef &a, const LevelRef &b) const {
+        const Resource &ra = m_resources[a.handle];
+        const Resource &rb = m_resources[b.handle];
+        if ((a.level == 0) != (b.level == 0)) {
+            return a.level == 0;
+        }
+        if (ra.info.priority != rb.info.priority) {
+            return ra.info.priority > rb.info.priority;
+        }
+        return ra.last_used_frame > rb.last_used_frame;
+    }
+
+    int32_t ResidencyManager::resident_level(const Resource &resource) const {
+        for (int32_t level = static_cast<int32_t>(resource.levels.size()) - 1; level >= 0; level--) {
+            if (resource.levels[level].status == LevelStatus::Resident) {
+                return level;
+            }
+        }
+        return -1;
+    }
+
+    int64_t ResidencyManager::device_headroom() const {
+        VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(m_context->allocator(), budgets);
+
+        const VkPhysicalDeviceMemoryProperties *properties;
+        vmaGetMemoryProperties(m_context->allocator(), &properties);
+
+        int64_t headroom = 0;
+        for (uint32_t heap = 0; heap < properties->memoryHeapCount; heap++) {
+            if (properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                headroom += static_cast<int64_t>(static_cast<double>(budgets[heap].budget) * m_settings.budget_fraction) - static_cast<int64_t>(budgets[heap].usage);
+            }
+        }
+
+        // evicted memory still waits for the frames in flight but is as good as free
+        return headroom + static_cast<int64_t>(m_pending_free_bytes);
+    }
+
+    bool ResidencyManager::evict_for(vk::DeviceSize bytes, const LevelRef &candidate) {
+        const Resource &owner = m_resources[candidate.handle];
+
+        while (device_headroom() < static_cast<int64_t>(bytes)) {
+            // least valuable first: lower priority, then least recently used, then the most detailed level
+            Resource *victim       = nullptr;
+            uint32_t  victim_level = 0;
+
+            for (StreamingHandle handle = 0; handle < m_resources.size(); handle++) {
+                Resource &resource = m_resources[handle];
+                if (!resource.alive || handle == candidate.handle) {
+                    continue;
+                }
+
+                // never evict something used this frame for something less important
+                const bool in_use = resource.last_used_frame + DisplaySystem::MAX_FRAMES_IN_FLIGHT > m_frame;
+                if (in_use && resource.info.priority >= owner.info.priority) {
+                    continue;
+                }
+
+                const int32_t level = resident_level(resource);
+                if (level <= 0) {
+                    continue;
+                }
+
+                if (!victim || resource.info.priority < victim->info.priority ||
+                    (resource.info.priority == victim->info.priority && resource.last_used_frame < victim->last_used_frame)) {
+                    victim       = &resource;
+                    victim_level = level;
+                }
+            }
+
+            if (!victim) {
+                return false;
+            }
+
+            evict_level(victim->levels[victim_level]);
+        }
+
+        return true;
+    }
+
+    void ResidencyManager::evict_level(LevelState &state) {
+        if (!state.buffer.resource && !state.image.resource) {
+            state = {};
+            return;
+        }
+
+        if (state.status == LevelStatus::Resident) {
+            m_resident_bytes -= state.device_size;
+            m_evictions++;
+        }
+
+        m_pending_frees.push_back({m_frame, state.buffer, state.image, state.view, state.device_size});
+        m_pending_free_bytes += state.device_size;
+
+        state = {};
+    }
+
+    void ResidencyManager::make_resident(Resource &resource, uint32_t level) {
+        LevelState &state = resource.levels[level];
+        state.status      = LevelStatus::Resident;
+        m_resident_bytes += state.device_size;
+
+        // intermediate levels are superseded; the fallback stays
+        for (uint32_t lower = 1; lower < level; lower++) {
+            if (resource.levels[lower].status == LevelStatus::Resident) {
+                evict_level(resource.levels[lower]);
+            }
+        }
+    }
+
+    void ResidencyManager::free_level_now(LevelState &state) const {
+        if (state.view) {
+            m_context->device().destroyImageView(state.view);
+        }
+        if (state.buffer.resource) {
+            m_context->free_buffer(state.buffer);
+        }
+        if (state.image.resource) {
+            m_context->free_image(state.image);
+        }
+        if (state.staging.resource) {
+            m_context->free_buffer(state.staging);
+        }
+        state = {};
+    }
+
+    void ResidencyManager::load_level(const StreamingLevel &level, LevelState &state) const {
+        if (const auto *desc = std::get_if<StreamingBufferDesc>(&level.desc)) {
+            state.buffer = m_context->allocate_buffer(vk::BufferCreateInfo{{}, level.size, desc->usage | vk::BufferUsageFlagBits::eTransferDst},
+                                                      VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+            state.device_size = state.buffer.allocation_info.size;
+        } else {
+            const auto &image_desc = std::get<StreamingImageDesc>(level.desc);
+
+            vk::DeviceSize expected = 0;
+            for (uint32_t mip = 0; mip < image_desc.mip_levels; mip++) {
+                expected += texture_level_size(image_desc.format, image_desc.extent, mip) * image_desc.array_layers;
+            }
+            if (level.size < expected) {
+                throw std::runtime_error("Streamed image level is smaller than its mip chain");
+            }
+
+            state.image = m_context->allocate_image(vk::ImageCreateInfo{{},
+                                                                        vk::ImageType::e2D,
+                                                                        image_desc.format,
+                                                                        vk::Extent3D{image_desc.extent.width, image_desc.extent.height, 1},
+                                                                        image_desc.mip_levels,
+                                                                        image_desc.array_layers,
+                                                                        vk::SampleCountFlagBits::e1,
+                                                                        vk::ImageTiling::eOptimal,
+                                                                        image_desc.usage | vk::ImageUsageFlagBits::eTransferDst,
+                                                                        vk::SharingMode::eExclusive,
+                                                                        {},
+                                                                        vk::ImageLayout::eUndefined},
+                                                    VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+            state.device_size = state.image.allocation_info.size;
+
+            state.view = m_context->device().createImageView(
+                vk::ImageViewCreateInfo{{},
+                                        state.image.resource,
+                                        image_desc.array_layers > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D,
+                                        image_desc.format,
+                                        {},
+                                        vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, image_desc.mip_levels, 0, image_desc.array_layers}});
+        }
+
+        state.staging = m_context->allocate_buffer(vk::BufferCreateInfo{{}, level.size, vk::BufferUsageFlagBits::eTransferSrc},
+                                                   VmaAllocationCreateInfo{VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO});
+
+        level.load(std::span(static_cast<std::byte *>(state.staging.allocation_info.pMappedData), level.size));
+        vmaFlushAllocation(m_context->allocator(), state.staging.allocation, 0, VK_WHOLE_SIZE);
+    }
+
+    void ResidencyManager::record_upload(const vk::CommandBuffer &cmd, const StreamingLevel &level, const LevelState &state) const {
+        const bool transfer_ownership = m_transfer_family != m_graphics_family;
+
+        if (state.buffer.resource) {
+            cmd.copyBuffer(state.staging.resource, state.buffer.resource, vk::BufferCopy{0, 0, level.size});
+
+            if (transfer_ownership) {
+                const BufferOwnershipTransfer transfer{.buffer     = state.buffer.resource,
+                                                       .src_stage  = vk::PipelineStageFlagBits::eTransfer,
+                                                       .src_access = vk::AccessFlagBits::eTransferWrite,
+                                                       .dst_stage  = vk::PipelineStageFlagBits::eAllCommands,
+                                                       .dst_access = vk::AccessFlagBits::eMemoryRead};
+                record_ownership_release(cmd, m_transfer_family, m_graphics_family, std::span(&transfer, 1));
+            } else {
+                cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {},
+                                    vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead}, {}, {});
+            }
+            return;
+        }
+
+        const auto                     &desc = std::get<StreamingImageDesc>(level.desc);
+        const vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eColor, 0, desc.mip_levels, 0, desc.array_layers};
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                            vk::ImageMemoryBarrier{{},
+                                                   vk::AccessFlagBits::eTransferWrite,
+                                                   vk::ImageLayout::eUndefined,
+                                                   vk::ImageLayout::eTransferDstOptimal,
+                                                   VK_QUEUE_FAMILY_IGNORED,
+                                                   VK_QUEUE_FAMILY_IGNORED,
+                                                   state.image.resource,
+                                                   range});
+
+        std::vector<vk::BufferImageCopy> regions;
+        vk::DeviceSize                   offset = 0;
+        for (uint32_t mip = 0; mip < desc.mip_levels; mip++) {
+            const vk::Extent2D e{std::max(1U, desc.extent.width >> mip), std::max(1U, desc.extent.height >> mip)};
+            regions.emplace_back(offset, 0, 0, vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, mip, 0, desc.array_layers}, vk::Offset3D{0, 0, 0},
+                                 vk::Extent3D{e.width, e.height, 1});
+            offset += texture_level_size(desc.format, desc.extent, mip) * desc.array_layers;
+        }
+        cmd.copyBufferToImage(state.staging.resource, state.image.resource, vk::ImageLayout::eTransferDstOptimal, regions);
+
+        if (transfer_ownership) {
+            const ImageOwnershipTransfer transfer{.image      = state.image.resource,
+                                                  .range      = range,
+                                                  .old_layout = vk::ImageLayout::eTransferDstOptimal,
+                                                  .new_layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                                                  .src_stage  = vk::PipelineStageFlagBits::eTransfer,
+                                                  .src_access = vk::AccessFlagBits::eTransferWrite,
+                                                  .dst_stage  = vk::PipelineStageFlagBits::eAllCommands,
+                                                  .dst_access = vk::AccessFlagBits::eShaderRead};
+            record_ownership_release(cmd, m_transfer_family, m_graphics_family, {}, std::span(&transfer, 1));
+        } else {
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {},
+                                vk::ImageMemoryBarrier{vk::AccessFlagBits::eTransferWrite,
+                                                       vk::AccessFlagBits::eShaderRead,
+                                                       vk::ImageLayout::eTransferDstOptimal,
+                                                       vk::ImageLayout::eShaderReadOnlyOptimal,
+                                                       VK_QUEUE_FAMILY_IGNORED,
+                                                       VK_QUEUE_FAMILY_IGNORED,
+                                                       state.image.resource,
+                                                       range});
+        }
+    }
+
+    void ResidencyManager::retire_batches(bool wait) {
+        std::erase_if(m_batches, [&](UploadBatch &batch) {
+            if (wait) {
+                m_context->transfer_scheduler()->wait(batch.value);
+            } else if (m_context->transfer_scheduler()->completed() < batch.value) {
+                return false;
+            }
+
+            for (const auto &ref : batch.levels) {
+                Resource &resource = m_resources[ref.handle];
+                if (!resource.alive || resource.generation != ref.generation) {
+                    continue;
+                }
+
+                LevelState &state = resource.levels[ref.level];
+                m_context->free_buffer(state.staging);
+                state.staging = {};
+
+                if (m_transfer_family != m_graphics_family) {
+                    state.status = LevelStatus::Acquiring;
+                    m_pending_acquires.push_back(ref);
+                } else {
+                    make_resident(resource, ref.level);
+                }
+            }
+
+            m_transfer_pool->free_command_buffers({batch.cmd});
+            return true;
+        });
+    }
+} // namespace neuron::render
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace neuron::render {
+
+    using StreamingHandle = uint32_t;
+
+    struct StreamingBufferDesc {
+        vk::BufferUsageFlags usage;
+    };
+
+    // Data is level-major like TextureUploadInfo; every mip level must be provided (no blits on the transfer queue).
+    struct StreamingImageDesc {
+        vk::Format          format;
+        vk::Extent2D        extent;
+        uint32_t            mip_levels   = 1;
+        uint32_t            array_layers = 1;
+        vk::ImageUsageFlags usage        = vk::ImageUsageFlagBits::eSampled;
+    };
+
+    struct StreamingLevel {
+        std::variant<StreamingBufferDesc, StreamingImageDesc> desc;
+
+        vk::DeviceSize size = 0; // bytes of source data
+        // Fills the staging memory, runs on the streaming thread. May block on IO, e.g. a copy out of an AssetPack mapping.
+        std::function<void(std::span<std::byte>)> load;
+    };
+
+    struct StreamingResourceInfo {
+        std::vector<StreamingLevel> levels; // coarsest first; level 0 is the fallback and is never evicted
+        float                       priority = 1.0f;
+    };
+
+    // What may be bound this frame.
+    struct StreamingView {
+        uint32_t      level;
+        vk::Buffer    buffer = VK_NULL_HANDLE;
+        vk::Image     image  = VK_NULL_HANDLE;
+        vk::ImageView view   = VK_NULL_HANDLE;
+    };
+
+    struct StreamingSettings {
+        float          budget_fraction            = 0.8f; // of the device-local heap budget reported by VMA
+        vk::DeviceSize max_upload_bytes_per_frame = 16ULL * 1024 * 1024;
+        uint32_t       max_staged_loads           = 8; // loads holding staging memory at once
+    };
+
+    struct StreamingStats {
+        vk::DeviceSize device_budget   = 0;
+        vk::DeviceSize device_usage    = 0;
+        vk::DeviceSize resident_bytes  = 0;
+        vk::DeviceSize uploaded_bytes  = 0; // by the last update()
+        uint32_t       resident_levels = 0;
+        uint32_t       pending_loads   = 0;
+        uint32_t       evictions       = 0;
+    };
+
+    // Keeps the most useful detail levels of registered resources in device memory within the VRAM budget.
+    //
+    // A background thread picks what to load (highest priority, most recently requested first), fills staging memory and
+    // evicts the least valuable detail levels (lowest priority, least recently used) when over budget. update(), called once
+    // per frame on the render thread, submits staged uploads to the transfer queue up to the per-frame byte cap, retires
+    // completed ones and frees evicted memory once no frame in flight can use it. With a dedicated transfer family, call
+    // record_acquires() at the start of the frame's graphics command buffer to take ownership of newly streamed resources.
+    class NEURON_API ResidencyManager {
+        ResidencyManager(const std::shared_ptr<Context> &context, const StreamingSettings &settings);
+
+      public:
+        static std::shared_ptr<ResidencyManager> create(const std::shared_ptr<Context> &context, const StreamingSettings &settings = {});
+
+        ~ResidencyManager();
+
+        ResidencyManager(const ResidencyManager &other)            = delete;
+        ResidencyManager &operator=(const ResidencyManager &other) = delete;
+
+        StreamingHandle register_resource(StreamingResourceInfo info);
+        void            unregister_resource(StreamingHandle handle);
+
+        // Marks the resource as used this frame and sets the detail level it should stream towards.
+        void request(StreamingHandle handle, uint32_t level);
+
+        // Highest resident level, or nullopt until the fallback level has streamed in.
+        [[nodiscard]] std::optional<StreamingView> get(StreamingHandle handle) const;
+
+        void update();
+        void record_acquires(const vk::CommandBuffer &graphics_cmd);
+
+        [[nodiscard]] StreamingStats stats() const;
+
+      private:
+        enum class LevelStatus { Unloaded, Loading, Staged, Uploading, Acquiring, Resident, Failed };
+
+        struct LevelState {
+            LevelStatus              status = LevelStatus::Unloaded;
+            VmaAllocated<vk::Buffer> buffer{};
+            VmaAllocated<vk::Image>  image{};
+            vk::ImageView            view = VK_NULL_HANDLE;
+            VmaAllocated<vk::Buffer> staging{};
+            vk::DeviceSize           device_size = 0;
+        };
+
+        struct Resource {
+            StreamingResourceInfo   info;
+            std::vector<LevelState> levels;
+            uint32_t                requested_level = 0;
+            uint64_t                last_used_frame = 0;
+            uint32_t                generation      = 0;
+            bool                    alive           = false;
+        };
+
+        struct LevelRef {
+            StreamingHandle handle;
+            uint32_t        level;
+            uint32_t        generation;
+        };
+
+        struct UploadBatch {
+            vk::CommandBuffer     cmd;
+            uint64_t              value; // on the transfer scheduler's timeline
+            std::vector<LevelRef> levels;
+        };
+
+        struct PendingFree {
+            uint64_t                 frame;
+            VmaAllocated<vk::Buffer> buffer{};
+            VmaAllocated<vk::Image>  image{};
+            vk::ImageView            view = VK_NULL_HANDLE;
+            vk::DeviceSize           size = 0;
+        };
+
+        void worker();
+
+        [[nodiscard]] std::vector<LevelRef> load_candidates() const;
+        [[nodiscard]] bool                  loads_before(const LevelRef &a, const LevelRef &b) const;
+        [[nodiscard]] int32_t               resident_level(const Resource &resource) const;
+        [[nodiscard]] int64_t               device_headroom() const;
+
+        bool evict_for(vk::DeviceSize bytes, const LevelRef &candidate);
+        void evict_level(LevelState &state);
+        void make_resident(Resource &resource, uint32_t level);
+        void free_level_now(LevelState &state) const;
+        void load_level(const StreamingLevel &level, LevelState &state) const;
+        void record_upload(const vk::CommandBuffer &cmd, const StreamingLevel &level, const LevelState &state) const;
+        void retire_batches(bool wait);
+
+        std::shared_ptr<Context>     m_context;
+        StreamingSettings            m_settings;
+        std::shared_ptr<CommandPool> m_transfer_pool;
+        uint32_t                     m_transfer_family;
+        uint32_t                     m_graphics_family;
+
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_cv;
+        bool                    m_stop = false;
+        std::thread             m_worker;
+
+        std::vector<Resource>        m_resources;
+        std::vector<StreamingHandle> m_free_handles;
+        std::vector<UploadBatch>     m_batches;
+        std::vector<LevelRef>        m_pending_acquires;
+        std::vector<PendingFree>     m_pending_frees;
+
+        uint64_t       m_frame              = 0;
+        uint32_t       m_evictions          = 0;
+        vk::DeviceSize m_uploaded_bytes     = 0;
+        vk::DeviceSize m_resident_bytes     = 0;
+        vk::DeviceSize m_pending_free_bytes = 0;
+    };
+
+} // namespace neuron::render
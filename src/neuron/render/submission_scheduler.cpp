@@ -0,0 +1,294 @@
+#include "submission_scheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace neuron::render {
+    static vk::PipelineStageFlags2KHR to_stage2(vk::PipelineStageFlags stage) {
+        // the legacy stage bits are the low bits of the 64-bit synchronization2 masks
+        return vk::PipelineStageFlags2KHR(static_cast<VkPipelineStageFlags2KHR>(static_cast<VkPipelineStageFlags>(stage)));
+    }
+
+    SubmissionScheduler::SubmissionScheduler(const std::shared_ptr<Context> &context, vk::Queue queue, uint32_t family)
+        : m_device(context->device()), m_queue(queue), m_family(family), m_synchronization2(context->synchronization2_enabled()), m_head(&m_stub), m_tail(&m_stub),
+          m_nodes(std::make_unique<Node[]>(MAX_PENDING)), m_free_top(NO_NODE) {
+        for (uint32_t i = 0; i < MAX_PENDING; i++) {
+            release_node(&m_nodes[i]);
+        }
+        m_pending.reserve(MAX_PENDING);
+
+        vk::SemaphoreTypeCreateInfo type_info{vk::SemaphoreType::eTimeline, 0};
+        vk::SemaphoreCreateInfo     create_info{};
+        create_info.setPNext(&type_info);
+        m_timeline = m_device.createSemaphore(create_info);
+    }
+
+    std::shared_ptr<SubmissionScheduler> SubmissionScheduler::create(const std::shared_ptr<Context> &context, vk::Queue queue, uint32_t family) {
+        return std::shared_ptr<SubmissionScheduler>(new SubmissionScheduler(context, queue, family));
+    }
+
+    SubmissionScheduler::~SubmissionScheduler() {
+        flush();
+        wait(m_submitted_value.load(std::memory_order_acquire));
+
+        m_device.destroySemaphore(m_timeline);
+    }
+
+    uint64_t SubmissionScheduler::enqueue(const SubmitRequest &request) {
+        if (request.command_buffers.size() > MAX_COMMAND_BUFFERS || request.waits.size() > MAX_WAITS || request.signal_binary.size() > MAX_SIGNALS) {
+            throw std::runtime_error("Too many command buffers or semaphores in one submission");
+        }
+
+        Node *node = acquire_node();
+        std::ranges::copy(request.command_buffers, node->command_buffers.begin());
+        std::ranges::copy(request.waits, node->waits.begin());
+        std::ranges::copy(request.signal_binary, node->signals.begin());
+        node->command_buffer_count = static_cast<uint32_t>(request.command_buffers.size());
+        node->wait_count           = static_cast<uint32_t>(request.waits.size());
+        node->signal_count         = static_cast<uint32_t>(request.signal_binary.size());
+        node->fence                = request.fence;
+
+        // values are taken in one atomic step, flush() restores their order
+        node->value = m_next_value.fetch_add(1, std::memory_order_acq_rel);
+        push(node);
+
+        return node->value;
+    }
+
+    void SubmissionScheduler::flush() {
+        std::lock_guard lock(m_queue_mutex);
+
+        // everything enqueued before this call, including producers that took a value but have not pushed their node yet
+        const uint64_t target    = m_next_value.load(std::memory_order_acquire) - 1;
+        const uint64_t submitted = m_submitted_value.load(std::memory_order_relaxed);
+
+        size_t ready = 0;
+        while (true) {
+            while (Node *node = pop()) {
+                m_pending.push_back(node);
+            }
+
+            std::ranges::sort(m_pending, {}, [](const Node *node) { return node->value; });
+
+            ready = 0;
+            while (ready < m_pending.size() && m_pending[ready]->value == submitted + ready + 1) {
+                ready++;
+            }
+
+            if (submitted + ready >= target) {
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (ready == 0) {
+            return;
+        }
+
+        // one call per fence, since a fence can only be attached to a whole vkQueueSubmit
+        size_t begin = 0;
+        for (size_t i = 0; i < ready; i++) {
+            if (m_pending[i]->fence || i + 1 == ready) {
+                submit_batch(std::span(m_pending).subspan(begin, i + 1 - begin), m_pending[i]->fence);
+                begin = i + 1;
+            }
+        }
+
+        m_submitted_value.store(submitted + ready, std::memory_order_release);
+
+        for (size_t i = 0; i < ready; i++) {
+            release_node(m_pending[i]);
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<ptrdiff_t>(ready));
+    }
+
+    void SubmissionScheduler::submit_batch(std::span<Node *const> nodes, vk::Fence fence) {
+        size_t command_buffer_count = 0;
+        size_t wait_count           = 0;
+        size_t signal_count         = 0;
+        for (const Node *node : nodes) {
+            command_buffer_count += node->command_buffer_count;
+            wait_count += node->wait_count;
+            signal_count += node->signal_count + 1;
+        }
+
+        // reserved up front so the pointers stored in the submit infos stay valid
+        if (m_synchronization2) {
+            m_command_buffer_infos.clear();
+            m_wait_infos.clear();
+            m_signal_infos.clear();
+            m_submit_infos2.clear();
+            m_command_buffer_infos.reserve(command_buffer_count);
+            m_wait_infos.reserve(wait_count);
+            m_signal_infos.reserve(signal_count);
+
+            for (const Node *node : nodes) {
+                const size_t command_buffer_offset = m_command_buffer_infos.size();
+                const size_t wait_offset           = m_wait_infos.size();
+                const size_t signal_offset         = m_signal_infos.size();
+
+                for (uint32_t i = 0; i < node->command_buffer_count; i++) {
+                    m_command_buffer_infos.emplace_back(node->command_buffers[i]);
+                }
+                for (uint32_t i = 0; i < node->wait_count; i++) {
+                    m_wait_infos.emplace_back(node->waits[i].semaphore, node->waits[i].value, to_stage2(node->waits[i].stage));
+                }
+                m_signal_infos.emplace_back(m_timeline, node->value, vk::PipelineStageFlagBits2KHR::eAllCommands);
+                for (uint32_t i = 0; i < node->signal_count; i++) {
+                    m_signal_infos.emplace_back(node->signals[i], 0, vk::PipelineStageFlagBits2KHR::eAllCommands);
+                }
+
+                vk::SubmitInfo2KHR &si = m_submit_infos2.emplace_back();
+                si.setWaitSemaphoreInfoCount(node->wait_count).setPWaitSemaphoreInfos(m_wait_infos.data() + wait_offset);
+                si.setCommandBufferInfoCount(node->command_buffer_count).setPCommandBufferInfos(m_command_buffer_infos.data() + command_buffer_offset);
+                si.setSignalSemaphoreInfoCount(node->signal_count + 1).setPSignalSemaphoreInfos(m_signal_infos.data() + signal_offset);
+            }
+
+            m_queue.submit2KHR(m_submit_infos2, fence);
+        } else {
+            m_semaphores.clear();
+            m_values.clear();
+            m_wait_stages.clear();
+            m_timeline_infos.clear();
+            m_submit_infos.clear();
+            m_semaphores.reserve(wait_count + signal_count);
+            m_values.reserve(wait_count + signal_count);
+            m_wait_stages.reserve(wait_count);
+            m_timeline_infos.reserve(nodes.size());
+
+            for (const Node *node : nodes) {
+                const size_t wait_offset  = m_semaphores.size();
+                const size_t stage_offset = m_wait_stages.size();
+                for (uint32_t i = 0; i < node->wait_count; i++) {
+                    m_semaphores.push_back(node->waits[i].semaphore);
+                    m_values.push_back(node->waits[i].value);
+                    m_wait_stages.push_back(node->waits[i].stage);
+                }
+
+                const size_t signal_offset = m_semaphores.size();
+                m_semaphores.push_back(m_timeline);
+                m_values.push_back(node->value);
+                for (uint32_t i = 0; i < node->signal_count; i++) {
+                    m_semaphores.push_back(node->signals[i]);
+                    m_values.push_back(0);
+                }
+
+                vk::TimelineSemaphoreSubmitInfo &timeline_info = m_timeline_infos.emplace_back();
+                timeline_info.setWaitSemaphoreValueCount(node->wait_count).setPWaitSemaphoreValues(m_values.data() + wait_offset);
+                timeline_info.setSignalSemaphoreValueCount(node->signal_count + 1).setPSignalSemaphoreValues(m_values.data() + signal_offset);
+
+                vk::SubmitInfo &si = m_submit_infos.emplace_back();
+                si.setPNext(&timeline_info);
+                si.setWaitSemaphoreCount(node->wait_count).setPWaitSemaphores(m_semaphores.data() + wait_offset).setPWaitDstStageMask(m_wait_stages.data() + stage_offset);
+                si.setCommandBufferCount(node->command_buffer_count).setPCommandBuffers(node->command_buffers.data());
+                si.setSignalSemaphoreCount(node->signal_count + 1).setPSignalSemaphores(m_semaphores.data() + signal_offset);
+            }
+
+            m_queue.submit(m_submit_infos, fence);
+        }
+
+        m_submit_calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    vk::Result SubmissionScheduler::present(const vk::PresentInfoKHR &present_info) {
+        flush();
+
+        std::lock_guard lock(m_queue_mutex);
+        return m_queue.presentKHR(present_info);
+    }
+
+    void SubmissionScheduler::wait_idle() {
+        flush();
+
+        std::lock_guard lock(m_queue_mutex);
+        m_queue.waitIdle();
+    }
+
+    uint64_t SubmissionScheduler::completed() const {
+        return m_device.getSemaphoreCounterValue(m_timeline);
+    }
+
+    void SubmissionScheduler::wait(uint64_t value) {
+        if (value == 0) {
+            return;
+        }
+
+        if (value > m_submitted_value.load(std::memory_order_acquire)) {
+            flush();
+        }
+
+        vk::SemaphoreWaitInfo wait_info{};
+        wait_info.setSemaphores(m_timeline);
+        wait_info.setValues(value);
+        auto _ = m_device.waitSemaphores(wait_info, UINT64_MAX);
+    }
+
+    SubmissionScheduler::Node *SubmissionScheduler::acquire_node() {
+        uint64_t top = m_free_top.load(std::memory_order_acquire);
+        while (true) {
+            const auto index = static_cast<uint32_t>(top);
+            if (index == NO_NODE) {
+                // every node waits for a flush; this thread has not taken a value yet, so the flush can complete
+                flush();
+                top = m_free_top.load(std::memory_order_acquire);
+                continue;
+            }
+
+            // may read a node another thread just popped, in which case the tag has moved and the exchange fails
+            const uint64_t next = m_nodes[index].next_free.load(std::memory_order_relaxed);
+            if (m_free_top.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | next, std::memory_order_acquire, std::memory_order_acquire)) {
+                return &m_nodes[index];
+            }
+        }
+    }
+
+    void SubmissionScheduler::release_node(Node *node) {
+        const auto index = static_cast<uint32_t>(node - m_nodes.get());
+
+        uint64_t top = m_free_top.load(std::memory_order_relaxed);
+        do {
+            node->next_free.store(static_cast<uint32_t>(top), std::memory_order_relaxed);
+        } while (!m_free_top.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | index, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void SubmissionScheduler::push(Node *node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    SubmissionScheduler::Node *SubmissionScheduler::pop() {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &m_stub) {
+            if (!next) {
+                return nullptr;
+            }
+            m_tail = next;
+            tail   = next;
+            next   = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+
+        // a producer has exchanged the head but not linked its node yet
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        push(&m_stub);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+
+        return nullptr;
+    }
+} // namespace neuron::render
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace neuron::render {
+
+    // A point on a timeline semaphore that a submission waits for before `stage`. Binary semaphores ignore the value.
+    struct TimelineWait {
+        vk::Semaphore          semaphore;
+        uint64_t               value;
+        vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands;
+    };
+
+    struct SubmitRequest {
+        std::span<const vk::CommandBuffer> command_buffers;
+        std::span<const TimelineWait>      waits;
+        std::span<const vk::Semaphore>     signal_binary;
+        vk::Fence                          fence = VK_NULL_HANDLE;
+    };
+
+    // Owns a vk::Queue and its timeline semaphore. Any thread may enqueue submissions; each gets the timeline value it
+    // signals on completion. flush() hands everything enqueued so far to the driver in one vkQueueSubmit2 call (a fence
+    // ends a call early), in enqueue order, so timeline values stay monotonic on the queue.
+    //
+    // Everything that touches the queue (submits, presents, waitIdle) goes through here, which is what makes the queue
+    // safe to use from several threads.
+    class NEURON_API SubmissionScheduler {
+        SubmissionScheduler(const std::shared_ptr<Context> &context, vk::Queue queue, uint32_t family);
+
+      public:
+        static constexpr size_t MAX_COMMAND_BUFFERS = 8;
+        static constexpr size_t MAX_WAITS           = 8;
+        static constexpr size_t MAX_SIGNALS         = 4;
+        // Submissions enqueued but not flushed yet; enqueue() flushes itself when they are all taken.
+        static constexpr uint32_t MAX_PENDING = 256;
+
+        static std::shared_ptr<SubmissionScheduler> create(const std::shared_ptr<Context> &context, vk::Queue queue, uint32_t family);
+
+        ~SubmissionScheduler();
+
+        SubmissionScheduler(const SubmissionScheduler &other)            = delete;
+        SubmissionScheduler &operator=(const SubmissionScheduler &other) = delete;
+
+        // Lock-free and allocation-free; waits for the queue only when MAX_PENDING submissions are already waiting for a
+        // flush, by flushing them. Nothing reaches the GPU before the next flush().
+        uint64_t enqueue(const SubmitRequest &request);
+
+        void flush();
+
+        inline uint64_t submit(const SubmitRequest &request) {
+            const uint64_t value = enqueue(request);
+            flush();
+            return value;
+        }
+
+        // Flushes first so the present is ordered after everything enqueued before it.
+        vk::Result present(const vk::PresentInfoKHR &present_info);
+
+        void wait_idle();
+
+        [[nodiscard]] uint64_t completed() const;
+        // Flushes first when the value was enqueued but not submitted yet, since nothing would ever signal it.
+        void wait(uint64_t value);
+
+        [[nodiscard]] inline TimelineWait after(uint64_t value, vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands) const {
+            return {m_timeline, value, stage};
+        }
+
+        [[nodiscard]] inline vk::Semaphore timeline() const { return m_timeline; }
+
+        [[nodiscard]] inline uint32_t family() const { return m_family; }
+
+        // Number of vkQueueSubmit(2) calls so far, to check batching.
+        [[nodiscard]] inline uint64_t submit_call_count() const { return m_submit_calls.load(std::memory_order_relaxed); }
+
+      private:
+        static constexpr uint32_t NO_NODE = ~0U;
+
+        struct Node {
+            std::atomic<Node *>   next{nullptr};
+            std::atomic<uint32_t> next_free{NO_NODE};
+            uint64_t              value = 0;
+
+            std::array<vk::CommandBuffer, MAX_COMMAND_BUFFERS> command_buffers{};
+            std::array<TimelineWait, MAX_WAITS>                waits{};
+            std::array<vk::Semaphore, MAX_SIGNALS>             signals{};
+            uint32_t                                           command_buffer_count = 0;
+            uint32_t                                           wait_count           = 0;
+            uint32_t                                           signal_count         = 0;
+            vk::Fence                                          fence                = VK_NULL_HANDLE;
+        };
+
+        Node *acquire_node();
+        void  release_node(Node *node);
+        void  push(Node *node);
+        Node *pop();
+        void  submit_batch(std::span<Node *const> nodes, vk::Fence fence);
+
+        // not the Context itself, which owns its schedulers
+        vk::Device    m_device;
+        vk::Queue     m_queue;
+        uint32_t      m_family;
+        vk::Semaphore m_timeline;
+        bool          m_synchronization2;
+
+        // intrusive MPSC queue (Vyukov): producers exchange the head, the flushing thread owns the tail
+        std::atomic<Node *> m_head;
+        Node               *m_tail;
+        Node                m_stub;
+
+        std::atomic<uint64_t> m_next_value{1};
+        // written under m_queue_mutex, read without it by wait()
+        std::atomic<uint64_t> m_submitted_value{0};
+
+        // MAX_PENDING nodes on a Treiber stack: index of the top node in the low half, a tag bumped by every change in the
+        // high half so a node popped and pushed back in between fails the compare-exchange (ABA)
+        std::unique_ptr<Node[]> m_nodes;
+        std::atomic<uint64_t>   m_free_top;
+
+        // held while flushing and for anything else that uses m_queue
+        std::mutex            m_queue_mutex;
+        std::vector<Node *>   m_pending;
+        std::atomic<uint64_t> m_submit_calls{0};
+
+        // scratch for building submit infos, reused between flushes
+        std::vector<vk::CommandBufferSubmitInfoKHR> m_command_buffer_infos;
+        std::vector<vk::SemaphoreSubmitInfoKHR>     m_wait_infos;
+        std::vector<vk::SemaphoreSubmitInfoKHR>     m_signal_infos;
+        std::vector<vk::SubmitInfo2KHR>             m_submit_infos2;
+
+        std::vector<vk::Semaphore>                   m_semaphores;
+        std::vector<uint64_t>                        m_values;
+        std::vector<vk::PipelineStageFlags>          m_wait_stages;
+        std::vector<vk::TimelineSemaphoreSubmitInfo> m_timeline_infos;
+        std::vector<vk::SubmitInfo>                  m_submit_infos;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,295 @@
+#include "texture_uploader.hpp"
+
+#include "submission_scheduler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <numeric>
+
+namespace neuron::render {
+    FormatBlockInfo format_block_info(vk::Format format) {
+        switch (format) {
+        case vk::Format::eR8Unorm:
+        case vk::Format::eR8Snorm:
+        case vk::Format::eR8Uint:
+        case vk::Format::eR8Sint:
+        case vk::Format::eR8Srgb:
+            return {1, 1, 1};
+        case vk::Format::eR8G8Unorm:
+        case vk::Format::eR8G8Snorm:
+        case vk::Format::eR8G8Uint:
+        case vk::Format::eR8G8Sint:
+        case vk::Format::eR8G8Srgb:
+        case vk::Format::eR16Unorm:
+        case vk::Format::eR16Snorm:
+        case vk::Format::eR16Uint:
+        case vk::Format::eR16Sint:
+        case vk::Format::eR16Sfloat:
+            return {1, 1, 2};
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Snorm:
+        case vk::Format::eR8G8B8A8Uint:
+        case vk::Format::eR8G8B8A8Sint:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eB10G11R11UfloatPack32:
+        case vk::Format::eE5B9G9R9UfloatPack32:
+        case vk::Format::eR16G16Unorm:
+        case vk::Format::eR16G16Snorm:
+        case vk::Format::eR16G16Sfloat:
+        case vk::Format::eR32Uint:
+        case vk::Format::eR32Sint:
+        case vk::Format::eR32Sfloat:
+            return {1, 1, 4};
+        case vk::Format::eR16G16B16A16Unorm:
+        case vk::Format::eR16G16B16A16Snorm:
+        case vk::Format::eR16G16B16A16Sfloat:
+        case vk::Format::eR32G32Uint:
+        case vk::Format::eR32G32Sint:
+        case vk::Format::eR32G32Sfloat:
+            return {1, 1, 8};
+        case vk::Format::eR32G32B32A32Uint:
+        case vk::Format::eR32G32B32A32Sint:
+        case vk::Format::eR32G32B32A32Sfloat:
+            return {1, 1, 16};
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock:
+        case vk::Format::eBc4UnormBlock:
+        case vk::Format::eBc4SnormBlock:
+            return {4, 4, 8};
+        case vk::Format::eBc2UnormBlock:
+        case vk::Format::eBc2SrgbBlock:
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc5SnormBlock:
+        case vk::Format::eBc6HUfloatBlock:
+        case vk::Format::eBc6HSfloatBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eBc7SrgbBlock:
+            return {4, 4, 16};
+        default:
+            throw std::runtime_error("Unsupported texture format: " + vk::to_string(format));
+        }
+    }
+
+    static vk::Extent2D level_extent(const vk::Extent2D &extent, uint32_t level) {
+        return {std::max(1U, extent.width >> level), std::max(1U, extent.height >> level)};
+    }
+
+    vk::DeviceSize texture_level_size(vk::Format format, const vk::Extent2D &extent, uint32_t level) {
+        const FormatBlockInfo block = format_block_info(format);
+        const vk::Extent2D    e     = level_extent(extent, level);
+
+        const vk::DeviceSize blocks_x = (e.width + block.block_width - 1) / block.block_width;
+        const vk::DeviceSize blocks_y = (e.height + block.block_height - 1) / block.block_height;
+        return blocks_x * blocks_y * block.block_bytes;
+    }
+
+    uint32_t full_mip_chain_levels(const vk::Extent2D &extent) {
+        return std::bit_width(std::max(1U, std::max(extent.width, extent.height)));
+    }
+
+    TextureUploader::TextureUploader(const std::shared_ptr<Context> &context, const TextureUploaderSettings &settings) : m_context(context), m_settings(settings) {
+        m_command_pool = std::make_shared<CommandPool>(m_context, m_context->main_queue_family(), true);
+        m_cmd          = m_command_pool->allocate_command_buffer();
+
+        m_staging     = m_context->allocate_buffer(vk::BufferCreateInfo{{}, m_settings.staging_size, vk::BufferUsageFlagBits::eTransferSrc},
+                                                   VmaAllocationCreateInfo{VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO});
+        m_staging_ptr = static_cast<std::byte *>(m_staging.allocation_info.pMappedData);
+    }
+
+    std::shared_ptr<TextureUploader> TextureUploader::create(const std::shared_ptr<Context> &context, const TextureUploaderSettings &settings) {
+        return std::shared_ptr<TextureUploader>(new TextureUploader(context, settings));
+    }
+
+    TextureUploader::~TextureUploader() {
+        flush();
+        wait();
+
+        m_context->free_buffer(m_staging);
+        m_command_pool->free_command_buffers({m_cmd});
+    }
+
+    void TextureUploader::begin_batch() {
+        if (m_recording) {
+            return;
+        }
+
+        // there is one command buffer, so the previous batch must have finished executing before it is reset
+        wait();
+
+        m_cmd.reset();
+        m_cmd.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        m_recording = true;
+    }
+
+    VmaAllocated<vk::Image> TextureUploader::enqueue(const TextureUploadInfo &info) {
+        const FormatBlockInfo block    = format_block_info(info.format);
+        const bool            has_data = info.data != nullptr;
+
+        uint32_t mip_levels = info.mip_levels == 0 ? full_mip_chain_levels(info.extent) : info.mip_levels;
+        uint32_t provided   = has_data ? std::clamp(info.provided_levels, 1U, mip_levels) : 0;
+
+        // compressed formats cannot be blit destinations, so only the provided levels are allocated
+        const vk::FormatFeatureFlags features = m_context->physical_device().getFormatProperties(info.format).optimalTilingFeatures;
+        const bool                   can_blit = !block.compressed() && (features & vk::FormatFeatureFlagBits::eBlitSrc) && (features & vk::FormatFeatureFlagBits::eBlitDst);
+        if (has_data && !can_blit) {
+            mip_levels = provided;
+        }
+
+        const bool       generate = has_data && provided < mip_levels;
+        const vk::Filter filter   = (features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) ? vk::Filter::eLinear : vk::Filter::eNearest;
+
+        vk::ImageUsageFlags usage = info.usage | vk::ImageUsageFlagBits::eTransferDst;
+        if (generate) {
+            usage |= vk::ImageUsageFlagBits::eTransferSrc;
+        }
+
+        auto image = m_context->allocate_image(vk::ImageCreateInfo{{},
+                                                                   vk::ImageType::e2D,
+                                                                   info.format,
+                                                                   vk::Extent3D{info.extent.width, info.extent.height, 1},
+                                                                   mip_levels,
+                                                                   info.array_layers,
+                                                                   vk::SampleCountFlagBits::e1,
+                                                                   vk::ImageTiling::eOptimal,
+                                                                   usage,
+                                                                   vk::SharingMode::eExclusive,
+                                                                   {},
+                                                                   vk::ImageLayout::eUndefined},
+                                               VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE});
+
+        vk::DeviceSize total = 0;
+        for (uint32_t level = 0; level < provided; level++) {
+            total += texture_level_size(info.format, info.extent, level) * info.array_layers;
+        }
+
+        vk::Buffer     source;
+        vk::DeviceSize offset = 0;
+
+        if (total > m_settings.staging_size) {
+            auto oversized = m_context->allocate_staging_buffer(total, info.data, {});
+            m_oversized.push_back(oversized);
+            source = oversized.resource;
+        } else if (total > 0) {
+            // the staging buffer is reused, so the previous batch has to be done with it
+            wait();
+
+            const vk::DeviceSize alignment = std::lcm<vk::DeviceSize>(block.block_bytes, 4);
+            offset                         = (m_staging_offset + alignment - 1) / alignment * alignment;
+            if (offset + total > m_settings.staging_size) {
+                flush();
+                wait();
+                offset = 0;
+            }
+
+            std::memcpy(m_staging_ptr + offset, info.data, total);
+            m_staging_offset = offset + total;
+            source           = m_staging.resource;
+        }
+
+        begin_batch();
+
+        auto range = [&](uint32_t base_level, uint32_t level_count) {
+            return vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, base_level, level_count, 0, info.array_layers};
+        };
+        auto layers = [&](uint32_t level) { return vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, level, 0, info.array_layers}; };
+        auto barrier = [&](uint32_t base_level, uint32_t level_count, vk::AccessFlags src_access, vk::AccessFlags dst_access, vk::ImageLayout old_layout,
+                           vk::ImageLayout new_layout) {
+            return vk::ImageMemoryBarrier{src_access, dst_access, old_layout, new_layout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.resource,
+                                          range(base_level, level_count)};
+        };
+
+        m_cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                              barrier(0, mip_levels, {}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal));
+
+        if (provided > 0) {
+            std::vector<vk::BufferImageCopy> regions;
+            regions.reserve(provided);
+
+            vk::DeviceSize region_offset = offset;
+            for (uint32_t level = 0; level < provided; level++) {
+                const vk::Extent2D e = level_extent(info.extent, level);
+                regions.emplace_back(region_offset, 0, 0, layers(level), vk::Offset3D{0, 0, 0}, vk::Extent3D{e.width, e.height, 1});
+                region_offset += texture_level_size(info.format, info.extent, level) * info.array_layers;
+            }
+
+            m_cmd.copyBufferToImage(source, image.resource, vk::ImageLayout::eTransferDstOptimal, regions);
+        }
+
+        std::vector<vk::ImageMemoryBarrier> final_barriers;
+        const vk::AccessFlags               final_access = vk::AccessFlagBits::eMemoryRead;
+
+        if (generate) {
+            for (uint32_t level = provided; level < mip_levels; level++) {
+                m_cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                                      barrier(level - 1, 1, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eTransferDstOptimal,
+                                              vk::ImageLayout::eTransferSrcOptimal));
+
+                const vk::Extent2D src = level_extent(info.extent, level - 1);
+                const vk::Extent2D dst = level_extent(info.extent, level);
+
+                vk::ImageBlit blit{layers(level - 1),
+                                   {vk::Offset3D{0, 0, 0}, vk::Offset3D{static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), 1}},
+                                   layers(level),
+                                   {vk::Offset3D{0, 0, 0}, vk::Offset3D{static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height), 1}}};
+                m_cmd.blitImage(image.resource, vk::ImageLayout::eTransferSrcOptimal, image.resource, vk::ImageLayout::eTransferDstOptimal, blit, filter);
+            }
+
+            // levels below provided - 1 were never blit sources
+            if (provided > 1) {
+                final_barriers.push_back(barrier(0, provided - 1, vk::AccessFlagBits::eTransferWrite, final_access, vk::ImageLayout::eTransferDstOptimal, info.final_layout));
+            }
+            final_barriers.push_back(
+                barrier(provided - 1, mip_levels - provided, vk::AccessFlagBits::eTransferRead, final_access, vk::ImageLayout::eTransferSrcOptimal, info.final_layout));
+            final_barriers.push_back(barrier(mip_levels - 1, 1, vk::AccessFlagBits::eTransferWrite, final_access, vk::ImageLayout::eTransferDstOptimal, info.final_layout));
+        } else {
+            final_barriers.push_back(barrier(0, mip_levels, vk::AccessFlagBits::eTransferWrite, final_access, vk::ImageLayout::eTransferDstOptimal, info.final_layout));
+        }
+
+        m_cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, final_barriers);
+
+        return image;
+    }
+
+    void TextureUploader::flush() {
+        if (!m_recording) {
+            return;
+        }
+
+        vmaFlushAllocation(m_context->allocator(), m_staging.allocation, 0, VK_WHOLE_SIZE);
+
+        m_cmd.end();
+        m_recording = false;
+
+        m_submitted_value = m_context->main_scheduler()->submit({.command_buffers = std::span(&m_cmd, 1)});
+
+        m_in_flight      = true;
+        m_staging_offset = 0;
+        m_submission_count++;
+
+        m_oversized_in_flight.insert(m_oversized_in_flight.end(), m_oversized.begin(), m_oversized.end());
+        m_oversized.clear();
+    }
+
+    void TextureUploader::wait() {
+        if (!m_in_flight) {
+            return;
+        }
+
+        m_context->main_scheduler()->wait(m_submitted_value);
+
+        for (const auto &buffer : m_oversized_in_flight) {
+            m_context->free_buffer(buffer);
+        }
+        m_oversized_in_flight.clear();
+
+        m_in_flight = false;
+    }
+} // namespace neuron::render
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "neuron/neuron.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace neuron::render {
+
+    struct FormatBlockInfo {
+        uint32_t block_width  = 1;
+        uint32_t block_height = 1;
+        uint32_t block_bytes  = 0;
+
+        [[nodiscard]] inline bool compressed() const { return block_width > 1 || block_height > 1; }
+    };
+
+    // Supports the common 8/16/32-bit color formats and BC1-BC7; throws for anything else.
+    [[nodiscard]] NEURON_API FormatBlockInfo format_block_info(vk::Format format);
+
+    // Bytes of one array layer of the given mip level, tightly packed.
+    [[nodiscard]] NEURON_API vk::DeviceSize texture_level_size(vk::Format format, const vk::Extent2D &extent, uint32_t level);
+
+    [[nodiscard]] NEURON_API uint32_t full_mip_chain_levels(const vk::Extent2D &extent);
+
+    struct TextureUploadInfo {
+        const void  *data = nullptr; // level-major: level 0 (all layers), level 1 (all layers), ...
+        vk::Extent2D extent;
+        vk::Format   format;
+
+        uint32_t array_layers    = 1;
+        uint32_t mip_levels      = 0; // levels to allocate, 0 = full chain
+        uint32_t provided_levels = 1; // levels present in data, the rest is generated with blits
+
+        vk::ImageUsageFlags usage        = vk::ImageUsageFlagBits::eSampled;
+        vk::ImageLayout     final_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    };
+
+    struct TextureUploaderSettings {
+        vk::DeviceSize staging_size = 64ULL * 1024 * 1024;
+    };
+
+    // Batches texture uploads through one persistent staging buffer and records them into a single command buffer.
+    // Images returned by enqueue() may only be used after the next flush() has completed (see wait()).
+    // Submits to the main queue because mip generation needs blits.
+    class NEURON_API TextureUploader {
+        TextureUploader(const std::shared_ptr<Context> &context, const TextureUploaderSettings &settings);
+
+      public:
+        static std::shared_ptr<TextureUploader> create(const std::shared_ptr<Context> &context, const TextureUploaderSettings &settings = {});
+
+        ~TextureUploader();
+
+        TextureUploader(const TextureUploader &other)            = delete;
+        TextureUploader &operator=(const TextureUploader &other) = delete;
+
+        // Creates the image and records its upload. Flushes on its own when the staging buffer is full.
+        [[nodiscard]] VmaAllocated<vk::Image> enqueue(const TextureUploadInfo &info);
+
+        // Submits everything recorded so far without waiting.
+        void flush();
+
+        // Blocks until the last flush has completed.
+        void wait();
+
+        [[nodiscard]] inline uint32_t submission_count() const { return m_submission_count; }
+
+      private:
+        void begin_batch();
+
+        std::shared_ptr<Context>     m_context;
+        TextureUploaderSettings      m_settings;
+        std::shared_ptr<CommandPool> m_command_pool;
+        vk::CommandBuffer            m_cmd;
+        uint64_t                     m_submitted_value = 0; // on the main scheduler's timeline
+
+        VmaAllocated<vk::Buffer> m_staging;
+        std::byte               *m_staging_ptr    = nullptr;
+        vk::DeviceSize           m_staging_offset = 0;
+
+        // staging buffers for textures that do not fit m_staging, freed once their batch completes
+        std::vector<VmaAllocated<vk::Buffer>> m_oversized;
+        std::vector<VmaAllocated<vk::Buffer>> m_oversized_in_flight;
+
+        bool     m_recording        = false;
+        bool     m_in_flight        = false;
+        uint32_t m_submission_count = 0;
+    };
+
+} // namespace neuron::render
@@ -0,0 +1,34 @@
+#include "vertex_pulling.hpp"
+
+namespace neuron::render {
+    VertexPullingPushConstants vertex_pulling_constants(const Mesh &mesh) {
+        if (mesh.vertex_address() == 0) {
+            throw std::runtime_error("Mesh vertices are not addressable, buffer device address is not enabled");
+        }
+
+        VertexPullingPushConstants constants{};
+        constants.vertices       = mesh.vertex_address();
+        constants.stride         = mesh.layout().stride;
+        constants.position_scale = glm::vec4(mesh.position_scale(), 0.0f);
+        constants.position_bias  = glm::vec4(mesh.position_offset(), 0.0f);
+
+        // the quantized formats identify the streams, locations depend on which ones are present
+        for (const auto &attribute : mesh.layout().attributes) {
+            switch (attribute.format) {
+            case vk::Format::eR16G16B16A16Snorm:
+                constants.position_offset = attribute.offset;
+                break;
+            case vk::Format::eR16G16Snorm:
+                constants.normal_offset = attribute.offset;
+                break;
+            case vk::Format::eR8G8B8A8Unorm:
+                constants.color_offset = attribute.offset;
+                break;
+            default:
+                throw std::runtime_error("Vertex format cannot be pulled");
+            }
+        }
+
+        return constants;
+    }
+} // namespace neuron::render
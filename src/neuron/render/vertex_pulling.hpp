@@ -0,0 +1,34 @@
+#pragma once
+
+#include "neuron/base.hpp"
+#include "mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace neuron::render {
+
+    // Push constant block for vertex shaders that fetch their own vertices (res/shaders/vertex_pulling.vert), so one
+    // pipeline built with GraphicsPipelineBuilder::set_vertex_pulling() draws meshes of any MeshVertexLayout. Streams use
+    // the QuantizedMesh formats; offsets are in bytes within a vertex and must be 4-byte aligned, as must the stride.
+    struct VertexPullingPushConstants {
+        static constexpr uint32_t ABSENT_ATTRIBUTE = ~0U;
+
+        vk::DeviceAddress vertices        = 0;
+        uint32_t          stride          = 0;
+        uint32_t          position_offset = 0;
+        uint32_t          normal_offset   = ABSENT_ATTRIBUTE;
+        uint32_t          color_offset    = ABSENT_ATTRIBUTE;
+        uint32_t          _pad[2]         = {};
+        glm::vec4         position_scale{1.0f}; // xyz
+        glm::vec4         position_bias{0.0f};  // xyz
+    };
+
+    static_assert(offsetof(VertexPullingPushConstants, position_scale) == 32 && sizeof(VertexPullingPushConstants) == 64, "Must match the std430 push constant block");
+
+    // Throws when the mesh has no buffer address (buffer device address not enabled).
+    [[nodiscard]] NEURON_API VertexPullingPushConstants vertex_pulling_constants(const Mesh &mesh);
+
+} // namespace neuron::render
@@ -0,0 +1,82 @@
+#include "neuron/asset/asset_pack.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static neuron::asset::AssetType infer_type(const fs::path &path) {
+    const auto ext = path.extension().string();
+
+    if (ext == ".spv") {
+        return neuron::asset::AssetType::SpirV;
+    }
+
+    if (ext == ".vert" || ext == ".frag" || ext == ".geom" || ext == ".tesc" || ext == ".tese" || ext == ".comp" || ext == ".glsl") {
+        return neuron::asset::AssetType::Glsl;
+    }
+
+    if (ext == ".mesh") {
+        return neuron::asset::AssetType::Mesh;
+    }
+
+    if (ext == ".ktx2" || ext == ".dds" || ext == ".tex") {
+        return neuron::asset::AssetType::Texture;
+    }
+
+    return neuron::asset::AssetType::Blob;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: neuron_asset_packer <output> [--root <dir>] <file or directory>..." << std::endl;
+        std::cerr << "  asset names are paths relative to --root (default: the current directory)" << std::endl;
+        return 1;
+    }
+
+    fs::path              output = argv[1];
+    fs::path              root   = fs::current_path();
+    std::vector<fs::path> inputs;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--root" && i + 1 < argc) {
+            root = argv[++i];
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    neuron::asset::AssetPackWriter writer;
+    size_t                         count = 0;
+
+    auto add = [&](const fs::path &file) {
+        const auto name = fs::relative(file, root).generic_string();
+        writer.add_file(name, file, infer_type(file));
+        count++;
+    };
+
+    try {
+        for (const auto &input : inputs) {
+            if (fs::is_directory(input)) {
+                for (const auto &entry : fs::recursive_directory_iterator(input)) {
+                    if (entry.is_regular_file()) {
+                        add(entry.path());
+                    }
+                }
+            } else {
+                add(input);
+            }
+        }
+
+        writer.write(output);
+    } catch (const std::exception &e) {
+        std::cerr << "neuron_asset_packer: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << count << " assets into " << output.string() << std::endl;
+    return 0;
+}